@@ -0,0 +1,52 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+    std::atomic<size_t> allocations{ 0 };
+
+    void* CountedAllocate(std::size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* ptr = std::malloc(size ? size : 1)) {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+}
+
+namespace benchmarks {
+
+    size_t AllocationCounter::Get() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+
+} // namespace benchmarks
+
+void* operator new(std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
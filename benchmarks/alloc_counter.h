@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace benchmarks {
+
+    // Global operator new of the benchmark binary is replaced to count every heap allocation
+    class AllocationCounter {
+    public:
+        static size_t Get();
+    };
+
+    class AllocationScope {
+    public:
+        AllocationScope()
+            : start_(AllocationCounter::Get())
+        {
+        }
+
+        size_t Count() const {
+            return AllocationCounter::Get() - start_;
+        }
+
+    private:
+        size_t start_;
+    };
+
+} // namespace benchmarks
@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+
+int main(int argc, char** argv) {
+    // Error logs of closed loopback sockets are expected and only distort timings
+    spdlog::set_level(spdlog::level::off);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "chat_corpus.h"
+
+#include <array>
+
+
+namespace benchmarks {
+
+    using namespace std::literals;
+
+    std::string ChatCorpus::MakePrivmsg(std::string_view nick, std::string_view channel
+        , std::string_view text, std::string_view badges, std::string_view emotes) {
+        std::string line;
+        line.reserve(512);
+        line.append("@badge-info=subscriber/12;badges="sv).append(badges)
+            .append(";client-nonce=8f3c1d2e7a9b4c5d6e7f8091a2b3c4d5;color=#FF4500;display-name="sv).append(nick)
+            .append(";emotes="sv).append(emotes)
+            .append(";first-msg=0;flags=;id=7c1b5a2e-3d4f-4e6a-9b8c-0d1e2f3a4b5c;mod=0;returning-chatter=0"
+                ";room-id=123456789;subscriber=1;tmi-sent-ts=1700000000000;turbo=0;user-id=987654321;user-type= :"sv)
+            .append(nick).append("!"sv).append(nick).append("@"sv).append(nick)
+            .append(".tmi.twitch.tv PRIVMSG #"sv).append(channel).append(" :"sv).append(text).append("\r\n"sv);
+        return line;
+    }
+
+    namespace {
+
+        const std::array<std::string_view, 4> NICKS{ "viewer_one"sv, "SomeLongerNickname42"sv, "mod_user"sv, "x"sv };
+
+    } // namespace
+
+    std::string_view ChatCorpus::GetKindName(LineKind kind) {
+        switch (kind) {
+        case LineKind::SHORT:
+            return "short"sv;
+        case LineKind::LONG:
+            return "long"sv;
+        case LineKind::EMOTE_HEAVY:
+            return "emote_heavy"sv;
+        case LineKind::BADGE_HEAVY:
+            return "badge_heavy"sv;
+        }
+        return ""sv;
+    }
+
+    std::string ChatCorpus::MakeLine(LineKind kind, std::string_view nick) {
+        switch (kind) {
+        case LineKind::SHORT:
+            return MakePrivmsg(nick, "myangelwhitecat"sv, "lol"sv);
+        case LineKind::LONG:
+            return MakePrivmsg(nick, "myangelwhitecat"sv
+                , "this is a much longer chat line that people type when they are explaining something "
+                "about the map that was just played and why the streamer should try it again"sv);
+        case LineKind::EMOTE_HEAVY:
+            return MakePrivmsg(nick, "myangelwhitecat"sv, "Kappa Kappa Kappa PogChamp PogChamp"sv
+                , "subscriber/12,premium/1"sv, "25:0-4,6-10,12-16/88:18-25,27-34"sv);
+        case LineKind::BADGE_HEAVY:
+            return MakePrivmsg(nick, "myangelwhitecat"sv, "!test some args"sv
+                , "moderator/1,subscriber/3012,partner/1,glhf-pledge/1,sub-gifter/100,bits/100000"sv);
+        }
+        return {};
+    }
+
+    std::vector<std::string> ChatCorpus::MakeLines(size_t count) {
+        std::vector<std::string> lines;
+        lines.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            lines.push_back(MakeLine(KINDS[i % std::size(KINDS)], NICKS[i % NICKS.size()]));
+        }
+        return lines;
+    }
+
+    std::string ChatCorpus::MakeTraffic(size_t size) {
+        const auto lines = MakeLines(64);
+        std::string traffic;
+        traffic.reserve(size + 1024);
+        for (size_t i = 0; traffic.size() < size; ++i) {
+            traffic.append(lines[i % lines.size()]);
+        }
+        return traffic;
+    }
+
+    std::string ChatCorpus::MakeTraffic(size_t size, LineKind kind) {
+        std::string traffic;
+        traffic.reserve(size + 1024);
+        for (size_t i = 0; traffic.size() < size; ++i) {
+            traffic.append(MakeLine(kind, NICKS[i % NICKS.size()]));
+        }
+        return traffic;
+    }
+
+} // namespace benchmarks
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace benchmarks {
+
+    enum class LineKind {
+        SHORT,
+        LONG,
+        EMOTE_HEAVY,
+        BADGE_HEAVY
+    };
+
+    // Synthetic twitch traffic shaped after recorded chat: tagged PRIVMSG lines with CRLF
+    class ChatCorpus {
+    public:
+        static constexpr LineKind KINDS[] = { LineKind::SHORT, LineKind::LONG, LineKind::EMOTE_HEAVY, LineKind::BADGE_HEAVY };
+
+        static std::string_view GetKindName(LineKind kind);
+        static std::string MakeLine(LineKind kind, std::string_view nick);
+
+        static std::string MakePrivmsg(std::string_view nick, std::string_view channel
+            , std::string_view text, std::string_view badges = "subscriber/12,premium/1"
+            , std::string_view emotes = "");
+
+        // Mix of short, long, emote and badge heavy messages repeated up to size bytes
+        static std::string MakeTraffic(size_t size);
+        // Lines of one kind only, nicks still rotate
+        static std::string MakeTraffic(size_t size, LineKind kind);
+
+        static std::vector<std::string> MakeLines(size_t count);
+    };
+
+} // namespace benchmarks
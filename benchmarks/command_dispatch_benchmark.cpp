@@ -0,0 +1,140 @@
+#include "chat_corpus.h"
+
+#include "domain.h"
+#include "irc_line.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::Command;
+    using irc::domain::MessageType;
+    using irc::message_processor::CommandTable;
+    using irc::message_processor::LineTokenizer;
+    using namespace std::literals;
+
+    constexpr size_t LINES = 4096;
+
+    // Chat with the server lines a joined client sees between messages, without CRLF
+    const std::vector<std::string>& GetLines() {
+        static const std::vector<std::string> lines = []() {
+            static const std::vector<std::string_view> server_lines{
+                "PING :tmi.twitch.tv"sv,
+                ":bot!bot@bot.tmi.twitch.tv JOIN #myangelwhitecat"sv,
+                "@emote-only=0;followers-only=-1;r9k=0;room-id=123456789;slow=0;subs-only=0 :tmi.twitch.tv ROOMSTATE #myangelwhitecat"sv,
+                ":tmi.twitch.tv 001 bot :Welcome, GLHF!"sv,
+                ":tmi.twitch.tv CAP * ACK :twitch.tv/tags twitch.tv/commands"sv,
+                "@room-id=123456789;target-user-id=987654321;tmi-sent-ts=1700000000000 :tmi.twitch.tv CLEARCHAT #myangelwhitecat :troll"sv,
+                ":tmi.twitch.tv PONG tmi.twitch.tv :keepalive-1"sv,
+            };
+            std::vector<std::string> result;
+            auto chat = benchmarks::ChatCorpus::MakeLines(LINES);
+            for (size_t i = 0; i < chat.size(); ++i) {
+                chat[i].resize(chat[i].size() - 2);
+                result.push_back(std::move(chat[i]));
+                if (i % 16 == 0) {
+                    result.emplace_back(server_lines[(i / 16) % server_lines.size()]);
+                }
+            }
+            return result;
+        }();
+        return lines;
+    }
+
+    // Pre-tokenizer classification: split into word vector, then checks at fixed indices
+    std::vector<std::string_view> LegacySplit(std::string_view str) {
+        std::vector<std::string_view> result;
+        auto pos = str.find_first_not_of(" ");
+        const auto pos_end = str.npos;
+        while (pos != pos_end) {
+            auto space = str.find(' ', pos);
+            result.push_back(space == pos_end ? str.substr(pos) : str.substr(pos, space - pos));
+            pos = str.find_first_not_of(" ", space);
+        }
+        return result;
+    }
+
+    bool LegacyIsNumber(std::string_view str) {
+        if (str.empty()) {
+            return false;
+        }
+        for (char ch : str) {
+            if (!isdigit(ch)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MessageType LegacyClassify(std::string_view line) {
+        auto split = LegacySplit(line);
+        if (split.size() >= 4 && (split[2] == Command::PRIVMSG || split[2] == Command::USERNOTICE)) {
+            return split[2] == Command::PRIVMSG ? MessageType::PRIVMSG : MessageType::USERNOTICE;
+        }
+        switch (split.size()) {
+        case 0:
+            return MessageType::EMPTY;
+        case 3:
+            if (split[1] == Command::JOIN) {
+                return MessageType::JOIN;
+            }
+            return split[1] == Command::PART ? MessageType::PART : MessageType::UNKNOWN;
+        default:
+            if (split[0] == Command::PING) {
+                return MessageType::PING;
+            }
+            if (split.size() >= 4 && split[1] == Command::PONG) {
+                return MessageType::PONG;
+            }
+            if (split[1] == Command::RECONNECT) {
+                return MessageType::RECONNECT;
+            }
+            if (split.size() > 2 && split[2] == Command::ROOMSTATE) {
+                return MessageType::ROOMSTATE;
+            }
+            if (split.size() >= 3 && LegacyIsNumber(split[1])) {
+                return MessageType::STATUSCODE;
+            }
+            if (split.size() >= 4) {
+                if (split[1] == Command::CRES) {
+                    return MessageType::CAPRES;
+                }
+                if (split[2] == Command::CLEARCHAT) {
+                    return MessageType::CLEARCHAT;
+                }
+            }
+        }
+        return MessageType::UNKNOWN;
+    }
+
+    void BM_CommandDispatch_Legacy(benchmark::State& state) {
+        const auto& lines = GetLines();
+        for (auto _ : state) {
+            for (const auto& line : lines) {
+                benchmark::DoNotOptimize(LegacyClassify(line));
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * lines.size()));
+    }
+
+    void BM_CommandDispatch_Tokenizer(benchmark::State& state) {
+        const auto& lines = GetLines();
+        for (auto _ : state) {
+            for (const auto& line : lines) {
+                auto tokens = LineTokenizer::Tokenize(line);
+                benchmark::DoNotOptimize(CommandTable::Classify(tokens.command));
+                benchmark::DoNotOptimize(tokens.trailing);
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * lines.size()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_CommandDispatch_Legacy)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CommandDispatch_Tokenizer)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,201 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "chat_bot.h"
+#include "command.h"
+#include "command_executor.h"
+#include "message_processor.h"
+#include "shared_message.h"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::Role;
+    using irc::domain::SharedMessage;
+    using irc::message_processor::MessageProcessor;
+    using namespace std::literals;
+
+    // Touches every field of context, the way a real executor reads it
+    class ContextExecutor : public commands::BaseCommandExecutor {
+    public:
+        explicit ContextExecutor(std::atomic<size_t>& calls)
+            : calls_(calls)
+        {
+        }
+
+        void operator()(const commands::CommandContext& context) override {
+            benchmark::DoNotOptimize(context.arguments.size() + context.channel.size() + context.login.size());
+            benchmark::DoNotOptimize(context.message.GetId());
+            calls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<size_t>& calls_;
+    };
+
+    std::vector<SharedMessage> ParseShared(const std::vector<std::string>& lines) {
+        MessageProcessor processor;
+        std::vector<SharedMessage> shared;
+        for (const auto& line : lines) {
+            size_t consumed = 0;
+            for (auto& message : processor.GetMessagesFromRawBytes(line, consumed)) {
+                shared.push_back(SharedMessage::Make(std::move(message)));
+            }
+        }
+        return shared;
+    }
+
+    commands::Command MakeCommand(std::atomic<size_t>& calls) {
+        commands::Command command(std::make_unique<ContextExecutor>(calls));
+        command.SetRoleLevel(static_cast<int>(Role::EMPTY));
+        command.AddUserInBlackList("banned_user"sv);
+        return command;
+    }
+
+    // One Command shared by all benchmark threads, each runs it on its own contexts.
+    // Built with TWITCH_BOT_SANITIZE_THREAD this is the stress test for executor state
+    void BM_Command_ExecuteShared(benchmark::State& state) {
+        static std::atomic<size_t> calls{ 0 };
+        static const commands::Command command = MakeCommand(calls);
+        static const std::vector<SharedMessage> messages = ParseShared(benchmarks::ChatCorpus::MakeLines(64));
+
+        for (auto _ : state) {
+            for (const auto& message : messages) {
+                command.Execute(commands::CommandContext{
+                    .message = *message,
+                    .arguments = message->GetContent(),
+                    .channel = message->GetChannel(),
+                    .login = message->GetLogin(),
+                    .user = message->GetLoginId(),
+                    .role = message->GetRole(),
+                    });
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(messages.size() * state.iterations()));
+    }
+
+    // ChatBot with one command and two modes on io_context run by range(0) workers: all of them
+    // execute the same command and modes at once. Iteration posts the corpus and waits until
+    // every mode and command call is done
+    void BM_Command_ParallelDispatch(benchmark::State& state) {
+        const auto workers_count = static_cast<size_t>(state.range(0));
+        const auto messages = ParseShared(benchmarks::ChatCorpus::MakeLines(256));
+        boost::asio::io_context ioc(static_cast<int>(workers_count));
+        auto work = boost::asio::make_work_guard(ioc);
+        std::atomic<size_t> calls{ 0 };
+        auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+        chat_bot->AddCommand("test"sv, MakeCommand(calls));
+        chat_bot->AddMode("first"sv, MakeCommand(calls));
+        chat_bot->AddMode("second"sv, MakeCommand(calls));
+
+        // Calls per pass are counted on this thread before workers start
+        for (const auto& message : messages) {
+            chat_bot->ParseAndExecute(message);
+        }
+        ioc.poll();
+        const size_t calls_per_pass = calls.load();
+
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < workers_count; ++i) {
+            workers.emplace_back([&ioc]() {
+                ioc.run();
+                });
+        }
+
+        auto dispatch_all = [&]() {
+            const size_t expected = calls.load() + calls_per_pass;
+            for (const auto& message : messages) {
+                chat_bot->ParseAndExecute(message);
+            }
+            while (calls.load() < expected) {
+                std::this_thread::yield();
+            }
+        };
+        dispatch_all();
+
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            dispatch_all();
+        }
+        state.counters["allocs_per_message"] = benchmark::Counter(
+            static_cast<double>(scope.Count()) / static_cast<double>(messages.size() * state.iterations()));
+        state.SetItemsProcessed(static_cast<int64_t>(messages.size() * state.iterations()));
+        state.counters["calls_per_pass"] = benchmark::Counter(static_cast<double>(calls_per_pass));
+
+        work.reset();
+        ioc.stop();
+    }
+
+    class CountingAsyncExecutor : public commands::AsyncCommandExecutor {
+    public:
+        explicit CountingAsyncExecutor(std::atomic<size_t>& calls)
+            : calls_(calls)
+        {
+        }
+
+        boost::asio::awaitable<void> operator()(commands::AsyncCommandContext context) override {
+            benchmark::DoNotOptimize(context.arguments.size());
+            calls_.fetch_add(1, std::memory_order_relaxed);
+            co_return;
+        }
+
+    private:
+        std::atomic<size_t>& calls_;
+    };
+
+    // Cost of moving a command off network threads: queue, strand, deadline timer and coroutine
+    // frame per call. Reports queue wait and run time from AsyncStats
+    void BM_Command_AsyncDispatch(benchmark::State& state) {
+        const auto messages = ParseShared(benchmarks::ChatCorpus::MakeLines(256));
+        boost::asio::io_context ioc;
+        std::atomic<size_t> calls{ 0 };
+        auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+        chat_bot->SetWorkerPool(std::make_shared<commands::WorkerPool>(2));
+        commands::AsyncLimits limits;
+        limits.max_concurrent = static_cast<size_t>(state.range(0));
+        limits.max_queued = messages.size();
+        commands::Command command(std::make_unique<CountingAsyncExecutor>(calls), limits);
+        command.SetRoleLevel(static_cast<int>(Role::EMPTY));
+        chat_bot->AddCommand("test"sv, std::move(command));
+
+        const commands::Command& test = *chat_bot->GetCommand("test"sv);
+        auto is_idle = [&test]() {
+            const auto stats = *test.GetAsyncStats();
+            return stats.running == 0 && stats.queued == 0;
+        };
+        for (auto _ : state) {
+            for (const auto& message : messages) {
+                chat_bot->ParseAndExecute(message);
+            }
+            ioc.restart();
+            ioc.run();
+            while (!is_idle()) {
+                std::this_thread::yield();
+            }
+        }
+        const auto stats = *test.GetAsyncStats();
+        const auto finished = static_cast<double>(std::max<size_t>(stats.completed, 1));
+        state.counters["queue_wait_us"] = benchmark::Counter(static_cast<double>(stats.total_queue_wait.count()) / finished / 1000.0);
+        state.counters["run_us"] = benchmark::Counter(static_cast<double>(stats.total_run_time.count()) / finished / 1000.0);
+        state.counters["rejected"] = benchmark::Counter(static_cast<double>(stats.rejected));
+        state.SetItemsProcessed(static_cast<int64_t>(stats.completed));
+    }
+
+} // namespace
+
+BENCHMARK(BM_Command_ExecuteShared)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Command_ParallelDispatch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Command_AsyncDispatch)->Arg(1)->Arg(8)->Arg(0)->UseRealTime()->Unit(benchmark::kMicrosecond);
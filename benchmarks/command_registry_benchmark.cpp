@@ -0,0 +1,98 @@
+#include "alloc_counter.h"
+
+#include "command.h"
+#include "command_registry.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+    using namespace std::literals;
+
+    // Chat lines after command start: hits in different case, aliases, subcommands with arguments
+    // and misses, the way viewers type them
+    struct Registry {
+        commands::CommandRegistry registry;
+        std::unordered_map<std::string, commands::Command> legacy;
+        std::vector<std::string> lines;
+    };
+
+    std::string MakeName(size_t i) {
+        return "cmd_"s.append(std::to_string(i * 7919 % 100003));
+    }
+
+    Registry MakeRegistry(size_t commands_count) {
+        Registry result;
+        for (size_t i = 0; i < commands_count; ++i) {
+            const std::string name = MakeName(i);
+            result.registry.Add(name, commands::Command{});
+            result.legacy.emplace(name, commands::Command{});
+            if (i % 4 == 0) {
+                result.registry.AddAlias("a"s.append(name), name);
+                result.registry.Add(std::string(name).append(" skip"), commands::Command{});
+            }
+        }
+        for (size_t i = 0; i < 64; ++i) {
+            const std::string name = MakeName(i * 13 % commands_count);
+            switch (i % 4) {
+            case 0:
+                result.lines.push_back(name);
+                break;
+            case 1:
+                result.lines.push_back("CMD_"s.append(name.substr(4)).append(" some arguments here"));
+                break;
+            case 2:
+                result.lines.push_back(std::string(name).append(" skip now"));
+                break;
+            default:
+                result.lines.push_back("unknown_"s.append(name).append(" 42"));
+            }
+        }
+        return result;
+    }
+
+    void BM_Registry_Match(benchmark::State& state) {
+        const auto registry = MakeRegistry(static_cast<size_t>(state.range(0)));
+        size_t found = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            for (const auto& line : registry.lines) {
+                found += registry.registry.Match(line).command != nullptr;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(scope.Count()) / static_cast<double>(registry.lines.size() * state.iterations()));
+        state.SetItemsProcessed(static_cast<int64_t>(registry.lines.size() * state.iterations()));
+    }
+
+    // What ChatBot did before the registry: split at space, build std::string, look it up
+    void BM_Registry_LegacyMap(benchmark::State& state) {
+        const auto registry = MakeRegistry(static_cast<size_t>(state.range(0)));
+        size_t found = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            for (const auto& line : registry.lines) {
+                const size_t command_end = line.find(' ');
+                std::string command = line.substr(0, command_end);
+                std::string content = command_end == std::string::npos ? std::string{} : line.substr(command_end + 1);
+                found += registry.legacy.find(command) != registry.legacy.end();
+                benchmark::DoNotOptimize(content.data());
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(scope.Count()) / static_cast<double>(registry.lines.size() * state.iterations()));
+        state.SetItemsProcessed(static_cast<int64_t>(registry.lines.size() * state.iterations()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_Registry_Match)->Arg(16)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_Registry_LegacyMap)->Arg(16)->Arg(1024)->Arg(8192);
@@ -0,0 +1,73 @@
+#include "alloc_counter.h"
+
+#include "cooldown.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+
+namespace {
+
+    using namespace std::literals;
+    using Clock = commands::CooldownTracker::Clock;
+
+    // range(0) chatters spamming one command in 4 channels, 20 us of chat time per call. Global and
+    // channel limits are loose, so most calls reach the user table
+    void BM_Cooldown_TryAcquire(benchmark::State& state) {
+        const auto users_count = static_cast<uint64_t>(state.range(0));
+        commands::CooldownLimits limits;
+        limits.global = { 1ms, 1000 };
+        limits.per_channel = { 1ms, 100 };
+        limits.per_user = { 30s, 2 };
+        commands::CooldownTracker tracker(limits);
+
+        const auto start = Clock::now();
+        uint64_t call = 0;
+        size_t allowed = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            const auto user = static_cast<irc::domain::NameId>(call * 2654435761u % users_count + 1);
+            const auto channel = static_cast<irc::domain::NameId>(call % 4 + 1);
+            allowed += tracker.TryAcquire(channel, user, start + std::chrono::microseconds(call * 20));
+            ++call;
+        }
+        benchmark::DoNotOptimize(allowed);
+        const auto stats = tracker.GetStats();
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(scope.Count()) / static_cast<double>(state.iterations()));
+        state.counters["tracked_users"] = benchmark::Counter(static_cast<double>(stats.tracked_users));
+        state.counters["allowed"] = benchmark::Counter(static_cast<double>(stats.allowed));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    // Raid: every call from a new chatter, 1 us apart, per user cooldown of range(0) ms. Expired
+    // users leave the table, so it holds one cooldown window of them, never more than max_tracked
+    void BM_Cooldown_DistinctUsers(benchmark::State& state) {
+        commands::CooldownLimits limits;
+        limits.per_user = { std::chrono::milliseconds(state.range(0)), 1 };
+        commands::CooldownTracker tracker(limits);
+
+        const auto start = Clock::now();
+        uint64_t call = 0;
+        size_t max_tracked = 0;
+        for (auto _ : state) {
+            const auto now = start + std::chrono::microseconds(call);
+            benchmark::DoNotOptimize(tracker.TryAcquire(1, static_cast<irc::domain::NameId>(call + 1), now));
+            if (call % 65536 == 0) {
+                max_tracked = std::max(max_tracked, tracker.GetStats().tracked_users);
+            }
+            ++call;
+        }
+        const auto stats = tracker.GetStats();
+        state.counters["max_tracked_users"] = benchmark::Counter(static_cast<double>(max_tracked));
+        state.counters["overflowed"] = benchmark::Counter(static_cast<double>(stats.overflowed));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_Cooldown_TryAcquire)->Arg(1000)->Arg(100000)->Arg(1000000);
+BENCHMARK(BM_Cooldown_DistinctUsers)->Arg(10)->Arg(100)->Arg(30000)->Iterations(4000000);
@@ -0,0 +1,63 @@
+#include "alloc_counter.h"
+
+#include "string_interner.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::NameId;
+    using irc::domain::StringInterner;
+    using namespace std::literals;
+
+    constexpr size_t CHATTERS = 4096;
+
+    const std::vector<std::string>& GetNicks() {
+        static const std::vector<std::string> nicks = []() {
+            std::vector<std::string> result;
+            for (size_t i = 0; i < CHATTERS; ++i) {
+                result.push_back("SomeChatter_"s.append(std::to_string(i)));
+            }
+            return result;
+        }();
+        return nicks;
+    }
+
+    // Chat of a few thousand regulars: every lookup is a hit after warm up. Threads share one interner
+    void BM_Interner_Hit(benchmark::State& state) {
+        static StringInterner interner;
+        const auto& nicks = GetNicks();
+        for (const auto& nick : nicks) {
+            interner.Intern(nick);
+        }
+
+        size_t index = static_cast<size_t>(state.thread_index()) * 977;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(interner.Intern(nicks[index++ % nicks.size()]));
+        }
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(scope.Count()) / static_cast<double>(state.iterations()));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    // Four times more names than capacity: every lookup evicts
+    void BM_Interner_Churn(benchmark::State& state) {
+        StringInterner interner(CHATTERS / 4);
+        const auto& nicks = GetNicks();
+        size_t index = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(interner.Intern(nicks[index++ % nicks.size()]));
+        }
+        state.counters["evictions"] = benchmark::Counter(static_cast<double>(interner.GetStats().evictions));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_Interner_Hit)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Interner_Churn);
@@ -0,0 +1,134 @@
+#include "chat_corpus.h"
+
+#include "line_splitter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::message_processor::LineRange;
+    using irc::message_processor::LineSplitter;
+    using irc::message_processor::ScanKind;
+    using namespace std::literals;
+
+    constexpr size_t TRAFFIC_SIZE = 4 * 1024 * 1024;
+
+    const std::string& GetTraffic() {
+        static const std::string traffic = benchmarks::ChatCorpus::MakeTraffic(TRAFFIC_SIZE);
+        return traffic;
+    }
+
+    // Feeds traffic in socket sized chunks, unconsumed tail is prepended to the next chunk
+    // the way ReadBuffer keeps it in place
+    template <typename SplitFn>
+    size_t SplitInChunks(std::string_view traffic, size_t chunk_size, SplitFn&& split) {
+        size_t lines = 0;
+        size_t begin = 0;
+        for (size_t end = std::min(chunk_size, traffic.size()); ; end = std::min(end + chunk_size, traffic.size())) {
+            begin += split(traffic.substr(begin, end - begin), lines);
+            if (end == traffic.size()) {
+                break;
+            }
+        }
+        return lines;
+    }
+
+    void ReportTraffic(benchmark::State& state, size_t lines) {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * GetTraffic().size()));
+        state.counters["lines"] = benchmark::Counter(static_cast<double>(lines));
+    }
+
+    // Pre-ring-buffer splitter: byte by byte CRLF check, line grown with +=, tail copied every read
+    void BM_SplitLines_Legacy(benchmark::State& state) {
+        const std::string& traffic = GetTraffic();
+        const size_t chunk_size = static_cast<size_t>(state.range(0));
+        std::vector<std::vector<char>> chunks;
+        for (size_t i = 0; i < traffic.size(); i += chunk_size) {
+            chunks.emplace_back(traffic.begin() + i, traffic.begin() + std::min(i + chunk_size, traffic.size()));
+        }
+
+        size_t lines = 0;
+        for (auto _ : state) {
+            lines = 0;
+            std::string incomplete;
+            for (const auto& raw_bytes : chunks) {
+                std::vector<std::string> messages;
+                std::string raw_message;
+                if (!incomplete.empty()) {
+                    raw_message = incomplete;
+                    incomplete.clear();
+                }
+                for (size_t i = 0; i < raw_bytes.size(); ++i) {
+                    if (i < raw_bytes.size() - 1 && raw_bytes[i] == '\r' && raw_bytes[i + 1] == '\n') {
+                        messages.push_back(raw_message);
+                        raw_message.clear();
+                        ++i;
+                        continue;
+                    }
+                    raw_message += raw_bytes[i];
+                }
+                if (!raw_message.empty()) {
+                    incomplete = raw_message;
+                }
+                lines += messages.size();
+                benchmark::DoNotOptimize(messages.data());
+            }
+        }
+        ReportTraffic(state, lines);
+    }
+
+    // string_view::find loop that GetMessagesFromRawBytes used before LineSplitter
+    void BM_SplitLines_Find(benchmark::State& state) {
+        const std::string& traffic = GetTraffic();
+        std::vector<LineRange> ranges;
+        size_t lines = 0;
+        for (auto _ : state) {
+            lines = SplitInChunks(traffic, static_cast<size_t>(state.range(0)), [&ranges](std::string_view bytes, size_t& lines) {
+                ranges.clear();
+                size_t line_start = 0;
+                for (size_t line_end = bytes.find("\r\n"sv); line_end != std::string_view::npos
+                    ; line_end = bytes.find("\r\n"sv, line_start)) {
+                    ranges.push_back(LineRange{ line_start, line_end - line_start });
+                    line_start = line_end + 2;
+                }
+                lines += ranges.size();
+                benchmark::DoNotOptimize(ranges.data());
+                return line_start;
+                });
+        }
+        ReportTraffic(state, lines);
+    }
+
+    void BM_SplitLines_LineSplitter(benchmark::State& state, ScanKind kind) {
+        if (!LineSplitter::IsSupported(kind)) {
+            state.SkipWithError("Scanner is not supported by this CPU");
+            return;
+        }
+        const std::string& traffic = GetTraffic();
+        std::vector<LineRange> ranges;
+        size_t lines = 0;
+        for (auto _ : state) {
+            lines = SplitInChunks(traffic, static_cast<size_t>(state.range(0)), [&ranges, kind](std::string_view bytes, size_t& lines) {
+                ranges.clear();
+                const size_t consumed = LineSplitter::Split(bytes, ranges, kind);
+                lines += ranges.size();
+                benchmark::DoNotOptimize(ranges.data());
+                return consumed;
+                });
+        }
+        ReportTraffic(state, lines);
+    }
+
+} // namespace
+
+BENCHMARK(BM_SplitLines_Legacy)->Arg(128)->Arg(4096);
+BENCHMARK(BM_SplitLines_Find)->Arg(128)->Arg(4096)->Arg(65536);
+BENCHMARK_CAPTURE(BM_SplitLines_LineSplitter, Scalar, ScanKind::SCALAR)->Arg(128)->Arg(4096)->Arg(65536);
+BENCHMARK_CAPTURE(BM_SplitLines_LineSplitter, SSE2, ScanKind::SSE2)->Arg(128)->Arg(4096)->Arg(65536);
+BENCHMARK_CAPTURE(BM_SplitLines_LineSplitter, AVX2, ScanKind::AVX2)->Arg(128)->Arg(4096)->Arg(65536);
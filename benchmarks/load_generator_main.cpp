@@ -0,0 +1,263 @@
+#include "mock_twitch_server.h"
+#include "tool_options.h"
+
+#include "chat_bot.h"
+#include "command.h"
+#include "command_executor.h"
+#include "irc_client.h"
+#include "tls_client_context.h"
+
+#include <boost/asio/io_context.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    namespace net = boost::asio;
+    using namespace std::literals;
+
+    // Log-linear histogram of microseconds: exact below 32, then 16 buckets per power of two
+    class LatencyHistogram {
+    public:
+        void Record(std::chrono::nanoseconds latency) {
+            const auto us = static_cast<uint64_t>(std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(latency).count(), 0));
+            ++buckets_[std::min(GetBucket(us), BUCKETS - 1)];
+        }
+
+        void Reset() {
+            for (auto& bucket : buckets_) {
+                bucket = 0;
+            }
+        }
+
+        // Lower bound of the bucket holding the percentile
+        std::chrono::microseconds GetPercentile(double percentile) const {
+            uint64_t total = 0;
+            for (const auto& bucket : buckets_) {
+                total += bucket.load();
+            }
+            if (total == 0) {
+                return 0us;
+            }
+            const auto rank = static_cast<uint64_t>(percentile * static_cast<double>(total - 1));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += buckets_[i].load();
+                if (seen > rank) {
+                    return std::chrono::microseconds(GetLowerBound(i));
+                }
+            }
+            return std::chrono::microseconds(GetLowerBound(BUCKETS - 1));
+        }
+
+    private:
+        static constexpr size_t BUCKETS = 640;
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+
+        static size_t GetBucket(uint64_t us) {
+            if (us < 32) {
+                return static_cast<size_t>(us);
+            }
+            const size_t msb = std::bit_width(us) - 1;
+            return (msb - 3) * 16 + static_cast<size_t>((us >> (msb - 4)) & 15);
+        }
+
+        static uint64_t GetLowerBound(size_t bucket) {
+            if (bucket < 32) {
+                return bucket;
+            }
+            return (16 + bucket % 16) << (bucket / 16 - 1);
+        }
+    };
+
+    // Chat text is "!load <send ns>": latency is from server write to executor call
+    class LatencyExecutor : public commands::ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        LatencyExecutor(LatencyHistogram& histogram, std::atomic<size_t>& calls)
+            : histogram_(histogram)
+            , calls_(calls)
+        {
+        }
+
+        void operator()(std::string_view content) override {
+            int64_t sent = 0;
+            if (std::from_chars(content.data(), content.data() + content.size(), sent).ec == std::errc{}) {
+                histogram_.Record(std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(sent));
+            }
+            ++calls_;
+        }
+
+    private:
+        LatencyHistogram& histogram_;
+        std::atomic<size_t>& calls_;
+    };
+
+    struct StepResult {
+        double rate = 0;
+        size_t sent = 0;
+        size_t delivered = 0;
+        size_t dropped = 0;
+        std::chrono::microseconds p50{ 0 };
+        std::chrono::microseconds p99{ 0 };
+        bool sustained = false;
+    };
+
+    void PrintUsage() {
+        std::cout << "Usage: TwitchLoadGenerator [--tls] [--channels 8] [--client-threads 1] [--start-rate 1000] [--max-rate 2000000]\n"
+            "  [--growth 1.5] [--step-seconds 3] [--p99-limit-ms 100] [--min-delivered 0.95]\n"
+            "  [--disconnect-after-ms 0] [--reconnect-after-ms 0] [--read-delay-ms 0]\n";
+    }
+
+    void PrintStep(const StepResult& step) {
+        std::printf("%12.0f %12zu %12zu %10zu %10.3f %10.3f  %s\n", step.rate, step.sent, step.delivered, step.dropped
+            , step.p50.count() / 1000.0, step.p99.count() / 1000.0, step.sustained ? "ok" : "overloaded");
+    }
+
+} // namespace
+
+// Runs mock server and a client with chat bot in one process, raises chat rate step by step until
+// the client stops keeping up and reports the last sustained rate with its latency
+int main(int argc, char* argv[]) {
+    const mock_twitch::ToolOptions options(argc, argv);
+    if (options.Has("help")) {
+        PrintUsage();
+        return 0;
+    }
+    // Client logs every chat line on info level
+    spdlog::set_level(spdlog::level::warn);
+
+    mock_twitch::ServerConfig config;
+    config.tls = options.Has("tls");
+    config.messages_per_second = options.GetNumber("start-rate", 1000);
+    config.disconnect_after = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("disconnect-after-ms", 0)));
+    config.reconnect_after = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("reconnect-after-ms", 0)));
+    config.read_delay = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("read-delay-ms", 0)));
+    const auto channels = static_cast<size_t>(options.GetNumber("channels", 8));
+    const double max_rate = options.GetNumber("max-rate", 2'000'000);
+    const double growth = std::max(options.GetNumber("growth", 1.5), 1.01);
+    const auto step_time = std::chrono::duration<double>(options.GetNumber("step-seconds", 3));
+    const auto p99_limit = std::chrono::microseconds(static_cast<int64_t>(options.GetNumber("p99-limit-ms", 100) * 1000));
+    const double min_delivered = options.GetNumber("min-delivered", 0.95);
+
+    // Server runs on its own threads, so the client is measured and not the generator
+    net::io_context server_ioc(1);
+    auto server_guard = net::make_work_guard(server_ioc);
+    auto server = std::make_shared<mock_twitch::MockServer>(server_ioc, config);
+    server->Start();
+    std::jthread server_thread([&server_ioc]() {
+        server_ioc.run();
+        });
+
+    // Commands take per call context, so the client may run on several threads
+    const auto client_threads = std::max<unsigned>(static_cast<unsigned>(options.GetNumber("client-threads", 1)), 1);
+    net::io_context client_ioc(static_cast<int>(client_threads));
+    auto client_guard = net::make_work_guard(client_ioc);
+    LatencyHistogram histogram;
+    std::atomic<size_t> calls{ 0 };
+    auto chat_bot = std::make_shared<chat_bot::ChatBot>(client_ioc);
+    commands::Command command(std::make_unique<LatencyExecutor>(histogram, calls));
+    command.SetRoleLevel(static_cast<int>(irc::domain::Role::EMPTY));
+    chat_bot->AddCommand(config.command, std::move(command));
+
+    if (config.tls) {
+        connection::TlsClientContext::Instance().AddCertificateAuthority(server->GetCaCertificate());
+    }
+    auto client = std::make_shared<irc::Client>(client_ioc, chat_bot, config.tls);
+    client->SetServer(config.address, std::to_string(server->GetPort()));
+
+    std::vector<std::string> channel_names;
+    for (size_t i = 0; i < channels; ++i) {
+        channel_names.push_back("load_channel_"s.append(std::to_string(i)));
+    }
+    client->Authorize(irc::domain::AuthorizeData("loadbot"sv, "oauth:mock"sv));
+    client->CapRequest();
+    client->Join(std::vector<std::string_view>(channel_names.begin(), channel_names.end()));
+    client->Connect();
+    client->Read();
+    std::vector<std::jthread> client_threads_pool;
+    for (unsigned i = 0; i < client_threads; ++i) {
+        client_threads_pool.emplace_back([&client_ioc]() {
+            client_ioc.run();
+            });
+    }
+
+    const auto join_deadline = std::chrono::steady_clock::now() + 30s;
+    while (client->GetJoinStats().joined < channels && std::chrono::steady_clock::now() < join_deadline) {
+        std::this_thread::sleep_for(50ms);
+    }
+    if (client->GetJoinStats().joined < channels) {
+        std::cout << "Client didn't join " << channels << " channels in time\n";
+        client->Disconnect();
+        server->Stop();
+        client_ioc.stop();
+        server_ioc.stop();
+        return 1;
+    }
+
+    std::printf("%12s %12s %12s %10s %10s %10s\n", "rate/s", "sent", "delivered", "dropped", "p50 ms", "p99 ms");
+    std::optional<StepResult> best;
+    for (double rate = config.messages_per_second; rate <= max_rate; rate *= growth) {
+        server->SetRate(rate);
+        // Let the previous step backlog drain into this one instead of skewing its latency
+        std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::milliseconds>(step_time / 4));
+        histogram.Reset();
+        const auto before = server->GetStats();
+        const size_t calls_before = calls.load();
+
+        std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::milliseconds>(step_time));
+
+        const auto after = server->GetStats();
+        StepResult step;
+        step.rate = rate;
+        step.sent = after.chat_lines - before.chat_lines;
+        step.delivered = calls.load() - calls_before;
+        step.dropped = after.dropped_lines - before.dropped_lines;
+        step.p50 = histogram.GetPercentile(0.50);
+        step.p99 = histogram.GetPercentile(0.99);
+        // Nothing sent means client lost its channels, e.g. after injected disconnect
+        step.sustained = step.sent > 0 && step.dropped == 0 && step.p99 <= p99_limit
+            && static_cast<double>(step.delivered) >= min_delivered * static_cast<double>(step.sent);
+        PrintStep(step);
+        if (!step.sustained) {
+            break;
+        }
+        best = step;
+    }
+
+    const auto stats = server->GetStats();
+    std::cout << "\nserver: sessions " << stats.sessions << ", disconnects " << stats.disconnects
+        << ", reconnects " << stats.reconnects << ", client handovers " << client->GetHandoversCount() << "\n";
+    if (best) {
+        std::printf("max sustained: %.0f messages/s, p50 %.3f ms, p99 %.3f ms\n"
+            , static_cast<double>(best->delivered) / step_time.count(), best->p50.count() / 1000.0, best->p99.count() / 1000.0);
+    }
+    else {
+        std::cout << "max sustained: none, start rate is already too high\n";
+    }
+
+    client->Disconnect();
+    server->Stop();
+    client_guard.reset();
+    server_guard.reset();
+    client_ioc.stop();
+    server_ioc.stop();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "message_processor.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::Message;
+    using irc::message_processor::MessageProcessor;
+
+    constexpr size_t TRAFFIC_SIZE = 1024 * 1024;
+
+    const std::string& GetTraffic() {
+        static const std::string traffic = benchmarks::ChatCorpus::MakeTraffic(TRAFFIC_SIZE);
+        return traffic;
+    }
+
+    // Touches what handler and chat bot read from every message
+    size_t UseMessages(const std::vector<Message>& messages) {
+        size_t touched = 0;
+        for (const auto& message : messages) {
+            touched += message.GetNick().size() + message.GetContent().size() + message.GetId().size()
+                + message.GetChannel().size() + static_cast<size_t>(message.GetRole());
+        }
+        return touched;
+    }
+
+    // Parses traffic in read sized chunks, tail goes to the next chunk the way ReadBuffer keeps it
+    template <typename ParseFn>
+    size_t ParseInChunks(std::string_view traffic, size_t chunk_size, ParseFn&& parse) {
+        size_t messages = 0;
+        size_t begin = 0;
+        for (size_t end = std::min(chunk_size, traffic.size()); ; end = std::min(end + chunk_size, traffic.size())) {
+            begin += parse(traffic.substr(begin, end - begin), messages);
+            if (end == traffic.size()) {
+                break;
+            }
+        }
+        return messages;
+    }
+
+    void Report(benchmark::State& state, size_t messages, size_t allocations) {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * GetTraffic().size()));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * messages));
+        state.counters["allocs_per_message"] = benchmark::Counter(
+            static_cast<double>(allocations) / (static_cast<double>(messages) * state.iterations()));
+    }
+
+    // Vector returned per read: one allocation per read, none per message
+    void BM_ParseMessages_Returned(benchmark::State& state) {
+        const std::string& traffic = GetTraffic();
+        const size_t chunk_size = static_cast<size_t>(state.range(0));
+        MessageProcessor processor;
+        auto parse = [&processor](std::string_view raw_bytes, size_t& messages) {
+            size_t consumed = 0;
+            auto read_result = processor.GetMessagesFromRawBytes(raw_bytes, consumed);
+            benchmark::DoNotOptimize(UseMessages(read_result));
+            messages += read_result.size();
+            return consumed;
+        };
+        ParseInChunks(traffic, chunk_size, parse);
+
+        size_t messages = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            messages = ParseInChunks(traffic, chunk_size, parse);
+        }
+        Report(state, messages, scope.Count());
+    }
+
+    // Reused vector and pooled slabs: steady state doesn't touch the heap, MessageProcessorTest checks it
+    void BM_ParseMessages_Reused(benchmark::State& state) {
+        const std::string& traffic = GetTraffic();
+        const size_t chunk_size = static_cast<size_t>(state.range(0));
+        MessageProcessor processor;
+        std::vector<Message> read_result;
+        auto parse = [&processor, &read_result](std::string_view raw_bytes, size_t& messages) {
+            size_t consumed = 0;
+            processor.GetMessagesFromRawBytes(raw_bytes, consumed, read_result);
+            benchmark::DoNotOptimize(UseMessages(read_result));
+            messages += read_result.size();
+            return consumed;
+        };
+        ParseInChunks(traffic, chunk_size, parse);
+
+        size_t messages = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            messages = ParseInChunks(traffic, chunk_size, parse);
+        }
+        Report(state, messages, scope.Count());
+    }
+
+} // namespace
+
+BENCHMARK(BM_ParseMessages_Returned)->Arg(4096)->Arg(65536)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseMessages_Reused)->Arg(4096)->Arg(65536)->Unit(benchmark::kMicrosecond);
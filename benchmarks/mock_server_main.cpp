@@ -0,0 +1,60 @@
+#include "mock_twitch_server.h"
+#include "tool_options.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+namespace net = boost::asio;
+
+// Standalone mock server for running a real bot against it. With --tls the CA is written to
+// mock_twitch_ca.pem, client trusts it through TlsClientContext::AddCertificateAuthority
+int main(int argc, char* argv[]) {
+    const mock_twitch::ToolOptions options(argc, argv);
+    if (options.Has("help")) {
+        std::cout << "Usage: TwitchMockServer [--port 6667] [--tls] [--rate 1000] [--threads 1]\n"
+            "  [--disconnect-after-ms 0] [--reconnect-after-ms 0] [--read-delay-ms 0]\n";
+        return 0;
+    }
+
+    mock_twitch::ServerConfig config;
+    config.port = static_cast<uint16_t>(options.GetNumber("port", 6667));
+    config.tls = options.Has("tls");
+    config.messages_per_second = options.GetNumber("rate", 1000);
+    config.disconnect_after = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("disconnect-after-ms", 0)));
+    config.reconnect_after = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("reconnect-after-ms", 0)));
+    config.read_delay = std::chrono::milliseconds(static_cast<int64_t>(options.GetNumber("read-delay-ms", 0)));
+    const auto threads = std::max<unsigned>(static_cast<unsigned>(options.GetNumber("threads", 1)), 1);
+
+    net::io_context ioc(static_cast<int>(threads));
+    auto server = std::make_shared<mock_twitch::MockServer>(ioc, config);
+    server->Start();
+    if (config.tls) {
+        std::ofstream("mock_twitch_ca.pem") << server->GetCaCertificate();
+    }
+
+    net::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int) {
+        const auto stats = server->GetStats();
+        std::cout << "sessions " << stats.sessions << ", chat lines " << stats.chat_lines << ", dropped " << stats.dropped_lines
+            << ", received lines " << stats.received_lines << "\n";
+        server->Stop();
+        ioc.stop();
+        });
+
+    std::vector<std::jthread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back([&ioc]() {
+            ioc.run();
+            });
+    }
+    ioc.run();
+    return 0;
+}
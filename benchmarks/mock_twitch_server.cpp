@@ -0,0 +1,437 @@
+#include "mock_twitch_server.h"
+
+#include "logging.h"
+#include "tls_identity.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <variant>
+
+
+namespace mock_twitch {
+
+    namespace sys = boost::system;
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    namespace {
+
+        constexpr size_t VIEWERS = 1000;
+
+        void AppendNumber(std::string& out, uint64_t value, size_t width = 0) {
+            char digits[24];
+            auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), value);
+            const size_t size = static_cast<size_t>(end - digits);
+            if (size < width) {
+                out.append(width - size, '0');
+            }
+            out.append(digits, size);
+        }
+
+        // "JOIN #a,#b" -> "#a", "#b"
+        template <typename Fn>
+        void ForEachChannel(std::string_view list, Fn&& fn) {
+            while (!list.empty()) {
+                size_t comma = std::min(list.find(','), list.size());
+                if (comma > 0) {
+                    fn(list.substr(0, comma));
+                }
+                list.remove_prefix(std::min(comma + 1, list.size()));
+            }
+        }
+
+    } // namespace
+
+    class Session : public std::enable_shared_from_this<Session> {
+    public:
+        using Stream = std::variant<tcp::socket, ssl::stream<tcp::socket>>;
+
+        Session(std::shared_ptr<MockServer> server, tcp::socket&& socket)
+            : server_(std::move(server))
+            , strand_(net::make_strand(server_->ioc_))
+            , stream_(MakeStream(std::move(socket), server_->ssl_ctx_.get()))
+            , traffic_timer_(strand_)
+            , read_timer_(strand_)
+            , disconnect_timer_(strand_)
+            , reconnect_timer_(strand_)
+        {
+        }
+
+        void Start() {
+            net::post(strand_, [self = shared_from_this()]() {
+                if (auto* tls = std::get_if<ssl::stream<tcp::socket>>(&self->stream_)) {
+                    tls->async_handshake(ssl::stream_base::server, net::bind_executor(self->strand_
+                        , [self](const sys::error_code& ec) {
+                            if (ec) {
+                                logging::ReportError(ec, "Mock server handshake");
+                                self->Close();
+                                return;
+                            }
+                            self->Begin();
+                        }));
+                    return;
+                }
+                self->Begin();
+                });
+        }
+
+        void Close() {
+            net::post(strand_, [self = shared_from_this()]() {
+                self->DoClose();
+                });
+        }
+
+    private:
+        std::shared_ptr<MockServer> server_;
+        Strand strand_;
+        Stream stream_;
+        net::steady_timer traffic_timer_;
+        net::steady_timer read_timer_;
+        net::steady_timer disconnect_timer_;
+        net::steady_timer reconnect_timer_;
+
+        std::string input_;
+        std::string pending_;
+        std::string writing_;
+        bool write_in_flight_ = false;
+        bool closed_ = false;
+
+        std::string nick_ = "justinfan";
+        std::vector<std::string> channels_;
+        size_t next_channel_ = 0;
+        double budget_ = 0;
+        std::chrono::steady_clock::time_point last_tick_;
+
+        static Stream MakeStream(tcp::socket&& socket, ssl::context* ctx) {
+            if (ctx) {
+                return Stream(std::in_place_type<ssl::stream<tcp::socket>>, std::move(socket), *ctx);
+            }
+            return Stream(std::in_place_type<tcp::socket>, std::move(socket));
+        }
+
+        void Begin() {
+            const auto& config = server_->config_;
+            ScheduleFault(disconnect_timer_, config.disconnect_after, [](Session& session) {
+                LOG_INFO("Mock server: injected disconnect");
+                ++session.server_->disconnects_;
+                session.DoClose();
+                });
+            ScheduleFault(reconnect_timer_, config.reconnect_after, [](Session& session) {
+                LOG_INFO("Mock server: injected RECONNECT");
+                ++session.server_->reconnects_;
+                session.Send(":tmi.twitch.tv RECONNECT\r\n"sv);
+                });
+            last_tick_ = std::chrono::steady_clock::now();
+            ScheduleTick();
+            Read();
+        }
+
+        template <typename Fault>
+        void ScheduleFault(net::steady_timer& timer, std::chrono::milliseconds after, Fault fault) {
+            if (after.count() <= 0) {
+                return;
+            }
+            timer.expires_after(after);
+            timer.async_wait([self = shared_from_this(), fault](const sys::error_code& ec) {
+                if (!ec && !self->closed_) {
+                    fault(*self);
+                }
+                });
+        }
+
+        void Read() {
+            if (closed_) {
+                return;
+            }
+            const auto delay = server_->config_.read_delay;
+            if (delay.count() > 0) {
+                read_timer_.expires_after(delay);
+                read_timer_.async_wait([self = shared_from_this()](const sys::error_code& ec) {
+                    if (!ec) {
+                        self->ReadLine();
+                    }
+                    });
+                return;
+            }
+            ReadLine();
+        }
+
+        void ReadLine() {
+            std::visit([this](auto& stream) {
+                net::async_read_until(stream, net::dynamic_buffer(input_), "\r\n"
+                    , net::bind_executor(strand_, [self = shared_from_this()](const sys::error_code& ec, size_t size) {
+                        self->OnRead(ec, size);
+                        }));
+                }, stream_);
+        }
+
+        void OnRead(const sys::error_code& ec, size_t size) {
+            if (ec) {
+                DoClose();
+                return;
+            }
+            ++server_->received_lines_;
+            HandleLine(std::string_view(input_).substr(0, size - 2));
+            input_.erase(0, size);
+            Read();
+        }
+
+        void HandleLine(std::string_view line) {
+            const size_t space = std::min(line.find(' '), line.size());
+            const std::string_view command = line.substr(0, space);
+            const std::string_view args = line.substr(std::min(space + 1, line.size()));
+
+            if (command == "NICK"sv) {
+                nick_ = std::string(args);
+                for (std::string_view numeric : { "001 "sv, "002 "sv, "003 "sv, "004 "sv, "375 "sv, "372 "sv, "376 "sv }) {
+                    Send(":tmi.twitch.tv "s.append(numeric).append(nick_).append(" :-\r\n"));
+                }
+            }
+            else if (command == "CAP"sv) {
+                // CAP REQ :twitch.tv/tags twitch.tv/commands
+                const size_t colon = args.find(':');
+                Send(":tmi.twitch.tv CAP * ACK :"s.append(colon == std::string_view::npos ? ""sv : args.substr(colon + 1)).append("\r\n"));
+            }
+            else if (command == "JOIN"sv) {
+                ForEachChannel(args, [this](std::string_view channel) {
+                    Send(":"s.append(nick_).append("!").append(nick_).append("@").append(nick_).append(".tmi.twitch.tv JOIN ")
+                        .append(channel).append("\r\n"));
+                    Send("@emote-only=0;followers-only=-1;r9k=0;room-id=1;slow=0;subs-only=0 :tmi.twitch.tv ROOMSTATE "s
+                        .append(channel).append("\r\n"));
+                    channel.remove_prefix(channel.starts_with('#') ? 1 : 0);
+                    if (std::find(channels_.begin(), channels_.end(), channel) == channels_.end()) {
+                        channels_.emplace_back(channel);
+                    }
+                    });
+            }
+            else if (command == "PART"sv) {
+                ForEachChannel(args, [this](std::string_view channel) {
+                    Send(":"s.append(nick_).append("!").append(nick_).append("@").append(nick_).append(".tmi.twitch.tv PART ")
+                        .append(channel).append("\r\n"));
+                    channel.remove_prefix(channel.starts_with('#') ? 1 : 0);
+                    channels_.erase(std::remove(channels_.begin(), channels_.end(), channel), channels_.end());
+                    });
+            }
+            else if (command == "PING"sv) {
+                Send(":tmi.twitch.tv PONG tmi.twitch.tv :"s.append(args.starts_with(':') ? args.substr(1) : args).append("\r\n"));
+            }
+            // PASS, PONG and our own PRIVMSG need no answer
+        }
+
+        void ScheduleTick() {
+            traffic_timer_.expires_after(server_->config_.tick);
+            traffic_timer_.async_wait([self = shared_from_this()](const sys::error_code& ec) {
+                if (!ec && !self->closed_) {
+                    self->OnTick();
+                }
+                });
+        }
+
+        // Chat due since last tick goes out as one write
+        void OnTick() {
+            const auto now = std::chrono::steady_clock::now();
+            budget_ += server_->rate_.load() * std::chrono::duration<double>(now - last_tick_).count();
+            last_tick_ = now;
+            if (channels_.empty()) {
+                budget_ = 0;
+            }
+            const auto count = static_cast<size_t>(budget_);
+            budget_ -= static_cast<double>(count);
+
+            if (pending_.size() >= server_->config_.max_backlog) {
+                server_->dropped_lines_ += count;
+            }
+            else {
+                for (size_t i = 0; i < count; ++i) {
+                    AppendChat();
+                }
+                server_->chat_lines_ += count;
+                StartWrite();
+            }
+            ScheduleTick();
+        }
+
+        void AppendChat() {
+            const uint64_t id = server_->next_message_id_++;
+            const uint64_t viewer = id % VIEWERS;
+            const std::string& channel = channels_[next_channel_++ % channels_.size()];
+            const auto sent = std::chrono::steady_clock::now().time_since_epoch();
+
+            pending_.append("@badge-info=subscriber/12;badges=subscriber/12,premium/1;color=#1E90FF;display-name=Viewer"sv);
+            AppendNumber(pending_, viewer);
+            pending_.append(";emotes=;first-msg=0;flags=;id=00000000-0000-4000-8000-"sv);
+            AppendNumber(pending_, id, 12);
+            pending_.append(";mod=0;returning-chatter=0;room-id=1;subscriber=1;tmi-sent-ts="sv);
+            AppendNumber(pending_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count()));
+            pending_.append(";turbo=0;user-id="sv);
+            AppendNumber(pending_, 100000 + viewer);
+            pending_.append(";user-type= :viewer"sv);
+            AppendNumber(pending_, viewer);
+            pending_.append("!viewer"sv);
+            AppendNumber(pending_, viewer);
+            pending_.append("@viewer"sv);
+            AppendNumber(pending_, viewer);
+            pending_.append(".tmi.twitch.tv PRIVMSG #"sv).append(channel).append(" :!"sv).append(server_->config_.command).append(" "sv);
+            AppendNumber(pending_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sent).count()));
+            pending_.append("\r\n"sv);
+        }
+
+        void Send(std::string_view line) {
+            pending_.append(line);
+            StartWrite();
+        }
+
+        void StartWrite() {
+            if (write_in_flight_ || pending_.empty() || closed_) {
+                return;
+            }
+            writing_.swap(pending_);
+            pending_.clear();
+            write_in_flight_ = true;
+            std::visit([this](auto& stream) {
+                net::async_write(stream, net::buffer(writing_)
+                    , net::bind_executor(strand_, [self = shared_from_this()](const sys::error_code& ec, size_t bytes) {
+                        self->OnWrite(ec, bytes);
+                        }));
+                }, stream_);
+        }
+
+        void OnWrite(const sys::error_code& ec, size_t bytes) {
+            write_in_flight_ = false;
+            server_->bytes_ += bytes;
+            if (ec) {
+                DoClose();
+                return;
+            }
+            StartWrite();
+        }
+
+        void DoClose() {
+            if (closed_) {
+                return;
+            }
+            closed_ = true;
+            --server_->active_sessions_;
+            traffic_timer_.cancel();
+            read_timer_.cancel();
+            disconnect_timer_.cancel();
+            reconnect_timer_.cancel();
+            std::visit([](auto& stream) {
+                sys::error_code ignored;
+                stream.lowest_layer().close(ignored);
+                }, stream_);
+        }
+    };
+
+    MockServer::MockServer(net::io_context& ioc, ServerConfig config)
+        : ioc_(ioc)
+        , config_(std::move(config))
+        , acceptor_(ioc)
+        , rate_(config_.messages_per_second)
+    {
+        if (config_.tls) {
+            auto identity = MakeTlsIdentity();
+            ssl_ctx_ = std::make_unique<ssl::context>(ssl::context::tls_server);
+            ssl_ctx_->use_certificate_chain(net::buffer(identity.certificate));
+            ssl_ctx_->use_private_key(net::buffer(identity.private_key), ssl::context::pem);
+            ca_certificate_ = std::move(identity.ca_certificate);
+        }
+    }
+
+    void MockServer::Start() {
+        tcp::endpoint endpoint(net::ip::make_address(config_.address), config_.port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(net::socket_base::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+        LOG_INFO("Mock server listening on port "s.append(std::to_string(GetPort())).append(config_.tls ? " (TLS)" : ""));
+        Accept();
+    }
+
+    void MockServer::Stop() {
+        stopped_ = true;
+        net::post(ioc_, [self = shared_from_this()]() {
+            sys::error_code ignored;
+            self->acceptor_.close(ignored);
+            });
+        std::lock_guard lock(sessions_mutex_);
+        for (auto& weak_session : sessions_) {
+            if (auto session = weak_session.lock()) {
+                session->Close();
+            }
+        }
+        sessions_.clear();
+    }
+
+    uint16_t MockServer::GetPort() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    const std::string& MockServer::GetCaCertificate() const {
+        return ca_certificate_;
+    }
+
+    void MockServer::SetRate(double messages_per_second) {
+        rate_ = messages_per_second;
+    }
+
+    double MockServer::GetRate() const {
+        return rate_.load();
+    }
+
+    const ServerConfig& MockServer::GetConfig() const {
+        return config_;
+    }
+
+    ServerStats MockServer::GetStats() const {
+        ServerStats stats;
+        stats.sessions = sessions_count_.load();
+        stats.active_sessions = active_sessions_.load();
+        stats.chat_lines = chat_lines_.load();
+        stats.dropped_lines = dropped_lines_.load();
+        stats.bytes = bytes_.load();
+        stats.received_lines = received_lines_.load();
+        stats.disconnects = disconnects_.load();
+        stats.reconnects = reconnects_.load();
+        return stats;
+    }
+
+    void MockServer::Accept() {
+        acceptor_.async_accept([self = shared_from_this()](const sys::error_code& ec, tcp::socket socket) {
+            self->OnAccept(ec, std::move(socket));
+            });
+    }
+
+    void MockServer::OnAccept(const sys::error_code& ec, tcp::socket socket) {
+        if (stopped_) {
+            return;
+        }
+        if (ec) {
+            logging::ReportError(ec, "Mock server accept");
+        }
+        else {
+            socket.set_option(tcp::no_delay(true));
+            auto session = std::make_shared<Session>(shared_from_this(), std::move(socket));
+            ++sessions_count_;
+            ++active_sessions_;
+            {
+                std::lock_guard lock(sessions_mutex_);
+                std::erase_if(sessions_, [](const std::weak_ptr<Session>& weak_session) {
+                    return weak_session.expired();
+                    });
+                sessions_.push_back(session);
+            }
+            session->Start();
+        }
+        Accept();
+    }
+
+} // namespace mock_twitch
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace mock_twitch {
+
+    namespace net = boost::asio;
+    namespace ssl = net::ssl;
+    using net::ip::tcp;
+    using namespace std::literals;
+
+    struct ServerConfig {
+        std::string address = "127.0.0.1";
+        uint16_t port = 0;  // any free port
+        bool tls = false;
+        // Chat per connection, spread round robin over the channels it joined
+        double messages_per_second = 1000;
+        std::chrono::milliseconds tick = 5ms;
+        // Chat text is "!<command> <steady clock ns at send>", so the bot can measure latency
+        std::string command = "load";
+        // Chat not written yet above this is dropped: the client doesn't keep up
+        size_t max_backlog = 64 * 1024 * 1024;
+
+        // Faults, zero is off. Each fires once per connection
+        std::chrono::milliseconds disconnect_after{ 0 };  // close socket without goodbye
+        std::chrono::milliseconds reconnect_after{ 0 };   // send RECONNECT and keep serving
+        std::chrono::milliseconds read_delay{ 0 };        // pause before every read of client lines
+    };
+
+    struct ServerStats {
+        size_t sessions = 0;
+        size_t active_sessions = 0;
+        size_t chat_lines = 0;
+        size_t dropped_lines = 0;
+        size_t bytes = 0;
+        size_t received_lines = 0;
+        size_t disconnects = 0;
+        size_t reconnects = 0;
+    };
+
+    class Session;
+
+    // Stand-in for irc.chat.twitch.tv with the subset irc::Client speaks: PASS/NICK with welcome
+    // numerics, CAP REQ ack, JOIN/PART echo and PING. Joined connections get synthetic tagged PRIVMSG
+    // at the configured rate. With tls a self-signed CA is made on construction
+    class MockServer : public std::enable_shared_from_this<MockServer> {
+    public:
+        MockServer(net::io_context& ioc, ServerConfig config);
+
+        void Start();
+        void Stop();
+
+        uint16_t GetPort() const;
+        // PEM of the CA that issued server certificate, empty without tls
+        const std::string& GetCaCertificate() const;
+        // Takes effect on next tick of every connection
+        void SetRate(double messages_per_second);
+        double GetRate() const;
+        const ServerConfig& GetConfig() const;
+        ServerStats GetStats() const;
+
+    private:
+        friend class Session;
+
+        net::io_context& ioc_;
+        ServerConfig config_;
+        tcp::acceptor acceptor_;
+        std::unique_ptr<ssl::context> ssl_ctx_;
+        std::string ca_certificate_;
+        std::atomic<double> rate_;
+        std::atomic<bool> stopped_{ false };
+
+        std::mutex sessions_mutex_;
+        std::vector<std::weak_ptr<Session>> sessions_;
+
+        std::atomic<size_t> sessions_count_{ 0 };
+        std::atomic<size_t> active_sessions_{ 0 };
+        std::atomic<size_t> chat_lines_{ 0 };
+        std::atomic<size_t> dropped_lines_{ 0 };
+        std::atomic<size_t> bytes_{ 0 };
+        std::atomic<size_t> received_lines_{ 0 };
+        std::atomic<size_t> disconnects_{ 0 };
+        std::atomic<size_t> reconnects_{ 0 };
+        std::atomic<uint64_t> next_message_id_{ 0 };
+
+        void Accept();
+        void OnAccept(const boost::system::error_code& ec, tcp::socket socket);
+    };
+
+} // namespace mock_twitch
@@ -0,0 +1,142 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "chat_bot.h"
+#include "command.h"
+#include "command_executor.h"
+#include "keyword_matcher.h"
+#include "message_processor.h"
+#include "shared_message.h"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::Role;
+    using irc::domain::SharedMessage;
+    using irc::message_processor::MessageProcessor;
+    using namespace std::literals;
+
+    class CountingExecutor : public commands::ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        explicit CountingExecutor(size_t& calls)
+            : calls_(calls)
+        {
+        }
+
+        void operator()(std::string_view arguments) override {
+            benchmark::DoNotOptimize(arguments.data());
+            ++calls_;
+        }
+
+    private:
+        size_t& calls_;
+    };
+
+    // Keywords the way modes declare them: a few that chat really says, the rest are rare words
+    // and links that only add states to the automaton
+    std::string MakeKeyword(size_t i) {
+        switch (i) {
+        case 0:
+            return "PogChamp";
+        case 1:
+            return "the map";
+        default:
+            return (i % 2 == 0 ? "osu.ppy.sh/b/"s : "trigger_"s).append(std::to_string(i * 7919 % 100003));
+        }
+    }
+
+    std::vector<SharedMessage> ParseShared(const std::vector<std::string>& lines) {
+        MessageProcessor processor;
+        std::vector<SharedMessage> shared;
+        for (const auto& line : lines) {
+            size_t consumed = 0;
+            for (auto& message : processor.GetMessagesFromRawBytes(line, consumed)) {
+                shared.push_back(SharedMessage::Make(std::move(message)));
+            }
+        }
+        return shared;
+    }
+
+    // One pass of range(0) keywords over chat messages
+    void BM_ModeTriggers_Scan(benchmark::State& state) {
+        const auto keywords_count = static_cast<size_t>(state.range(0));
+        commands::KeywordMatcher matcher;
+        for (size_t i = 0; i < keywords_count; ++i) {
+            matcher.Add(MakeKeyword(i), static_cast<uint32_t>(i));
+        }
+        matcher.Build();
+        const auto messages = ParseShared(benchmarks::ChatCorpus::MakeLines(64));
+        size_t bytes = 0;
+        for (const auto& message : messages) {
+            bytes += message->GetContent().size();
+        }
+
+        size_t found = 0;
+        for (auto _ : state) {
+            for (const auto& message : messages) {
+                matcher.Scan(message->GetContent(), [&found](uint32_t) {
+                    ++found;
+                    });
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        state.SetItemsProcessed(static_cast<int64_t>(messages.size() * state.iterations()));
+        state.SetBytesProcessed(static_cast<int64_t>(bytes * state.iterations()));
+        state.counters["states"] = benchmark::Counter(static_cast<double>(matcher.GetStatesCount()));
+    }
+
+    // ChatBot with range(0) modes. With range(1) == 1 every mode has a keyword and only matched
+    // ones run, with 0 every mode runs on every message as before triggers
+    void BM_ModeTriggers_Dispatch(benchmark::State& state) {
+        const auto modes_count = static_cast<size_t>(state.range(0));
+        const bool with_triggers = state.range(1) != 0;
+        const auto messages = ParseShared(benchmarks::ChatCorpus::MakeLines(64));
+        boost::asio::io_context ioc;
+        auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+        size_t calls = 0;
+        for (size_t i = 0; i < modes_count; ++i) {
+            const std::string name = "mode_"s.append(std::to_string(i));
+            chat_bot::Mode mode(std::make_unique<CountingExecutor>(calls));
+            mode.SetRoleLevel(static_cast<int>(Role::EMPTY));
+            chat_bot->AddMode(name, std::move(mode));
+            if (with_triggers) {
+                chat_bot->AddModeTrigger(name, MakeKeyword(i));
+            }
+        }
+
+        auto dispatch_all = [&]() {
+            for (const auto& message : messages) {
+                chat_bot->ParseAndExecute(message);
+            }
+            ioc.restart();
+            ioc.run();
+        };
+        // Builds the automaton and warms up per thread buffers
+        dispatch_all();
+
+        calls = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            dispatch_all();
+        }
+        const double dispatched = static_cast<double>(messages.size() * state.iterations());
+        state.counters["allocs_per_message"] = benchmark::Counter(static_cast<double>(scope.Count()) / dispatched);
+        state.counters["modes_per_message"] = benchmark::Counter(static_cast<double>(calls) / dispatched);
+        state.SetItemsProcessed(static_cast<int64_t>(dispatched));
+    }
+
+} // namespace
+
+BENCHMARK(BM_ModeTriggers_Scan)->Arg(16)->Arg(1024)->Arg(4096);
+BENCHMARK(BM_ModeTriggers_Dispatch)->ArgsProduct({ { 16, 1024 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,253 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "chat_bot.h"
+#include "command.h"
+#include "command_executor.h"
+#include "message_processor.h"
+#include "shared_message.h"
+#include "user_validator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using benchmarks::ChatCorpus;
+    using benchmarks::LineKind;
+    using irc::domain::Message;
+    using irc::domain::Role;
+    using irc::domain::SharedMessage;
+    using irc::message_processor::MessageProcessor;
+    using namespace std::literals;
+
+    constexpr size_t TRAFFIC_SIZE = 256 * 1024;
+    constexpr size_t READ_SIZE = 4096;
+
+    void ReportAllocations(benchmark::State& state, size_t allocations, size_t operations) {
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(allocations) / static_cast<double>(operations));
+    }
+
+    // Messages parsed once, kept alive for the benchmarks that work on ready messages
+    std::vector<Message> ParseLines(const std::vector<std::string>& lines) {
+        MessageProcessor processor;
+        std::vector<Message> messages;
+        for (const auto& line : lines) {
+            size_t consumed = 0;
+            auto parsed = processor.GetMessagesFromRawBytes(line, consumed);
+            messages.insert(messages.end(), std::make_move_iterator(parsed.begin()), std::make_move_iterator(parsed.end()));
+        }
+        return messages;
+    }
+
+    class CountingExecutor : public commands::ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        explicit CountingExecutor(size_t& calls)
+            : calls_(&calls)
+        {
+        }
+
+        void operator()([[maybe_unused]] std::string_view content) override {
+            ++*calls_;
+        }
+
+    private:
+        size_t* calls_;
+    };
+
+    // GetMessagesFromRawBytes over traffic of one line kind in read sized chunks, vector reused
+    void BM_Pipeline_Parse(benchmark::State& state) {
+        const auto kind = static_cast<LineKind>(state.range(0));
+        state.SetLabel(std::string(ChatCorpus::GetKindName(kind)));
+        const std::string traffic = ChatCorpus::MakeTraffic(TRAFFIC_SIZE, kind);
+        MessageProcessor processor;
+        std::vector<Message> messages;
+
+        auto parse_all = [&]() {
+            size_t parsed = 0;
+            size_t begin = 0;
+            while (begin < traffic.size()) {
+                size_t consumed = 0;
+                processor.GetMessagesFromRawBytes(std::string_view(traffic).substr(begin, READ_SIZE), consumed, messages);
+                parsed += messages.size();
+                begin += consumed;
+            }
+            return parsed;
+        };
+        parse_all();
+
+        size_t parsed = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            parsed = parse_all();
+        }
+        ReportAllocations(state, scope.Count(), parsed * state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(parsed * state.iterations()));
+        state.SetBytesProcessed(static_cast<int64_t>(traffic.size() * state.iterations()));
+    }
+
+    // One line into one Message, the way a read with a single line goes
+    void BM_Pipeline_MessageConstruction(benchmark::State& state) {
+        const auto kind = static_cast<LineKind>(state.range(0));
+        state.SetLabel(std::string(ChatCorpus::GetKindName(kind)));
+        const std::string line = ChatCorpus::MakeLine(kind, "viewer_one"sv);
+        MessageProcessor processor;
+        std::vector<Message> messages;
+        size_t consumed = 0;
+        processor.GetMessagesFromRawBytes(line, consumed, messages);
+
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            processor.GetMessagesFromRawBytes(line, consumed, messages);
+            benchmark::DoNotOptimize(messages.data());
+        }
+        ReportAllocations(state, scope.Count(), state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    void BM_Pipeline_GetNickAndRole(benchmark::State& state) {
+        const auto messages = ParseLines(ChatCorpus::MakeLines(64));
+
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            for (const auto& message : messages) {
+                benchmark::DoNotOptimize(message.GetNick());
+                benchmark::DoNotOptimize(message.GetRole());
+            }
+        }
+        ReportAllocations(state, scope.Count(), messages.size() * state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(messages.size() * state.iterations()));
+    }
+
+    std::vector<SharedMessage> ShareMessages(std::vector<Message>&& messages) {
+        std::vector<SharedMessage> shared;
+        for (auto& message : messages) {
+            shared.push_back(SharedMessage::Make(std::move(message)));
+        }
+        return shared;
+    }
+
+    // ParseAndExecute posts modes and command handling to io_context, run drains it.
+    // Every fourth corpus line is "!test some args"
+    void BM_Pipeline_ChatBotDispatch(benchmark::State& state) {
+        const auto messages = ShareMessages(ParseLines(ChatCorpus::MakeLines(64)));
+        boost::asio::io_context ioc;
+        auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+        size_t calls = 0;
+        commands::Command command(std::make_unique<CountingExecutor>(calls));
+        command.SetRoleLevel(static_cast<int>(Role::EMPTY));
+        chat_bot->AddCommand("test"sv, std::move(command));
+
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            for (const auto& message : messages) {
+                chat_bot->ParseAndExecute(message);
+            }
+            ioc.restart();
+            ioc.run();
+        }
+        ReportAllocations(state, scope.Count(), messages.size() * state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(messages.size() * state.iterations()));
+        state.counters["commands"] = benchmark::Counter(static_cast<double>(calls));
+    }
+
+    // Freshly parsed message moved into a pooled node and handed to range(0) modes and the command.
+    // Message is move only, so copies per message are zero by construction: handles only touch
+    // the reference count. allocs_per_message has to stay flat as the number of modes grows
+    void BM_Pipeline_FanOut(benchmark::State& state) {
+        const auto modes = static_cast<size_t>(state.range(0));
+        const std::vector<std::string> lines = ChatCorpus::MakeLines(64);
+        MessageProcessor processor;
+        std::vector<Message> messages;
+        boost::asio::io_context ioc;
+        auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+        size_t calls = 0;
+        for (size_t i = 0; i < modes; ++i) {
+            chat_bot::Mode mode(std::make_unique<CountingExecutor>(calls));
+            mode.SetRoleLevel(static_cast<int>(Role::EMPTY));
+            chat_bot->AddMode("mode_"s.append(std::to_string(i)), std::move(mode));
+        }
+        commands::Command command(std::make_unique<CountingExecutor>(calls));
+        command.SetRoleLevel(static_cast<int>(Role::EMPTY));
+        chat_bot->AddCommand("test"sv, std::move(command));
+
+        auto dispatch_all = [&]() {
+            for (const auto& line : lines) {
+                size_t consumed = 0;
+                processor.GetMessagesFromRawBytes(line, consumed, messages);
+                for (auto& message : messages) {
+                    chat_bot->ParseAndExecute(SharedMessage::Make(std::move(message)));
+                }
+            }
+            ioc.restart();
+            ioc.run();
+        };
+        // Warms up slab and node pools
+        dispatch_all();
+
+        const auto pool_before = irc::domain::MessagePool::Instance().GetStats();
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            dispatch_all();
+        }
+        const auto pool_after = irc::domain::MessagePool::Instance().GetStats();
+        const double dispatched = static_cast<double>(lines.size() * state.iterations());
+        state.counters["allocs_per_message"] = benchmark::Counter(static_cast<double>(scope.Count()) / dispatched);
+        state.counters["nodes_created"] = benchmark::Counter(static_cast<double>(pool_after.created - pool_before.created));
+        state.SetItemsProcessed(static_cast<int64_t>(dispatched));
+        benchmark::DoNotOptimize(calls);
+    }
+
+    // Black list hit, white list hit and role check, lists of realistic size
+    void BM_Pipeline_UserVerify(benchmark::State& state) {
+        std::vector<std::string> white_list;
+        std::vector<std::string> black_list;
+        for (int i = 0; i < 64; ++i) {
+            black_list.push_back("banned_user_"s.append(std::to_string(i)));
+            white_list.push_back("trusted_user_"s.append(std::to_string(i)));
+        }
+        commands::user_validator::UserVerificator verificator(white_list, black_list);
+        const std::vector<std::pair<std::string, Role>> users{
+            { "banned_user_7", Role::MODERATOR },
+            { "trusted_user_42", Role::EMPTY },
+            { "SomeLongerNickname42", Role::SUBSCRIBER },
+            { "mod_user", Role::MODERATOR },
+        };
+
+        size_t accepted = 0;
+        benchmarks::AllocationScope scope;
+        for (auto _ : state) {
+            for (const auto& [name, role] : users) {
+                accepted += verificator.Verify(name, role);
+            }
+        }
+        benchmark::DoNotOptimize(accepted);
+        ReportAllocations(state, scope.Count(), users.size() * state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(users.size() * state.iterations()));
+    }
+
+    void LineKinds(benchmark::internal::Benchmark* benchmark) {
+        for (auto kind : ChatCorpus::KINDS) {
+            benchmark->Arg(static_cast<int64_t>(kind));
+        }
+    }
+
+} // namespace
+
+BENCHMARK(BM_Pipeline_Parse)->Apply(LineKinds)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Pipeline_MessageConstruction)->Apply(LineKinds);
+BENCHMARK(BM_Pipeline_GetNickAndRole);
+BENCHMARK(BM_Pipeline_ChatBotDispatch)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Pipeline_FanOut)->Arg(0)->Arg(4)->Arg(16);
+BENCHMARK(BM_Pipeline_UserVerify);
@@ -0,0 +1,206 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "connection.h"
+#include "message_processor.h"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    namespace net = boost::asio;
+    namespace sys = boost::system;
+    using net::ip::tcp;
+
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    constexpr size_t TRAFFIC_SIZE = 1024 * 1024;
+    constexpr double MEGABYTE = 1024.0 * 1024.0;
+
+    struct ReadStats {
+        size_t reads = 0;
+        size_t messages = 0;
+        size_t bytes = 0;
+    };
+
+    // Accepts one client, sends traffic and closes
+    class LoopbackServer {
+    public:
+        explicit LoopbackServer(const std::string& traffic)
+            : acceptor_(ioc_, tcp::endpoint(net::ip::address_v4::loopback(), 0))
+            , thread_([this, &traffic]() {
+                tcp::socket socket(ioc_);
+                acceptor_.accept(socket);
+                net::write(socket, net::buffer(traffic));
+                sys::error_code ignor;
+                socket.shutdown(tcp::socket::shutdown_both, ignor);
+            })
+        {
+        }
+
+        ~LoopbackServer() {
+            thread_.join();
+        }
+
+        std::string GetPort() const {
+            return std::to_string(acceptor_.local_endpoint().port());
+        }
+
+    private:
+        net::io_context ioc_;
+        tcp::acceptor acceptor_;
+        std::thread thread_;
+    };
+
+    class ReadBufferReader {
+    public:
+        ReadBufferReader(std::shared_ptr<connection::Connection> connection
+            , irc::message_processor::MessageProcessor& processor, ReadStats& stats)
+            : connection_(connection)
+            , processor_(&processor)
+            , stats_(&stats)
+        {
+        }
+
+        void operator()(connection::ReadBuffer& buffer) {
+            ++stats_->reads;
+            size_t consumed = 0;
+            auto messages = processor_->GetMessagesFromRawBytes(buffer.Data(), consumed);
+            buffer.Consume(consumed);
+            stats_->messages += messages.size();
+            stats_->bytes += consumed;
+            if (!connection_->IsReconnectRequired()) {
+                connection_->AsyncRead(*this);
+            }
+        }
+
+    private:
+        std::shared_ptr<connection::Connection> connection_;
+        irc::message_processor::MessageProcessor* processor_;
+        ReadStats* stats_;
+    };
+
+    // Pre-ring-buffer read path: 128 byte reads, copy into fresh vector, post, re-assemble tail
+    class LegacyReader : public std::enable_shared_from_this<LegacyReader> {
+    public:
+        LegacyReader(net::io_context& ioc, tcp::socket&& socket, ReadStats& stats)
+            : strand_(net::make_strand(ioc))
+            , socket_(std::move(socket))
+            , stats_(&stats)
+        {
+        }
+
+        void Read() {
+            net::async_read(socket_, net::buffer(*buffer_), net::transfer_at_least(1)
+                , net::bind_executor(strand_, [self = shared_from_this()](const sys::error_code& ec, size_t bytes_readed) {
+                    if (bytes_readed == 0) {
+                        return;
+                    }
+                    ++self->stats_->reads;
+                    std::vector<char> bytes(self->buffer_->begin(), self->buffer_->begin() + bytes_readed);
+                    net::post(self->strand_, [self, bytes = std::move(bytes), ec]() mutable {
+                        self->OnRead(std::move(bytes));
+                        if (!ec) {
+                            self->Read();
+                        }
+                        });
+                    }));
+        }
+
+    private:
+        Strand strand_;
+        tcp::socket socket_;
+        ReadStats* stats_;
+        std::shared_ptr<std::vector<char>> buffer_ = std::make_shared<std::vector<char>>(128);
+        std::string incomplete_message_;
+        irc::message_processor::MessageProcessor processor_;
+
+        void OnRead(std::vector<char>&& bytes) {
+            std::string raw = incomplete_message_;
+            raw.append(bytes.begin(), bytes.end());
+            size_t consumed = 0;
+            auto messages = processor_.GetMessagesFromRawBytes(raw, consumed);
+            incomplete_message_ = raw.substr(consumed);
+            stats_->messages += messages.size();
+            stats_->bytes += consumed;
+        }
+    };
+
+    void ReportPerMegabyte(benchmark::State& state, const ReadStats& stats, size_t allocations) {
+        const double megabytes = stats.bytes / MEGABYTE;
+        state.counters["reads_per_MB"] = benchmark::Counter(stats.reads / megabytes);
+        state.counters["allocs_per_MB"] = benchmark::Counter(allocations / megabytes);
+        state.counters["messages"] = benchmark::Counter(static_cast<double>(stats.messages));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stats.bytes));
+    }
+
+    void BM_LoopbackRead_ReadBuffer(benchmark::State& state) {
+        const std::string traffic = benchmarks::ChatCorpus::MakeTraffic(TRAFFIC_SIZE);
+        ReadStats stats;
+        size_t allocations = 0;
+
+        for (auto _ : state) {
+            stats = {};
+            net::io_context ioc;
+            Strand read_strand = net::make_strand(ioc);
+            Strand write_strand = net::make_strand(ioc);
+            LoopbackServer server(traffic);
+
+            auto connection = std::make_shared<connection::Connection>(ioc, read_strand, write_strand);
+            connection->SetReadBufferSize(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+            irc::message_processor::MessageProcessor processor;
+            benchmarks::AllocationScope scope;
+            connection->AsyncConnect("127.0.0.1", server.GetPort(), [&](const sys::error_code& ec) {
+                if (!ec) {
+                    connection->AsyncRead(ReadBufferReader(connection, processor, stats));
+                }
+                });
+            ioc.run();
+            allocations = scope.Count();
+        }
+        ReportPerMegabyte(state, stats, allocations);
+    }
+
+    void BM_LoopbackRead_Legacy128(benchmark::State& state) {
+        const std::string traffic = benchmarks::ChatCorpus::MakeTraffic(TRAFFIC_SIZE);
+        ReadStats stats;
+        size_t allocations = 0;
+
+        for (auto _ : state) {
+            stats = {};
+            net::io_context ioc;
+            LoopbackServer server(traffic);
+
+            tcp::socket socket(ioc);
+            socket.connect(tcp::endpoint(net::ip::address_v4::loopback()
+                , static_cast<unsigned short>(std::stoi(server.GetPort()))));
+
+            benchmarks::AllocationScope scope;
+            std::make_shared<LegacyReader>(ioc, std::move(socket), stats)->Read();
+            ioc.run();
+            allocations = scope.Count();
+        }
+        ReportPerMegabyte(state, stats, allocations);
+    }
+
+} // namespace
+
+BENCHMARK(BM_LoopbackRead_Legacy128)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoopbackRead_ReadBuffer)
+    ->Args({ 128, 128 })
+    ->Args({ static_cast<int64_t>(connection::ReadBuffer::DEFAULT_INITIAL_SIZE)
+        , static_cast<int64_t>(connection::ReadBuffer::DEFAULT_MAX_SIZE) })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,140 @@
+#include "tls_identity.h"
+
+#include <openssl/bio.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <memory>
+#include <stdexcept>
+
+
+namespace mock_twitch {
+
+    using namespace std::literals;
+
+    namespace {
+
+        struct KeyDeleter {
+            void operator()(EVP_PKEY* key) const {
+                EVP_PKEY_free(key);
+            }
+        };
+
+        struct KeyContextDeleter {
+            void operator()(EVP_PKEY_CTX* ctx) const {
+                EVP_PKEY_CTX_free(ctx);
+            }
+        };
+
+        struct CertificateDeleter {
+            void operator()(X509* certificate) const {
+                X509_free(certificate);
+            }
+        };
+
+        struct BioDeleter {
+            void operator()(BIO* bio) const {
+                BIO_free(bio);
+            }
+        };
+
+        using KeyPtr = std::unique_ptr<EVP_PKEY, KeyDeleter>;
+        using CertificatePtr = std::unique_ptr<X509, CertificateDeleter>;
+
+        void Check(bool success, std::string_view what) {
+            if (!success) {
+                throw std::runtime_error("Making TLS identity failed on "s.append(what));
+            }
+        }
+
+        KeyPtr MakeKey() {
+            std::unique_ptr<EVP_PKEY_CTX, KeyContextDeleter> ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr));
+            Check(ctx != nullptr, "key context"sv);
+            Check(EVP_PKEY_keygen_init(ctx.get()) > 0, "keygen init"sv);
+            Check(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx.get(), NID_X9_62_prime256v1) > 0, "curve"sv);
+            EVP_PKEY* key = nullptr;
+            Check(EVP_PKEY_keygen(ctx.get(), &key) > 0, "keygen"sv);
+            return KeyPtr(key);
+        }
+
+        void AddExtension(X509* certificate, X509* issuer, int nid, const char* value) {
+            X509V3_CTX ctx;
+            X509V3_set_ctx_nodb(&ctx);
+            X509V3_set_ctx(&ctx, issuer, certificate, nullptr, nullptr, 0);
+            X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value);
+            Check(extension != nullptr, "extension"sv);
+            const bool added = X509_add_ext(certificate, extension, -1) == 1;
+            X509_EXTENSION_free(extension);
+            Check(added, "adding extension"sv);
+        }
+
+        // Issuer is the certificate itself when issuer is null
+        CertificatePtr MakeCertificate(EVP_PKEY* key, std::string_view common_name, long serial
+            , X509* issuer, EVP_PKEY* issuer_key) {
+            CertificatePtr certificate(X509_new());
+            Check(certificate != nullptr, "certificate"sv);
+            X509* cert = certificate.get();
+            X509_set_version(cert, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(cert), serial);
+            X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+            X509_gmtime_adj(X509_getm_notAfter(cert), 7 * 24 * 3600);
+            X509_set_pubkey(cert, key);
+
+            X509_NAME* name = X509_get_subject_name(cert);
+            X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC
+                , reinterpret_cast<const unsigned char*>("Mock Twitch"), -1, -1, 0);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC
+                , reinterpret_cast<const unsigned char*>(std::string(common_name).c_str()), -1, -1, 0);
+
+            const bool is_ca = issuer == nullptr;
+            X509* issuer_cert = is_ca ? cert : issuer;
+            X509_set_issuer_name(cert, X509_get_subject_name(issuer_cert));
+            if (is_ca) {
+                AddExtension(cert, issuer_cert, NID_basic_constraints, "critical,CA:TRUE");
+                AddExtension(cert, issuer_cert, NID_key_usage, "critical,keyCertSign,cRLSign");
+                AddExtension(cert, issuer_cert, NID_subject_key_identifier, "hash");
+            }
+            else {
+                AddExtension(cert, issuer_cert, NID_basic_constraints, "critical,CA:FALSE");
+                AddExtension(cert, issuer_cert, NID_key_usage, "critical,digitalSignature");
+                AddExtension(cert, issuer_cert, NID_ext_key_usage, "serverAuth");
+                AddExtension(cert, issuer_cert, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1");
+            }
+            Check(X509_sign(cert, is_ca ? key : issuer_key, EVP_sha256()) > 0, "signing"sv);
+            return certificate;
+        }
+
+        template <typename Writer>
+        std::string ToPem(Writer&& writer) {
+            std::unique_ptr<BIO, BioDeleter> bio(BIO_new(BIO_s_mem()));
+            Check(bio != nullptr && writer(bio.get()) == 1, "PEM encoding"sv);
+            char* data = nullptr;
+            long size = BIO_get_mem_data(bio.get(), &data);
+            return std::string(data, static_cast<size_t>(size));
+        }
+
+    } // namespace
+
+    TlsIdentity MakeTlsIdentity() {
+        auto ca_key = MakeKey();
+        auto ca = MakeCertificate(ca_key.get(), "Mock Twitch CA"sv, 1, nullptr, nullptr);
+        auto key = MakeKey();
+        auto certificate = MakeCertificate(key.get(), "localhost"sv, 2, ca.get(), ca_key.get());
+
+        TlsIdentity identity;
+        identity.ca_certificate = ToPem([&](BIO* bio) {
+            return PEM_write_bio_X509(bio, ca.get());
+            });
+        identity.certificate = ToPem([&](BIO* bio) {
+            return PEM_write_bio_X509(bio, certificate.get());
+            });
+        identity.private_key = ToPem([&](BIO* bio) {
+            return PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+            });
+        return identity;
+    }
+
+} // namespace mock_twitch
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+
+namespace mock_twitch {
+
+    // PEM encoded certificates and key of a stand-in TLS server
+    struct TlsIdentity {
+        std::string ca_certificate;
+        std::string certificate;
+        std::string private_key;
+    };
+
+    // Fresh self-signed CA and a server certificate issued by it for localhost and 127.0.0.1.
+    // Client trusts ca_certificate, e.g. through TlsClientContext::AddCertificateAuthority
+    TlsIdentity MakeTlsIdentity();
+
+} // namespace mock_twitch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace mock_twitch {
+
+    // "--name value" and bare "--flag" arguments of the load tools
+    class ToolOptions {
+    public:
+        ToolOptions(int argc, char* argv[]) {
+            for (int i = 1; i < argc; ++i) {
+                std::string_view arg = argv[i];
+                if (!arg.starts_with("--")) {
+                    continue;
+                }
+                arg.remove_prefix(2);
+                const bool has_value = i + 1 < argc && !std::string_view(argv[i + 1]).starts_with("--");
+                values_[std::string(arg)] = has_value ? argv[++i] : "";
+            }
+        }
+
+        bool Has(std::string_view name) const {
+            return values_.contains(std::string(name));
+        }
+
+        double GetNumber(std::string_view name, double default_value) const {
+            auto it = values_.find(std::string(name));
+            return it == values_.end() || it->second.empty() ? default_value : std::strtod(it->second.c_str(), nullptr);
+        }
+
+    private:
+        std::unordered_map<std::string, std::string> values_;
+    };
+
+} // namespace mock_twitch
@@ -0,0 +1,209 @@
+#include "async_command.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <optional>
+
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_type.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+
+namespace commands {
+
+    namespace sys = boost::system;
+
+    namespace {
+
+        void AddTime(std::chrono::nanoseconds& total, std::chrono::nanoseconds& max, std::chrono::nanoseconds time) {
+            total += time;
+            max = std::max(max, time);
+        }
+
+    } // namespace
+
+    AsyncCommandRunner::AsyncCommandRunner(std::unique_ptr<AsyncCommandExecutor>&& executor, AsyncLimits limits)
+        : executor_(std::move(executor))
+        , limits_(limits)
+    {
+    }
+
+    void AsyncCommandRunner::Submit(net::any_io_executor executor, AsyncCommandContext&& context) {
+        Call call{ net::make_strand(std::move(executor)), std::move(context), std::stop_source{}
+            , std::make_shared<net::cancellation_signal>(), Clock::now() };
+        {
+            std::lock_guard lock(mutex_);
+            ++stats_.submitted;
+            call.id = ++next_id_;
+            if (limits_.max_concurrent != 0 && running_.size() >= limits_.max_concurrent) {
+                if (queue_.size() < limits_.max_queued) {
+                    queue_.push_back(std::move(call));
+                    return;
+                }
+                ++stats_.rejected;
+                call.id = 0;
+            }
+            else {
+                running_.push_back(Running{ call.id, call.stop, call.strand, call.cancel });
+            }
+        }
+        if (call.id == 0) {
+            LOG_WARN("Async command queue is full, call rejected");
+            return;
+        }
+        Launch(std::move(call));
+    }
+
+    void AsyncCommandRunner::Cancel() {
+        std::deque<Call> dropped;
+        std::lock_guard lock(mutex_);
+        dropped.swap(queue_);
+        stats_.cancelled += dropped.size();
+        for (auto& running : running_) {
+            if (running.stopped_by == StopReason::NONE) {
+                Stop(running, StopReason::CANCEL);
+            }
+        }
+    }
+
+    AsyncStats AsyncCommandRunner::GetStats() const {
+        std::lock_guard lock(mutex_);
+        AsyncStats stats = stats_;
+        stats.running = running_.size();
+        stats.queued = queue_.size();
+        return stats;
+    }
+
+    const AsyncLimits& AsyncCommandRunner::GetLimits() const {
+        return limits_;
+    }
+
+    // Started on the call strand: slot of the signal is connected where the signal is emitted
+    void AsyncCommandRunner::Launch(Call&& call) {
+        auto strand = call.strand;
+        net::dispatch(strand, [self = shared_from_this(), call = std::move(call)]() mutable {
+            self->Start(std::move(call));
+            });
+    }
+
+    void AsyncCommandRunner::Start(Call&& call) {
+        const auto started_at = Clock::now();
+        {
+            std::lock_guard lock(mutex_);
+            AddTime(stats_.total_queue_wait, stats_.max_queue_wait, started_at - call.submitted_at);
+        }
+
+        auto timer = std::make_shared<net::steady_timer>(call.strand);
+        call.context.stop = call.stop.get_token();
+        if (limits_.deadline.count() > 0) {
+            call.context.deadline = started_at + limits_.deadline;
+            timer->expires_at(call.context.deadline);
+            timer->async_wait([self = shared_from_this(), id = call.id](const sys::error_code& ec) {
+                if (!ec) {
+                    self->OnDeadline(id);
+                }
+                });
+        }
+
+        // Completion runs on the call strand, timer and signal are touched only there.
+        // Handler holds the signal: it must outlive the operation its slot is bound to
+        net::co_spawn(call.strand, (*executor_)(std::move(call.context))
+            , net::bind_cancellation_slot(call.cancel->slot()
+                , [self = shared_from_this(), timer, cancel = call.cancel, id = call.id, started_at](std::exception_ptr error) {
+                    timer->cancel();
+                    self->OnFinished(id, started_at, error);
+                }));
+        // Cancelled while waiting for the strand: emit of Stop came before the slot was connected
+        if (call.stop.stop_requested() && IsRunning(call.id)) {
+            call.cancel->emit(net::cancellation_type::terminal);
+        }
+    }
+
+    void AsyncCommandRunner::OnDeadline(uint64_t id) {
+        {
+            std::lock_guard lock(mutex_);
+            auto it = std::find_if(running_.begin(), running_.end(), [id](const Running& running) {
+                return running.id == id;
+                });
+            if (it == running_.end() || it->stopped_by != StopReason::NONE) {
+                return;
+            }
+            Stop(*it, StopReason::DEADLINE);
+        }
+        LOG_WARN("Async command missed its deadline, stop requested");
+    }
+
+    // Token covers work between awaits, the signal aborts the awaited operation even if executor
+    // never looks at the token. Signal isn't thread safe: it is emitted on the call strand, and only
+    // while the call runs, completion handler is on that strand too
+    void AsyncCommandRunner::Stop(Running& running, StopReason reason) {
+        running.stopped_by = reason;
+        running.stop.request_stop();
+        net::post(running.strand, [self = shared_from_this(), id = running.id, cancel = running.cancel]() {
+            if (self->IsRunning(id)) {
+                cancel->emit(net::cancellation_type::terminal);
+            }
+            });
+    }
+
+    bool AsyncCommandRunner::IsRunning(uint64_t id) const {
+        std::lock_guard lock(mutex_);
+        return std::any_of(running_.begin(), running_.end(), [id](const Running& running) {
+            return running.id == id;
+            });
+    }
+
+    void AsyncCommandRunner::OnFinished(uint64_t id, Clock::time_point started_at, std::exception_ptr error) {
+        const auto run_time = Clock::now() - started_at;
+        std::optional<Call> next;
+        StopReason stopped_by = StopReason::NONE;
+        {
+            std::lock_guard lock(mutex_);
+            auto it = std::find_if(running_.begin(), running_.end(), [id](const Running& running) {
+                return running.id == id;
+                });
+            if (it != running_.end()) {
+                stopped_by = it->stopped_by;
+                running_.erase(it);
+            }
+            AddTime(stats_.total_run_time, stats_.max_run_time, run_time);
+            switch (stopped_by) {
+            case StopReason::DEADLINE:
+                ++stats_.timed_out;
+                break;
+            case StopReason::CANCEL:
+                ++stats_.cancelled;
+                break;
+            case StopReason::NONE:
+                ++(error ? stats_.failed : stats_.completed);
+                break;
+            }
+            if (!queue_.empty() && (limits_.max_concurrent == 0 || running_.size() < limits_.max_concurrent)) {
+                next.emplace(std::move(queue_.front()));
+                queue_.pop_front();
+                running_.push_back(Running{ next->id, next->stop, next->strand, next->cancel });
+            }
+        }
+
+        // Stopped call throws operation_aborted from the awaited operation, that is no failure
+        if (error && stopped_by == StopReason::NONE) {
+            try {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e) {
+                LOG_ERROR("Async command failed: "s.append(e.what()));
+            }
+            catch (...) {
+                LOG_ERROR("Async command failed");
+            }
+        }
+        if (next) {
+            Launch(std::move(*next));
+        }
+    }
+
+}
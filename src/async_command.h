@@ -0,0 +1,139 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include <utility>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+
+#include "message.h"
+#include "shared_message.h"
+
+
+namespace commands {
+
+    namespace net = boost::asio;
+    using namespace std::literals;
+
+    // Like CommandContext, but outlives suspensions: holds the message, views point into it
+    struct AsyncCommandContext {
+        irc::domain::SharedMessage message;
+        std::string_view arguments;
+        std::string_view channel;
+        std::string_view login;
+        irc::domain::NameId user = irc::domain::NO_NAME;
+        irc::domain::NameId channel_id = irc::domain::NO_NAME;
+        irc::domain::Role role = irc::domain::Role::EMPTY;
+        // Requested on deadline and on Command::CancelAsync, together with terminal cancellation of the
+        // awaited operation: co_await throws operation_aborted. Executor checks the token between steps
+        // that await nothing
+        std::stop_token stop;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    };
+
+    // Coroutine executor, runs on WorkerPool. Every call gets its own strand: timers and sockets made
+    // from co_await net::this_coro::executor need no locking inside one call
+    class AsyncCommandExecutor {
+    public:
+        virtual ~AsyncCommandExecutor() = default;
+
+        virtual net::awaitable<void> operator()(AsyncCommandContext context) = 0;
+    };
+
+    struct AsyncLimits {
+        // Calls of the command running at once, 0 - unlimited
+        size_t max_concurrent = 1;
+        // Calls waiting for a free slot, the next ones are rejected
+        size_t max_queued = 64;
+        // From start of the call, 0 - none
+        std::chrono::milliseconds deadline = 10s;
+    };
+
+    // Every submitted call ends up in one of completed, failed, timed_out, cancelled or rejected.
+    // Stopped call is counted by what stopped it, whatever the coroutine did after that
+    struct AsyncStats {
+        size_t submitted = 0;
+        size_t completed = 0;
+        // Executor threw
+        size_t failed = 0;
+        size_t timed_out = 0;
+        size_t cancelled = 0;
+        size_t rejected = 0;
+        size_t running = 0;
+        size_t queued = 0;
+        // From submit to start
+        std::chrono::nanoseconds total_queue_wait{ 0 };
+        std::chrono::nanoseconds max_queue_wait{ 0 };
+        // From start to completion of coroutine
+        std::chrono::nanoseconds total_run_time{ 0 };
+        std::chrono::nanoseconds max_run_time{ 0 };
+    };
+
+    // Queue, concurrency limit and deadlines of one async command
+    class AsyncCommandRunner : public std::enable_shared_from_this<AsyncCommandRunner> {
+    public:
+        AsyncCommandRunner(std::unique_ptr<AsyncCommandExecutor>&& executor, AsyncLimits limits);
+
+        void Submit(net::any_io_executor executor, AsyncCommandContext&& context);
+        // Stops running calls and drops queued ones
+        void Cancel();
+        AsyncStats GetStats() const;
+        const AsyncLimits& GetLimits() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Call {
+            // Coroutine, deadline timer and cancellation of the call run there
+            net::any_io_executor strand;
+            AsyncCommandContext context;
+            std::stop_source stop;
+            std::shared_ptr<net::cancellation_signal> cancel;
+            Clock::time_point submitted_at;
+            uint64_t id = 0;
+        };
+
+        enum class StopReason {
+            NONE,
+            DEADLINE,
+            CANCEL
+        };
+
+        struct Running {
+            uint64_t id = 0;
+            std::stop_source stop;
+            net::any_io_executor strand;
+            std::shared_ptr<net::cancellation_signal> cancel;
+            // First stop request wins, decides the stats bucket
+            StopReason stopped_by = StopReason::NONE;
+        };
+
+        std::unique_ptr<AsyncCommandExecutor> executor_;
+        AsyncLimits limits_;
+
+        mutable std::mutex mutex_;
+        std::deque<Call> queue_;
+        // Running calls, for Cancel and deadline
+        std::deque<Running> running_;
+        uint64_t next_id_ = 0;
+        AsyncStats stats_;
+
+        void Launch(Call&& call);
+        void Start(Call&& call);
+        void OnDeadline(uint64_t id);
+        // mutex_ must be held
+        void Stop(Running& running, StopReason reason);
+        bool IsRunning(uint64_t id) const;
+        void OnFinished(uint64_t id, Clock::time_point started_at, std::exception_ptr error);
+    };
+
+}
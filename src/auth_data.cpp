@@ -15,6 +15,10 @@ namespace irc {
             return data;
         }
 
+        std::string_view AuthorizeData::GetNick() const {
+            return nick_;
+        }
+
         void AuthorizeData::SetNick(std::string_view nick) {
             nick_ = std::string(nick);
         }
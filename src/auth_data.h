@@ -16,6 +16,7 @@ namespace irc {
             }
 
             std::string GetAuthMessage() const;
+            std::string_view GetNick() const;
             void SetNick(std::string_view nick);
             void SetToken(std::string_view token);
 
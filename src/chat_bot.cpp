@@ -1,6 +1,8 @@
 #include "chat_bot.h"
 #include "logging.h"
 
+#include <algorithm>
+#include <unordered_map>
 #include <utility>
 
 namespace chat_bot {
@@ -14,46 +16,228 @@ namespace chat_bot {
     }
 
     void ChatBot::AddCommand(std::string_view command_name, commands::Command&& command) {
-        name_to_command_[std::string(command_name)] = std::move(command);
+        EnsureWorkerPool(command);
+        std::lock_guard lock(commands_mutex_);
+        name_to_command_.Add(command_name, std::move(command));
+        commands_changed_.store(true, std::memory_order_release);
+    }
+
+    bool ChatBot::AddCommandAlias(std::string_view alias, std::string_view command_name) {
+        std::lock_guard lock(commands_mutex_);
+        if (!name_to_command_.AddAlias(alias, command_name)) {
+            return false;
+        }
+        commands_changed_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool ChatBot::RemoveCommand(std::string_view command_name) {
+        std::lock_guard lock(commands_mutex_);
+        if (!name_to_command_.Remove(command_name)) {
+            return false;
+        }
+        commands_changed_.store(true, std::memory_order_release);
+        return true;
     }
 
     void ChatBot::AddMode(std::string_view mode_name, Mode&& mode) {
-        name_to_mode_[std::string(mode_name)] = std::move(mode);
+        EnsureWorkerPool(mode);
+        std::lock_guard lock(modes_mutex_);
+        name_to_mode_.Add(mode_name, std::move(mode));
+        modes_changed_.store(true, std::memory_order_release);
     }
 
-    commands::Command* ChatBot::GetCommand(std::string_view command_name) {
-        if (auto it = name_to_command_.find(std::string(command_name));
-            it != name_to_command_.end()) {
-            return &it->second;
+    bool ChatBot::AddModeTrigger(std::string_view mode_name, std::string_view keyword) {
+        if (keyword.empty()) {
+            return false;
+        }
+        std::lock_guard lock(modes_mutex_);
+        if (!name_to_mode_.Find(mode_name)) {
+            return false;
         }
+        mode_triggers_.emplace_back(std::string(mode_name), std::string(keyword));
+        modes_changed_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    commands::Command* ChatBot::GetCommand(std::string_view command_name) {
+        std::lock_guard lock(commands_mutex_);
+        return name_to_command_.Find(command_name);
     }
 
     Mode* ChatBot::GetMode(std::string_view mode_name) {
-        if (auto it = name_to_command_.find(std::string(mode_name));
-            it != name_to_command_.end()) {
-            return &it->second;
+        std::lock_guard lock(modes_mutex_);
+        return name_to_mode_.Find(mode_name);
+    }
+
+    void ChatBot::SetWorkerPool(std::shared_ptr<commands::WorkerPool> worker_pool) {
+        std::lock_guard lock(published_mutex_);
+        worker_pool_ = std::move(worker_pool);
+    }
+
+    std::shared_ptr<commands::WorkerPool> ChatBot::GetWorkerPool() const {
+        std::lock_guard lock(published_mutex_);
+        return worker_pool_;
+    }
+
+    void ChatBot::EnsureWorkerPool(const commands::Command& command) {
+        if (!command.IsAsync()) {
+            return;
+        }
+        std::lock_guard lock(published_mutex_);
+        if (!worker_pool_) {
+            worker_pool_ = std::make_shared<commands::WorkerPool>();
         }
     }
 
     // case 1 - user:!command 
     // case 2 - user:!command some text for command execution
+    void ChatBot::ParseAndExecute(irc::domain::SharedMessage message) {
+        if (!message || message->GetContent().empty()) {
+            return;
+        }
+
+        net::post(ioc_, [self = shared_from_this(), message]() {
+            self->UseModes(message); });
+        net::post(ioc_, [self = shared_from_this(), message = std::move(message)]() {
+            self->ProcessCommand(message); });
+    }
+
     void ChatBot::ParseAndExecute(irc::domain::Message&& message) {
-        auto line = message.GetContent();
-        if (line.empty()) {
+        ParseAndExecute(irc::domain::SharedMessage::Make(std::move(message)));
+    }
+
+    namespace {
+
+        commands::CommandContext MakeContext(const irc::domain::Message& msg, std::string_view arguments) {
+            return commands::CommandContext{
+                .message = msg,
+                .arguments = arguments,
+                .channel = msg.GetChannel(),
+                .login = msg.GetLogin(),
+                .user = msg.GetLoginId(),
+                .channel_id = msg.GetChannelId(),
+                .role = msg.GetRole(),
+            };
+        }
+
+        // Views point into the message slab, the context holds the message
+        commands::AsyncCommandContext MakeAsyncContext(const irc::domain::SharedMessage& msg, std::string_view arguments) {
+            return commands::AsyncCommandContext{
+                .message = msg,
+                .arguments = arguments,
+                .channel = msg->GetChannel(),
+                .login = msg->GetLogin(),
+                .user = msg->GetLoginId(),
+                .channel_id = msg->GetChannelId(),
+                .role = msg->GetRole(),
+                // Both are set by the runner when the call starts
+                .stop = {},
+                .deadline = std::chrono::steady_clock::time_point::max(),
+            };
+        }
+
+    } // namespace
+
+    // Readers keep the set they loaded until their message is done, the old one goes with the last of them
+    void ChatBot::RebuildModes() {
+        std::lock_guard lock(modes_mutex_);
+        if (!modes_changed_.load(std::memory_order_relaxed)) {
             return;
         }
+        auto mode_set = std::make_shared<ModeSet>();
+        std::unordered_map<const Mode*, uint32_t> mode_to_index;
+        name_to_mode_.ForEach([&](std::string_view, const std::shared_ptr<Mode>& mode) {
+            mode_to_index.emplace(mode.get(), static_cast<uint32_t>(mode_set->modes.size()));
+            mode_set->modes.push_back(mode);
+            });
+
+        std::vector<bool> triggered(mode_set->modes.size(), false);
+        for (const auto& [mode_name, keyword] : mode_triggers_) {
+            const uint32_t index = mode_to_index.at(name_to_mode_.Find(mode_name));
+            mode_set->triggers.Add(keyword, index);
+            triggered[index] = true;
+        }
+        mode_set->triggers.Build();
+
+        for (uint32_t index = 0; index < mode_set->modes.size(); ++index) {
+            if (!triggered[index]) {
+                mode_set->untriggered.push_back(index);
+            }
+        }
+        {
+            std::lock_guard published_lock(published_mutex_);
+            mode_set_ = std::move(mode_set);
+        }
+        modes_changed_.store(false, std::memory_order_release);
+    }
+
+    std::shared_ptr<const ChatBot::ModeSet> ChatBot::LoadModeSet() const {
+        std::lock_guard lock(published_mutex_);
+        return mode_set_;
+    }
+
+    // Copy shares commands, so a replaced or removed one lives while an older copy holds it
+    void ChatBot::RebuildCommands() {
+        std::lock_guard lock(commands_mutex_);
+        if (!commands_changed_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        auto command_set = std::make_shared<const commands::CommandRegistry>(name_to_command_);
+        {
+            std::lock_guard published_lock(published_mutex_);
+            command_set_ = std::move(command_set);
+        }
+        commands_changed_.store(false, std::memory_order_release);
+    }
+
+    std::shared_ptr<const commands::CommandRegistry> ChatBot::LoadCommandSet() const {
+        std::lock_guard lock(published_mutex_);
+        return command_set_;
+    }
 
-        net::post(ioc_, [self = shared_from_this(), message]() mutable {
-            self->UseModes(std::move(message)); });
-        net::post(ioc_, [self = shared_from_this(), message = std::move(message)]() mutable {
-            self->ProcessCommand(std::move(message)); });
+    void ChatBot::RunMode(const Mode& mode, const irc::domain::SharedMessage& msg, const commands::CommandContext& context) const {
+        if (mode.IsAsync()) {
+            mode.ExecuteAsync(*GetWorkerPool(), MakeAsyncContext(msg, context.arguments));
+        }
+        else {
+            mode.Execute(context);
+        }
     }
 
-    void ChatBot::UseModes(irc::domain::Message&& msg) {
+    void ChatBot::UseModes(const irc::domain::SharedMessage& msg) {
         try {
-            for (auto& [_, mode] : name_to_mode_) {
-                mode.AddContent(msg.GetContent());
-                mode.Execute(msg.GetNick(), msg.GetRole());
+            if (modes_changed_.load(std::memory_order_acquire)) {
+                RebuildModes();
+            }
+            const std::shared_ptr<const ModeSet> mode_set = LoadModeSet();
+            if (!mode_set) {
+                return;
+            }
+            const auto context = MakeContext(*msg, msg->GetContent());
+
+            // Modes matched by keywords, once each. Kept per thread, so no allocations after warm up
+            thread_local std::vector<uint32_t> matched;
+            matched.clear();
+            mode_set->triggers.Scan(context.arguments, [](uint32_t index) {
+                matched.push_back(index);
+                });
+            std::sort(matched.begin(), matched.end());
+            matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+
+            // Both lists are sorted, modes run in order of adding
+            const auto& modes = mode_set->modes;
+            const auto& untriggered_modes = mode_set->untriggered;
+            auto untriggered = untriggered_modes.begin();
+            auto triggered = matched.begin();
+            while (untriggered != untriggered_modes.end() || triggered != matched.end()) {
+                if (triggered == matched.end()
+                    || (untriggered != untriggered_modes.end() && *untriggered < *triggered)) {
+                    RunMode(*modes[*untriggered++], msg, context);
+                }
+                else {
+                    RunMode(*modes[*triggered++], msg, context);
+                }
             }
         }
         catch (const std::exception& e) {
@@ -61,26 +245,24 @@ namespace chat_bot {
         }
     }
 
-    void ChatBot::ProcessCommand(irc::domain::Message&& msg) {
+    void ChatBot::ProcessCommand(const irc::domain::SharedMessage& msg) {
         try {
-            auto line = msg.GetContent();
+            auto line = msg->GetContent();
             if (line[0] == command_start_) {
-                std::string command;
-                std::string content;
-                size_t command_end = line.find_first_of(' ');
-                if (command_end == std::string::npos) {
-                    command = std::string(line.substr(1));
+                if (commands_changed_.load(std::memory_order_acquire)) {
+                    RebuildCommands();
                 }
-                else {
-                    command = std::string(line.substr(1, command_end - 1));
-                    content = std::string(line.substr(command_end + 1));
+                // Held until the command is called: commands replaced meanwhile stay alive
+                const auto command_set = LoadCommandSet();
+                const auto match = command_set ? command_set->Match(line.substr(1)) : commands::CommandMatch{};
+                if (!match.command) {
+                    LOG_ERROR("Unknown command");
                 }
-                if (auto it = name_to_command_.find(command); it != name_to_command_.end()) {
-                    it->second.AddContent(std::move(content));
-                    it->second.Execute(msg.GetNick(), msg.GetRole());
+                else if (match.command->IsAsync()) {
+                    match.command->ExecuteAsync(*GetWorkerPool(), MakeAsyncContext(msg, match.arguments));
                 }
                 else {
-                    LOG_ERROR("Unknown command");
+                    match.command->Execute(MakeContext(*msg, match.arguments));
                 }
             }
         }
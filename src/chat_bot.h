@@ -1,10 +1,18 @@
 #pragma once 
 
 #include "command.h"
+#include "command_registry.h"
+#include "keyword_matcher.h"
+#include "shared_message.h"
+#include "worker_pool.h"
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <memory>
 
@@ -31,23 +39,71 @@ namespace chat_bot {
 
         }
 
+        // Modes and command handler share the message, nothing is copied
+        void ParseAndExecute(irc::domain::SharedMessage message);
         void ParseAndExecute(irc::domain::Message&& message);
 
         void SetCommandStart(char ch);
         char GetCommandStart() const;
+        // Names are case-insensitive and may have spaces: "song skip" is found before "song".
+        // Commands may change while messages are handled, those finish with the commands they found
         void AddCommand(std::string_view command_name, commands::Command&& command);
+        // False if command is missing or alias is taken
+        bool AddCommandAlias(std::string_view alias, std::string_view command_name);
+        bool RemoveCommand(std::string_view command_name);
+        // Mode without triggers runs on every message. Mode of the same name is replaced, messages
+        // being dispatched finish with the old one
         void AddMode(std::string_view mode_name, Mode&& mode);
+        // Mode runs only on messages containing one of its keywords, case-insensitive. All keywords
+        // are scanned in one pass, rebuilt on the first message after change. False if mode is missing
+        bool AddModeTrigger(std::string_view mode_name, std::string_view keyword);
 
+        // nullptr if there is no such command or mode
         commands::Command* GetCommand(std::string_view command_name);
         Mode* GetMode(std::string_view mode_name);
+
+        // Pool for async commands and modes. Created with default size on first async one if not set
+        void SetWorkerPool(std::shared_ptr<commands::WorkerPool> worker_pool);
+        std::shared_ptr<commands::WorkerPool> GetWorkerPool() const;
     private:
         net::io_context& ioc_;
         char command_start_ = '!';
-        std::unordered_map<std::string, commands::Command> name_to_command_;
-        std::unordered_map<std::string, Mode> name_to_mode_;
+        // Guarded by commands_mutex_, message threads match in a published copy of it
+        commands::CommandRegistry name_to_command_;
+        std::atomic<bool> commands_changed_{ false };
+        std::mutex commands_mutex_;
+        commands::CommandRegistry name_to_mode_;
+
+        // What message threads read, never changed after publishing: a change builds a new one
+        struct ModeSet {
+            // Modes in order of adding, trigger values index it. Replaced mode lives while a set holds it
+            std::vector<std::shared_ptr<const Mode>> modes;
+            // Indexes in modes of modes without triggers
+            std::vector<uint32_t> untriggered;
+            commands::KeywordMatcher triggers;
+        };
+
+        // Guarded by modes_mutex_ together with name_to_mode_ changes
+        std::vector<std::pair<std::string, std::string>> mode_triggers_;
+        std::atomic<bool> modes_changed_{ false };
+        std::mutex modes_mutex_;
+
+        // Held only to copy a pointer: message threads take what was published last and keep it.
+        // atomic<shared_ptr> of libstdc++ 12 doesn't order its load before the next store
+        mutable std::mutex published_mutex_;
+        std::shared_ptr<const ModeSet> mode_set_;
+        // Copy of name_to_command_, shares commands with it
+        std::shared_ptr<const commands::CommandRegistry> command_set_;
+        std::shared_ptr<commands::WorkerPool> worker_pool_;
 
-        void UseModes(irc::domain::Message&& msg);
-        void ProcessCommand(irc::domain::Message&& msg);
+        void UseModes(const irc::domain::SharedMessage& msg);
+        void ProcessCommand(const irc::domain::SharedMessage& msg);
+        void EnsureWorkerPool(const commands::Command& command);
+        void RebuildModes();
+        std::shared_ptr<const ModeSet> LoadModeSet() const;
+        void RebuildCommands();
+        std::shared_ptr<const commands::CommandRegistry> LoadCommandSet() const;
+        void RunMode(const Mode& mode, const irc::domain::SharedMessage& msg, const commands::CommandContext& context) const;
     };
 
 }
\ No newline at end of file
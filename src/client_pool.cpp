@@ -0,0 +1,191 @@
+#include "client_pool.h"
+
+#include "logging.h"
+
+#include <functional>
+#include <stdexcept>
+
+
+namespace irc {
+
+    ClientPool::ClientPool(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, size_t connections_count
+        , PlacementPolicy policy, bool secured)
+        : policy_(policy)
+        , rate_limiter_(std::make_shared<outbound::RateLimiter>())
+    {
+        if (connections_count == 0) {
+            throw std::invalid_argument("Client pool requires at least one connection");
+        }
+        shards_.reserve(connections_count);
+        for (size_t i = 0; i < connections_count; ++i) {
+            shards_.push_back(Shard{ std::make_shared<Client>(ioc, chat_bot, secured) });
+            shards_.back().client->SetRateLimiter(rate_limiter_);
+        }
+    }
+
+    void ClientPool::Connect() {
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            shards_[i].client->SetConnectionStateHandler(
+                [weak_self = this->weak_from_this(), i](bool is_connected) {
+                    if (auto self = weak_self.lock()) {
+                        self->OnConnectionState(i, is_connected);
+                    }
+                });
+            shards_[i].client->Connect();
+        }
+    }
+
+    void ClientPool::Disconnect() {
+        for (auto& shard : shards_) {
+            shard.client->Disconnect();
+        }
+    }
+
+    void ClientPool::Authorize(const domain::AuthorizeData& auth_data) {
+        for (auto& shard : shards_) {
+            shard.client->Authorize(auth_data);
+        }
+    }
+
+    void ClientPool::CapRequest() {
+        for (auto& shard : shards_) {
+            shard.client->CapRequest();
+        }
+    }
+
+    void ClientPool::Read() {
+        for (auto& shard : shards_) {
+            shard.client->Read();
+        }
+    }
+
+    void ClientPool::Join(std::string_view channel_name) {
+        std::lock_guard lock(mutex_);
+        if (channel_to_shard_.count(std::string(channel_name))) {
+            return;
+        }
+        const size_t index = PlaceChannel(channel_name);
+        channel_to_shard_[std::string(channel_name)] = index;
+        ++shards_[index].channels;
+        shards_[index].client->Join(channel_name);
+    }
+
+    void ClientPool::Join(const std::vector<std::string_view>& channels_names) {
+        for (const auto channel_name : channels_names) {
+            Join(channel_name);
+        }
+    }
+
+    void ClientPool::Part(std::string_view channel_name) {
+        std::lock_guard lock(mutex_);
+        auto it = channel_to_shard_.find(std::string(channel_name));
+        if (it == channel_to_shard_.end()) {
+            return;
+        }
+        auto& shard = shards_[it->second];
+        --shard.channels;
+        shard.client->Part(channel_name);
+        channel_to_shard_.erase(it);
+    }
+
+    void ClientPool::SetRateLimits(const outbound::RateLimits& limits) {
+        rate_limiter_->SetLimits(limits);
+    }
+
+    std::optional<size_t> ClientPool::GetShard(std::string_view channel_name) const {
+        std::lock_guard lock(mutex_);
+        if (auto it = channel_to_shard_.find(std::string(channel_name)); it != channel_to_shard_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::vector<ShardLoad> ClientPool::GetLoad() const {
+        std::lock_guard lock(mutex_);
+        std::vector<ShardLoad> load;
+        load.reserve(shards_.size());
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            load.push_back(ShardLoad{ i, shards_[i].channels, shards_[i].disconnects, shards_[i].healthy });
+        }
+        return load;
+    }
+
+    size_t ClientPool::Size() const {
+        return shards_.size();
+    }
+
+    // mutex_ must be held
+    size_t ClientPool::PlaceChannel(std::string_view channel_name) const {
+        if (policy_ == PlacementPolicy::HASH) {
+            // Home shard, or next healthy one while it is down
+            const size_t home = std::hash<std::string_view>{}(channel_name) % shards_.size();
+            for (size_t i = 0; i < shards_.size(); ++i) {
+                const size_t index = (home + i) % shards_.size();
+                if (shards_[index].healthy) {
+                    return index;
+                }
+            }
+            return home;
+        }
+
+        std::optional<size_t> best;
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            if (!shards_[i].healthy) {
+                continue;
+            }
+            if (!best || shards_[i].channels < shards_[*best].channels) {
+                best = i;
+            }
+        }
+        return best.value_or(0);
+    }
+
+    void ClientPool::OnConnectionState(size_t index, bool is_connected) {
+        std::lock_guard lock(mutex_);
+        auto& shard = shards_[index];
+        if (is_connected) {
+            if (!shard.healthy) {
+                LOG_INFO("Shard "s.append(std::to_string(index)).append(" recovered"));
+            }
+            shard.healthy = true;
+            return;
+        }
+        if (!shard.healthy) {
+            return;
+        }
+        shard.healthy = false;
+        ++shard.disconnects;
+        Rebalance(index);
+    }
+
+    // mutex_ must be held
+    void ClientPool::Rebalance(size_t dropped_index) {
+        auto& dropped = shards_[dropped_index];
+        bool has_healthy = false;
+        for (const auto& shard : shards_) {
+            has_healthy |= shard.healthy;
+        }
+        if (!has_healthy) {
+            LOG_WARN("All shards are down, channels stay in place until reconnect");
+            return;
+        }
+
+        size_t moved = 0;
+        for (auto& [channel, index] : channel_to_shard_) {
+            if (index != dropped_index) {
+                continue;
+            }
+            // Part only forgets the channel: dropped connection won't rejoin it after reconnect
+            dropped.client->Part(channel);
+            --dropped.channels;
+
+            index = PlaceChannel(channel);
+            ++shards_[index].channels;
+            shards_[index].client->Join(channel);
+            ++moved;
+        }
+        LOG_INFO("Shard "s.append(std::to_string(dropped_index)).append(" dropped, moved ")
+            .append(std::to_string(moved)).append(" channels"));
+    }
+
+} // namespace irc
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "auth_data.h"
+#include "chat_bot.h"
+#include "irc_client.h"
+
+
+namespace irc {
+
+    enum class PlacementPolicy {
+        HASH,
+        LEAST_LOADED
+    };
+
+    struct ShardLoad {
+        size_t index = 0;
+        size_t channels = 0;
+        size_t disconnects = 0;
+        bool connected = false;
+    };
+
+    // Spreads channels over several connections. Every shard is a Client with own socket and strands,
+    // all of them feed the same ChatBot so handlers see a single stream. When a shard drops its channels
+    // move to healthy shards, recovered shard gets new channels by placement policy.
+    class ClientPool : public std::enable_shared_from_this<ClientPool> {
+    public:
+        ClientPool() = delete;
+        ClientPool(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, size_t connections_count
+            , PlacementPolicy policy = PlacementPolicy::LEAST_LOADED, bool secured = true);
+
+        void Connect();
+        void Disconnect();
+        void Authorize(const domain::AuthorizeData& auth_data);
+        void CapRequest();
+        void Read();
+        void Join(std::string_view channel_name);
+        void Join(const std::vector<std::string_view>& channels_names);
+        void Part(std::string_view channel_name);
+        // All shards log in with one account and share its rate limits
+        void SetRateLimits(const outbound::RateLimits& limits);
+
+        std::optional<size_t> GetShard(std::string_view channel_name) const;
+        std::vector<ShardLoad> GetLoad() const;
+        size_t Size() const;
+
+    private:
+        struct Shard {
+            std::shared_ptr<Client> client;
+            size_t channels = 0;
+            size_t disconnects = 0;
+            bool healthy = true;
+        };
+
+        PlacementPolicy policy_;
+        std::shared_ptr<outbound::RateLimiter> rate_limiter_;
+        std::vector<Shard> shards_;
+        std::unordered_map<std::string, size_t> channel_to_shard_;
+        mutable std::mutex mutex_;
+
+        size_t PlaceChannel(std::string_view channel_name) const;
+        void OnConnectionState(size_t index, bool is_connected);
+        void Rebalance(size_t dropped_index);
+    };
+
+} // namespace irc
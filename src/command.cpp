@@ -8,18 +8,50 @@
 
 namespace commands {
 
-    void Command::Execute(std::string_view user_name, irc::domain::Role user_role) {
-        if (verificator_.Verify(user_name, user_role)) {
-            (*executor_)(content_);
+    void Command::Execute(const CommandContext& context) const {
+        if (executor_ && verificator_.Verify(context.user, context.role)
+            && TryAcquireCooldown(context.channel_id, context.user)) {
+            (*executor_)(context);
         }
     }
 
-    void Command::AddContent(std::string&& content) {
-        content_ = std::move(content);
+    void Command::ExecuteAsync(WorkerPool& pool, AsyncCommandContext&& context) const {
+        if (async_runner_ && verificator_.Verify(context.user, context.role)
+            && TryAcquireCooldown(context.channel_id, context.user)) {
+            async_runner_->Submit(pool.GetExecutor(), std::move(context));
+        }
+    }
+
+    bool Command::IsAsync() const {
+        return async_runner_ != nullptr;
+    }
+
+    void Command::CancelAsync() {
+        if (async_runner_) {
+            async_runner_->Cancel();
+        }
+    }
+
+    std::optional<AsyncStats> Command::GetAsyncStats() const {
+        if (!async_runner_) {
+            return std::nullopt;
+        }
+        return async_runner_->GetStats();
+    }
+
+    void Command::SetCooldown(const CooldownLimits& limits) {
+        cooldown_ = std::make_shared<CooldownTracker>(limits);
+    }
+
+    std::optional<CooldownStats> Command::GetCooldownStats() const {
+        if (!cooldown_) {
+            return std::nullopt;
+        }
+        return cooldown_->GetStats();
     }
 
-    void Command::AddContent(std::string_view content) {
-        content_ = std::string(content);
+    bool Command::TryAcquireCooldown(irc::domain::NameId channel, irc::domain::NameId user) const {
+        return !cooldown_ || cooldown_->TryAcquire(channel, user);
     }
 
     void Command::SetMinimumUserRole(irc::domain::Role role) {
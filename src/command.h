@@ -3,10 +3,14 @@
 #include <string>
 #include <utility>
 #include <memory>
+#include <optional>
 
+#include "async_command.h"
 #include "message.h"
 #include "command_executor.h"
+#include "cooldown.h"
 #include "user_validator.h"
+#include "worker_pool.h"
 
 namespace commands {
 
@@ -20,10 +24,28 @@ namespace commands {
 
         }
 
-        void Execute(std::string_view user_name, irc::domain::Role user_role);
+        // Runs on WorkerPool, never on network threads
+        Command(std::unique_ptr<AsyncCommandExecutor>&& executor, AsyncLimits limits = {})
+            : async_runner_(std::make_shared<AsyncCommandRunner>(std::move(executor), limits))
+        {
+
+        }
 
-        void AddContent(std::string&& content);
-        void AddContent(std::string_view content);
+        // Checks sender and runs executor. Reads only, safe from several threads while lists aren't changed
+        void Execute(const CommandContext& context) const;
+        // Checks sender and queues the call on pool, returns at once
+        void ExecuteAsync(WorkerPool& pool, AsyncCommandContext&& context) const;
+        bool IsAsync() const;
+        // Stops running calls and drops queued ones. No-op for sync command
+        void CancelAsync();
+        // Queue wait and run time of calls, empty for sync command
+        std::optional<AsyncStats> GetAsyncStats() const;
+
+        // Checked after user verification, a call over the limit is dropped. Replaces previous limits
+        // and their state
+        void SetCooldown(const CooldownLimits& limits);
+        // Empty if command has no cooldown
+        std::optional<CooldownStats> GetCooldownStats() const;
 
         void SetMinimumUserRole(irc::domain::Role role);
 
@@ -40,10 +62,13 @@ namespace commands {
 
     private:
         std::unique_ptr<BaseCommandExecutor> executor_{nullptr};
+        std::shared_ptr<AsyncCommandRunner> async_runner_{nullptr};
+        std::shared_ptr<CooldownTracker> cooldown_{nullptr};
         user_validator::UserVerificator verificator_;
 
         irc::domain::Role minimum_user_role_{3};
-        std::string content_;
+
+        bool TryAcquireCooldown(irc::domain::NameId channel, irc::domain::NameId user) const;
     };
 
 }
\ No newline at end of file
@@ -1,22 +1,54 @@
 #pragma once
 
+#include "message.h"
 #include "user_validator.h"
 
+#include <iostream>
 #include <string_view>
 
 
 namespace commands {
 
+    // Everything one invocation needs, built on stack for every message. Executors get it as const
+    // and keep nothing from it, so nothing is shared between calls and one command runs on every
+    // worker thread at once. Views live until executor returns
+    struct CommandContext {
+        const irc::domain::Message& message;
+        // Text after command name, whole message for modes
+        std::string_view arguments;
+        // Without '#'
+        std::string_view channel;
+        std::string_view login;
+        irc::domain::NameId user = irc::domain::NO_NAME;
+        irc::domain::NameId channel_id = irc::domain::NO_NAME;
+        irc::domain::Role role = irc::domain::Role::EMPTY;
+    };
+
+    // May be called concurrently from several threads: state in members must be synchronized
     class BaseCommandExecutor {
     public:
-        virtual void operator()([[maybe_unused]] std::string_view content) = 0;
-    
+        virtual ~BaseCommandExecutor() = default;
+
+        virtual void operator()(const CommandContext& context) = 0;
+
+    };
+
+    // For executors that need only arguments
+    class ArgumentsCommandExecutor : public BaseCommandExecutor {
+    public:
+        void operator()(const CommandContext& context) final {
+            (*this)(context.arguments);
+        }
+
+        virtual void operator()(std::string_view arguments) = 0;
+
     };
 
-    class TestOutputCommandExecutor : public BaseCommandExecutor {
+    class TestOutputCommandExecutor : public ArgumentsCommandExecutor {
     public:
+        using ArgumentsCommandExecutor::operator();
 
-        void operator()([[maybe_unused]] std::string_view content) override {
+        void operator()(std::string_view content) override {
             std::cout << content << "\n";
         }
 
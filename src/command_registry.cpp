@@ -0,0 +1,208 @@
+#include "command_registry.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace commands {
+
+    using namespace std::literals;
+
+    namespace {
+
+        constexpr size_t MIN_SLOTS = 16;
+
+        char ToLower(char ch) {
+            return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+        }
+
+        // Lowercased name, empty if name can not be a command name
+        std::string MakeKey(std::string_view name, size_t max_words) {
+            if (name.empty() || name.front() == ' ' || name.back() == ' '
+                || name.find("  ") != std::string_view::npos
+                || static_cast<size_t>(std::count(name.begin(), name.end(), ' ')) >= max_words) {
+                return {};
+            }
+            std::string key(name);
+            std::transform(key.begin(), key.end(), key.begin(), ToLower);
+            return key;
+        }
+
+    } // namespace
+
+    Command& CommandRegistry::Add(std::string_view name, Command&& command) {
+        std::string key = MakeKey(name, MAX_NAME_WORDS);
+        if (key.empty()) {
+            throw std::invalid_argument("Invalid command name: "s.append(name));
+        }
+        const uint32_t key_index = InsertKey(std::move(key));
+        if (const int32_t index = keys_[key_index].entry; index != NO_ENTRY) {
+            Entry& entry = entries_[index];
+            if (entry.keys.front() == key_index) {
+                entry.command = std::make_shared<Command>(std::move(command));
+                return *entry.command;
+            }
+            // Name was an alias of another command, the new command takes it
+            entry.keys.erase(std::find(entry.keys.begin(), entry.keys.end(), key_index));
+        }
+        keys_[key_index].entry = static_cast<int32_t>(entries_.size());
+        entries_.push_back(Entry{ std::string(name), std::make_shared<Command>(std::move(command)), { key_index }, true });
+        ++size_;
+        return *entries_.back().command;
+    }
+
+    bool CommandRegistry::AddAlias(std::string_view alias, std::string_view name) {
+        const int32_t target = FindEntry(name);
+        if (target == NO_ENTRY) {
+            return false;
+        }
+        std::string key = MakeKey(alias, MAX_NAME_WORDS);
+        if (key.empty()) {
+            return false;
+        }
+        const uint32_t key_index = InsertKey(std::move(key));
+        if (keys_[key_index].entry == target) {
+            return true;
+        }
+        if (keys_[key_index].entry != NO_ENTRY) {
+            return false;
+        }
+        keys_[key_index].entry = target;
+        entries_[target].keys.push_back(key_index);
+        return true;
+    }
+
+    bool CommandRegistry::Remove(std::string_view name) {
+        const int32_t index = FindEntry(name);
+        if (index == NO_ENTRY) {
+            return false;
+        }
+        Entry& entry = entries_[index];
+        for (uint32_t key : entry.keys) {
+            keys_[key].entry = NO_ENTRY;
+        }
+        // Slot of entry is not reused: commands are changed rarely
+        entry.keys.clear();
+        entry.command.reset();
+        entry.active = false;
+        --size_;
+        return true;
+    }
+
+    Command* CommandRegistry::Find(std::string_view name) {
+        const int32_t index = FindEntry(name);
+        return index == NO_ENTRY ? nullptr : entries_[index].command.get();
+    }
+
+    const Command* CommandRegistry::Find(std::string_view name) const {
+        const int32_t index = FindEntry(name);
+        return index == NO_ENTRY ? nullptr : entries_[index].command.get();
+    }
+
+    CommandMatch CommandRegistry::Match(std::string_view text) const {
+        CommandMatch match;
+        for (size_t begin = 0; ; ) {
+            const size_t end = text.find(' ', begin);
+            const size_t size = std::min(end, text.size());
+            const uint32_t key = size == 0 ? NO_KEY : FindKey(text.substr(0, size));
+            if (key == NO_KEY) {
+                break;
+            }
+            if (const int32_t index = keys_[key].entry; index != NO_ENTRY) {
+                match.command = entries_[index].command.get();
+                match.name = text.substr(0, size);
+                match.arguments = size < text.size() ? text.substr(size + 1) : std::string_view{};
+            }
+            if (!keys_[key].extended || end == std::string_view::npos) {
+                break;
+            }
+            begin = end + 1;
+        }
+        return match;
+    }
+
+    size_t CommandRegistry::GetSize() const {
+        return size_;
+    }
+
+    // FNV-1a over lowercased bytes
+    uint64_t CommandRegistry::Hash(std::string_view text) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char ch : text) {
+            hash ^= static_cast<unsigned char>(ToLower(ch));
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool CommandRegistry::Equals(std::string_view key, std::string_view text) {
+        if (key.size() != text.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < key.size(); ++i) {
+            if (key[i] != ToLower(text[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t CommandRegistry::FindKey(std::string_view text) const {
+        if (slots_.empty()) {
+            return NO_KEY;
+        }
+        const uint64_t hash = Hash(text);
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.key == NO_KEY) {
+                return NO_KEY;
+            }
+            if (slot.hash == hash && Equals(keys_[slot.key].name, text)) {
+                return slot.key;
+            }
+        }
+    }
+
+    uint32_t CommandRegistry::InsertKey(std::string&& key) {
+        for (size_t end = key.find(' '); end != std::string::npos; end = key.find(' ', end + 1)) {
+            keys_[InsertKey(key.substr(0, end))].extended = true;
+        }
+        if (uint32_t found = FindKey(key); found != NO_KEY) {
+            return found;
+        }
+        if ((keys_.size() + 1) * 2 > slots_.size()) {
+            Rehash(std::max(slots_.size() * 2, MIN_SLOTS));
+        }
+        const auto key_index = static_cast<uint32_t>(keys_.size());
+        const uint64_t hash = Hash(key);
+        keys_.push_back(Key{ std::move(key), NO_ENTRY });
+        const size_t mask = slots_.size() - 1;
+        size_t i = hash & mask;
+        while (slots_[i].key != NO_KEY) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = Slot{ hash, key_index };
+        return key_index;
+    }
+
+    int32_t CommandRegistry::FindEntry(std::string_view name) const {
+        const uint32_t key = FindKey(name);
+        return key == NO_KEY ? NO_ENTRY : keys_[key].entry;
+    }
+
+    void CommandRegistry::Rehash(size_t capacity) {
+        std::vector<Slot> slots(capacity);
+        const size_t mask = capacity - 1;
+        for (uint32_t key = 0; key < keys_.size(); ++key) {
+            const uint64_t hash = Hash(keys_[key].name);
+            size_t i = hash & mask;
+            while (slots[i].key != NO_KEY) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = Slot{ hash, key };
+        }
+        slots_ = std::move(slots);
+    }
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "command.h"
+
+
+namespace commands {
+
+    struct CommandMatch {
+        const Command* command = nullptr;
+        // Matched part of text, as written in chat
+        std::string_view name;
+        // Text after name and one space
+        std::string_view arguments;
+    };
+
+    // Commands by name and aliases, ASCII case-insensitive. Lowercased names live in a flat open
+    // addressing table: text is hashed and compared in place, so lookups never allocate and take
+    // one probe on average. Names may have spaces, so "song skip" is a subcommand of "song": Match
+    // takes the longest one, going to the next word only while some name continues there. Changed
+    // while configuring, lookups are read only and safe from several threads
+    class CommandRegistry {
+    public:
+        // Words in one name, "song skip now" is three
+        static constexpr size_t MAX_NAME_WORDS = 4;
+
+        // Replaces command with the same name, aliases stay. Replaced command is not touched: holders
+        // of its pointer keep it alive. Throws std::invalid_argument for empty
+        // name, name of more than MAX_NAME_WORDS words or with extra spaces
+        Command& Add(std::string_view name, Command&& command);
+        // False if command is missing, alias is invalid or already names another command
+        bool AddAlias(std::string_view alias, std::string_view name);
+        // Removes command with all its names. False if there is no such name
+        bool Remove(std::string_view name);
+
+        // Exact name or alias
+        Command* Find(std::string_view name);
+        const Command* Find(std::string_view name) const;
+        // Longest name that is text prefix followed by space or end of text
+        CommandMatch Match(std::string_view text) const;
+
+        size_t GetSize() const;
+
+        // Every command once, in order of adding, as shared pointer
+        template <typename Fn>
+        void ForEach(Fn&& fn) const {
+            for (const auto& entry : entries_) {
+                if (entry.active) {
+                    fn(entry.name, entry.command);
+                }
+            }
+        }
+
+    private:
+        static constexpr int32_t NO_ENTRY = -1;
+        static constexpr uint32_t NO_KEY = UINT32_MAX;
+
+        struct Slot {
+            uint64_t hash = 0;
+            uint32_t key = NO_KEY;
+        };
+
+        struct Key {
+            std::string name;
+            // NO_ENTRY after the command is removed, key stays for the next command of that name.
+            // Also NO_ENTRY for first words of longer names that are not commands themselves
+            int32_t entry = NO_ENTRY;
+            // Some name continues this one with a space and more words
+            bool extended = false;
+        };
+
+        struct Entry {
+            std::string name;
+            std::shared_ptr<Command> command;
+            // Keys that lead here, the first is the name itself
+            std::vector<uint32_t> keys;
+            bool active = false;
+        };
+
+        // Power of two size, at most half full
+        std::vector<Slot> slots_;
+        std::vector<Key> keys_;
+        // Pointers from Find stay valid while command is registered, copies of registry share commands
+        std::deque<Entry> entries_;
+        size_t size_ = 0;
+
+        static uint64_t Hash(std::string_view text);
+        static bool Equals(std::string_view key, std::string_view text);
+
+        // Index in keys_ or NO_KEY
+        uint32_t FindKey(std::string_view text) const;
+        // Also inserts first words of key, marked as extended
+        uint32_t InsertKey(std::string&& key);
+        int32_t FindEntry(std::string_view name) const;
+        void Rehash(size_t capacity);
+    };
+
+}
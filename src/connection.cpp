@@ -12,6 +12,8 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/ssl/context_base.hpp>
 #include <boost/asio/ssl/impl/context.ipp>
 #include <boost/asio/ssl/stream.hpp>
@@ -23,6 +25,7 @@
 #include <variant>
 #include <memory>
 #include <stdexcept>
+#include <algorithm>
 
 #include "logging.h"
 #include "ca_sertificates_loader.h"
@@ -41,7 +44,7 @@ namespace connection {
     using Strand = net::strand<net::io_context::executor_type>;
 
 
-    Connection::Connection(net::io_context& ioc, Strand& write_strand, Strand& read_strand)
+    Connection::Connection(net::io_context& ioc, Strand& read_strand, [[maybe_unused]] Strand& write_strand)
         : write_strand_(read_strand)
         , read_strand_(read_strand)
         , socket_(tcp::socket(ioc))
@@ -51,7 +54,7 @@ namespace connection {
 
     }
 
-    Connection::Connection(net::io_context& ioc, ssl::context& ctx, Strand& write_strand, Strand& read_strand)
+    Connection::Connection(net::io_context& ioc, ssl::context& ctx, Strand& read_strand, [[maybe_unused]] Strand& write_strand)
         : write_strand_(read_strand)
         , read_strand_(read_strand)
         , socket_(ssl::stream<tcp::socket>(ioc, ctx))
@@ -61,25 +64,53 @@ namespace connection {
 
     }
 
-    void Connection::Connect(std::string_view host, std::string_view port) {
-        ec_.clear();
+    void Connection::AsyncConnect(std::string_view host, std::string_view port, ConnectHandler&& handler) {
+        auto visitor = std::make_shared<AsyncConnectVisitor>(this->shared_from_this(), host, port, std::move(handler));
+        net::dispatch(read_strand_, [visitor]() {
+            visitor->Start();
+            });
+    }
 
-        ConnectionVisitor visitor(*this, host, port);
-        std::visit(visitor, socket_);
-        if (ec_) {
-            logging::ReportError(ec_, "Connection");
-        }
+    void Connection::SetConnectTimeouts(const ConnectTimeouts& timeouts) {
+        connect_timeouts_ = timeouts;
+    }
+
+    void Connection::SetEndpointOffset(size_t offset) {
+        endpoint_offset_ = offset;
     }
 
     void Connection::Disconnect(bool is_need_to_close_socket) {
-        ec_.clear();
+        net::dispatch(read_strand_, [self = this->shared_from_this(), is_need_to_close_socket]() {
+            self->ec_.clear();
 
-        DisconnectVisitor visitor(*this, is_need_to_close_socket);
-        std::visit(visitor, socket_);
-        if (ec_) {
-            logging::ReportError(ec_, "Disconnecting");
-        }
-        LOG_INFO("Disconnected");
+            DisconnectVisitor visitor(*self, is_need_to_close_socket);
+            std::visit(visitor, self->socket_);
+            if (self->ec_) {
+                logging::ReportError(self->ec_, "Disconnecting");
+            }
+            LOG_INFO("Disconnected");
+            });
+    }
+
+    void Connection::Abort() {
+        net::dispatch(read_strand_, [self = this->shared_from_this()]() {
+            std::visit([&self](auto& socket) {
+                sys::error_code ec;
+                socket.lowest_layer().close(ec);
+                if (ec) {
+                    logging::ReportError(ec, "Aborting connection");
+                }
+                }, self->socket_);
+            });
+    }
+
+    void Connection::SetReadBufferSize(size_t initial_size, size_t max_size) {
+        read_buffer_ = std::make_unique<ReadBuffer>(initial_size, max_size);
+    }
+
+    void Connection::SetCapture(std::shared_ptr<CaptureWriter> capture, uint32_t source) {
+        capture_ = std::move(capture);
+        capture_source_ = source;
     }
 
     bool Connection::IsReconnectRequired() {
@@ -90,6 +121,55 @@ namespace connection {
         return false;
     }
 
+    WriteStats Connection::GetWriteStats() const {
+        WriteStats stats;
+        stats.writes = writes_.load(std::memory_order_relaxed);
+        stats.lines = written_lines_.load(std::memory_order_relaxed);
+        stats.coalesced = stats.lines - std::min(stats.lines, stats.writes);
+        return stats;
+    }
+
+    void Connection::StartWrite() {
+        if (write_in_flight_ || write_queue_.empty() || !IsConnected()) {
+            return;
+        }
+        write_in_flight_ = true;
+
+        const size_t batch_size = std::min(write_queue_.size(), MAX_COALESCED_WRITES);
+        in_flight_.clear();
+        write_buffers_.clear();
+        for (size_t i = 0; i < batch_size; ++i) {
+            in_flight_.push_back(std::move(write_queue_.front()));
+            write_queue_.pop_front();
+        }
+        // Buffers are taken after all moves - short strings live inside the message
+        for (const auto& message : in_flight_) {
+            write_buffers_.push_back(net::buffer(message.data));
+        }
+
+        writes_.fetch_add(1, std::memory_order_relaxed);
+        written_lines_.fetch_add(batch_size, std::memory_order_relaxed);
+
+        AsyncWriteVisitor visitor(this->shared_from_this());
+        std::visit(visitor, socket_);
+    }
+
+    void Connection::OnWrite(const sys::error_code& ec) {
+        write_in_flight_ = false;
+        if (ec == net::error::eof) {
+            LOG_INFO("Connection closed gracefully by server");
+        }
+        for (auto& message : in_flight_) {
+            if (message.handler) {
+                message.handler(ec);
+            }
+        }
+        in_flight_.clear();
+        if (!ec) {
+            StartWrite();
+        }
+    }
+
     bool Connection::IsConnected() const {
         return ssl_connected_ || connected_;
     }
@@ -102,68 +182,225 @@ namespace connection {
         return secured_;
     }
 
-    void Connection::ConnectionVisitor::operator()(tcp::socket& socket) {
-        tcp::resolver resolver(socket.get_executor()); // :(
-        auto endpoints = resolver.resolve(host_, port_);
-        if (connection_.ec_) {
-            logging::ReportError(connection_.ec_, "Resolving");
+    Connection::AsyncConnectVisitor::AsyncConnectVisitor(std::shared_ptr<Connection> connection
+        , std::string_view host, std::string_view port, ConnectHandler&& handler)
+        : connection_(connection)
+        , host_(host)
+        , port_(port)
+        , handler_(std::move(handler))
+        , resolver_(connection->read_strand_)
+        , step_timer_(connection->read_strand_)
+        , attempt_timer_(connection->read_strand_)
+    {
+    }
+
+    void Connection::AsyncConnectVisitor::Start() {
+        StartStepTimer(Step::RESOLVE, connection_->connect_timeouts_.resolve);
+        resolver_.async_resolve(host_, port_, [self = this->shared_from_this()]
+        (const sys::error_code& ec, tcp::resolver::results_type results) {
+                self->OnResolve(ec, std::move(results));
+            });
+    }
+
+    void Connection::AsyncConnectVisitor::OnResolve(const sys::error_code& ec, tcp::resolver::results_type results) {
+        if (step_ != Step::RESOLVE) {
+            return;
         }
-        else {
-            LOG_INFO("Resolved "s.append(host_).append(":"s).append(port_));
-            for (const auto& ep : endpoints) {
-                LOG_INFO(endpoints.begin()->endpoint().address().to_string().append(":"s).append(port_));
+        if (ec) {
+            logging::ReportError(ec, "Resolving");
+            Finish(ec);
+            return;
+        }
+
+        // Alternate address families starting with the one resolver prefers
+        std::vector<tcp::endpoint> preferred;
+        std::vector<tcp::endpoint> other;
+        for (const auto& entry : results) {
+            LOG_INFO("Resolved "s.append(host_).append(" -> "s).append(entry.endpoint().address().to_string()));
+            if (preferred.empty() || entry.endpoint().protocol() == preferred.front().protocol()) {
+                preferred.push_back(entry.endpoint());
+            }
+            else {
+                other.push_back(entry.endpoint());
+            }
+        }
+        for (size_t i = 0; i < std::max(preferred.size(), other.size()); ++i) {
+            if (i < preferred.size()) {
+                endpoints_.push_back(preferred[i]);
+            }
+            if (i < other.size()) {
+                endpoints_.push_back(other[i]);
             }
         }
-        net::connect(socket, endpoints, connection_.ec_);
-        if (connection_.ec_) {
-            logging::ReportError(connection_.ec_, "Connection"sv);
+
+        if (endpoints_.empty()) {
+            Finish(net::error::host_not_found);
             return;
         }
-        connection_.connected_ = true;
+        std::rotate(endpoints_.begin(), endpoints_.begin() + connection_->endpoint_offset_ % endpoints_.size(), endpoints_.end());
+
+        StartStepTimer(Step::CONNECT, connection_->connect_timeouts_.connect);
+        StartNextAttempt();
     }
 
-    void Connection::ConnectionVisitor::operator()(ssl::stream<tcp::socket>& socket) {
-        tcp::resolver resolver(socket.get_executor()); // :(
-        auto endpoints = resolver.resolve(host_, port_, connection_.ec_);
+    void Connection::AsyncConnectVisitor::StartNextAttempt() {
+        if (step_ != Step::CONNECT || attempts_.size() == endpoints_.size()) {
+            return;
+        }
 
-        if (connection_.ec_) {
-            logging::ReportError(connection_.ec_, "Resolving");
-            throw std::runtime_error("cant resolve: "s.append(host_).append(" ").append(port_));
+        const size_t index = attempts_.size();
+        attempts_.push_back(std::make_unique<tcp::socket>(connection_->read_strand_));
+        attempts_.back()->async_connect(endpoints_[index], [self = this->shared_from_this(), index](const sys::error_code& ec) {
+            self->OnAttempt(index, ec);
+            });
+
+        if (attempts_.size() < endpoints_.size()) {
+            attempt_timer_.expires_after(connection_->connect_timeouts_.attempt_delay);
+            attempt_timer_.async_wait([self = this->shared_from_this()](const sys::error_code& ec) {
+                if (!ec) {
+                    self->StartNextAttempt();
+                }
+                });
         }
+    }
 
-        LOG_INFO("Resolved "s.append(host_).append(":"s).append(port_));
-        for (const auto& ep : endpoints) {
-            LOG_INFO(endpoints.begin()->endpoint().address().to_string().append(":"s).append(port_));
+    void Connection::AsyncConnectVisitor::OnAttempt(size_t index, const sys::error_code& ec) {
+        if (step_ != Step::CONNECT) {
+            return;
         }
 
-        SSL_set_tlsext_host_name(socket.native_handle(), host_.c_str());
-        net::connect(socket.lowest_layer(), endpoints, connection_.ec_);
-        if (connection_.ec_) {
-            logging::ReportError(connection_.ec_, "SSL Connection"sv);
+        if (ec) {
+            LOG_WARN("Connecting "s.append(endpoints_[index].address().to_string()).append(" failed: "s).append(ec.message()));
+            last_error_ = ec;
+            if (++failed_attempts_ == endpoints_.size()) {
+                logging::ReportError(ec, "Connection"sv);
+                Finish(ec);
+            }
+            else if (failed_attempts_ == attempts_.size()) {
+                // Nothing in flight - don't wait for stagger delay
+                StartNextAttempt();
+            }
             return;
         }
-        else {
-            LOG_INFO("CONNECTED");
+
+        LOG_INFO("CONNECTED "s.append(endpoints_[index].address().to_string()));
+        winner_ = std::move(attempts_[index]);
+        attempt_timer_.cancel();
+        CloseAttempts();
+
+        sys::error_code ignor;
+        winner_->set_option(tcp::no_delay(true), ignor);
+        std::visit(*this, connection_->socket_);
+    }
+
+    void Connection::AsyncConnectVisitor::operator()(tcp::socket& socket) {
+        socket = std::move(*winner_);
+        connection_->connected_ = true;
+        Finish({});
+    }
+
+    void Connection::AsyncConnectVisitor::operator()(ssl::stream<tcp::socket>& socket) {
+        socket.next_layer() = std::move(*winner_);
+        SSL_set_tlsext_host_name(socket.native_handle(), host_.c_str());
+        TlsClientContext::Instance().ApplySession(socket.native_handle());
+
+        StartStepTimer(Step::HANDSHAKE, connection_->connect_timeouts_.handshake);
+        socket.async_handshake(ssl::stream_base::client, net::bind_executor(connection_->read_strand_
+            , [self = this->shared_from_this(), &socket, start = std::chrono::steady_clock::now()]
+            (const sys::error_code& ec) {
+                if (self->step_ != Step::HANDSHAKE) {
+                    TlsClientContext::Instance().OnHandshake(socket.native_handle(), {}, false);
+                    return;
+                }
+                TlsClientContext::Instance().OnHandshake(socket.native_handle()
+                    , std::chrono::steady_clock::now() - start, !ec);
+                if (ec) {
+                    ERR_print_errors_fp(stderr);
+                    logging::ReportError(ec, "SSL Handshake");
+                    sys::error_code ignor;
+                    socket.lowest_layer().close(ignor);
+                    self->Finish(ec);
+                    return;
+                }
+
+                LOG_INFO("HANDSHAKE SUCESS");
+                if (SSL_get_verify_result(socket.native_handle()) != X509_V_OK) {
+                    LOG_INFO("SSL Certificate verification failed");
+                }
+                else {
+                    LOG_INFO("SSL Certificate verified successfully");
+                }
+                self->connection_->ssl_connected_ = true;
+                self->Finish({});
+            }));
+    }
+
+    void Connection::AsyncConnectVisitor::StartStepTimer(Step step, std::chrono::milliseconds timeout) {
+        step_ = step;
+        step_timer_.expires_after(timeout);
+        step_timer_.async_wait([self = this->shared_from_this(), step](const sys::error_code& ec) {
+            self->OnStepTimeout(step, ec);
+            });
+    }
+
+    void Connection::AsyncConnectVisitor::OnStepTimeout(Step step, const sys::error_code& ec) {
+        if (ec || step != step_) {
+            return;
         }
-        socket.lowest_layer().set_option(tcp::no_delay(true));
-        socket.handshake(ssl::stream_base::client, connection_.ec_);
-        if (connection_.ec_) {
-            ERR_print_errors_fp(stderr);
 
-            logging::ReportError(connection_.ec_, "SSL Handshake");
-            socket.lowest_layer().close();
+        switch (step) {
+        case Step::RESOLVE:
+            LOG_ERROR("Resolving "s.append(host_).append(" timed out"));
+            resolver_.cancel();
+            break;
+        case Step::CONNECT:
+            LOG_ERROR("Connecting "s.append(host_).append(" timed out"));
+            attempt_timer_.cancel();
+            CloseAttempts();
+            break;
+        case Step::HANDSHAKE:
+            LOG_ERROR("SSL Handshake with "s.append(host_).append(" timed out"));
+            std::visit([](auto& socket) {
+                sys::error_code ignor;
+                socket.lowest_layer().close(ignor);
+                }, connection_->socket_);
+            break;
+        default:
             return;
         }
+        Finish(net::error::timed_out);
+    }
 
-        else {
-            LOG_INFO("HANDSHAKE SUCESS");
+    void Connection::AsyncConnectVisitor::CloseAttempts() {
+        sys::error_code ignor;
+        for (auto& attempt : attempts_) {
+            if (attempt) {
+                attempt->close(ignor);
+            }
         }
-        connection_.ssl_connected_ = true;
-        if (SSL_get_verify_result(socket.native_handle()) != X509_V_OK) {
-            LOG_INFO("SSL Certificate verification failed");
+    }
+
+    void Connection::AsyncConnectVisitor::Finish(const sys::error_code& ec) {
+        if (step_ == Step::DONE) {
+            return;
+        }
+        step_ = Step::DONE;
+        step_timer_.cancel();
+        attempt_timer_.cancel();
+
+        if (ec) {
+            CloseAttempts();
         }
         else {
-            LOG_INFO("SSL Certificate verified successfully");
+            // Lines queued before connect
+            net::post(connection_->write_strand_, [connection = connection_]() {
+                connection->StartWrite();
+                });
+        }
+
+        if (handler_) {
+            auto handler = std::move(handler_);
+            handler(ec);
         }
     }
 
@@ -12,6 +12,8 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/ssl/context_base.hpp>
 #include <boost/asio/ssl/impl/context.ipp>
 #include <boost/asio/ssl/stream.hpp>
@@ -19,14 +21,22 @@
 #include <boost/asio/ssl/verify_mode.hpp>
 #include <openssl/ssl.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 #include <memory>
 #include <stdexcept>
 
 #include "logging.h"
 #include "ca_sertificates_loader.h"
+#include "read_buffer.h"
+#include "tls_client_context.h"
+#include "traffic_capture.h"
 
 
 namespace connection {
@@ -38,62 +48,52 @@ namespace connection {
     using namespace std::literals;
 
     using Strand = net::strand<net::io_context::executor_type>;
+    using WriteHandler = std::function<void(const sys::error_code&)>;
 
-    // AI on
-    static std::shared_ptr<ssl::context> GetSSLContext() {
-        auto ctx = std::make_shared<ssl::context>(ssl::context::tls_client);
+    using ConnectHandler = std::function<void(const sys::error_code&)>;
 
-        SSL_CTX_set_info_callback(ctx->native_handle(), [](const SSL* ssl, int where, int ret) {
-            if (where & SSL_CB_HANDSHAKE_START) {
-                LOG_INFO("SSL Handshake starting...");
-            }
-            if (where & SSL_CB_HANDSHAKE_DONE) {
-                LOG_INFO("SSL Handshake completed!");
-            }
-            });
-
-        ctx->set_options(
-            ssl::context::default_workarounds |
-            ssl::context::no_sslv2 |
-            ssl::context::no_sslv3 |
-            ssl::context::no_tlsv1 |
-            ssl::context::no_tlsv1_1
-        );
-
-        ctx->set_verify_mode(ssl::verify_peer);
-
-        try {
-            ctx->set_default_verify_paths();
-            LOG_INFO("Default verify paths set successfully");
-        }
-        catch (const std::exception& e) {
-            LOG_ERROR("set_default_verify_paths failed: "s.append(e.what()));
-        }
-
-        ssl_domain_utilities::load_windows_ca_certificates(*ctx);
-
-        const char* ciphers =
-            "ECDHE+AESGCM:ECDHE+CHACHA20:DHE+AESGCM:DHE+CHACHA20:!aNULL:!MD5:!DSS:!RC4";
-
-        if (SSL_CTX_set_cipher_list(ctx->native_handle(), ciphers) != 1) {
-            LOG_ERROR("Failed to set cipher list");
-        }
-
-        SSL_CTX_set_min_proto_version(ctx->native_handle(), TLS1_2_VERSION);
+    struct ConnectTimeouts {
+        std::chrono::milliseconds resolve = 5s;
+        std::chrono::milliseconds connect = 10s;
+        std::chrono::milliseconds handshake = 10s;
+        std::chrono::milliseconds attempt_delay = 250ms;
+    };
 
-        return ctx;
-    }
-    // AI OFF
+    struct WriteStats {
+        size_t writes = 0;
+        size_t lines = 0;
+        size_t coalesced = 0; // lines that went out merged into a write of an earlier line
+    };
 
     class Connection : public std::enable_shared_from_this<Connection> {
     public:
+        // Reads, writes and closing of the socket all run on read_strand: closing it from another
+        // strand would race with operations started there. write_strand is not used
         Connection(net::io_context& ioc, Strand& read_strand, Strand& write_strand);
 
+        // ssl::stream is not thread safe either, same strand for everything
         Connection(net::io_context& ioc, ssl::context& ctx, Strand& read_strand, Strand& write_strand);
 
-        void Connect(std::string_view host, std::string_view port);
+        // Resolve, connect and TLS handshake without blocking the caller. Resolved endpoints are
+        // raced happy eyeballs style: next one starts after attempt_delay or right after a failure.
+        // handler is called once on read_strand.
+        void AsyncConnect(std::string_view host, std::string_view port, ConnectHandler&& handler);
+
+        void SetConnectTimeouts(const ConnectTimeouts& timeouts);
+        // Rotates resolved endpoints before racing them. Redundant connections to one host use
+        // different offsets to land on different edge servers
+        void SetEndpointOffset(size_t offset);
 
+        // Runs on read_strand, may return before the socket is closed
         void Disconnect(bool is_need_to_close_socket = true);
+        // Closes socket without shutdown exchange, for links that don't answer anymore.
+        // Pending read fails and the read handler sees reconnect required
+        void Abort();
+
+        // Must be called before first read
+        void SetReadBufferSize(size_t initial_size, size_t max_size);
+        // Every received chunk is written to capture under source id. Must be called before first read
+        void SetCapture(std::shared_ptr<CaptureWriter> capture, uint32_t source);
 
         bool IsReconnectRequired();
 
@@ -104,23 +104,16 @@ namespace connection {
             std::visit(*visitor, socket_);
         }
 
-        void Write(std::string_view data) {
-            ec_.clear();
-            auto visitor = std::make_shared<WriteVisitor>(
-                this->shared_from_this(), data);
-
-            std::visit(*visitor, socket_);
-            if (ec_) {
-                logging::ReportError(ec_, "Writing");
-            }
-        }
-
+        // Queues data on write_strand_. Queued lines are merged into one scatter-gather write,
+        // only one write is in flight at a time. Lines queued before connect are sent after it.
         template <typename Handler>
         void AsyncWrite(std::string_view data, Handler&& callback) {
-            auto visitor = std::make_shared<AsyncWriteVisitor<Handler>>(
-                this->shared_from_this(), data, std::forward<Handler>(callback));
-
-            std::visit(*visitor, socket_);
+            LOG_INFO("Sending: "s.append(data));
+            net::post(write_strand_, [self = this->shared_from_this(), data = std::string(data)
+                , callback = WriteHandler(std::forward<Handler>(callback))]() mutable {
+                    self->write_queue_.push_back(OutboundMessage{ std::move(data), std::move(callback) });
+                    self->StartWrite();
+                });
         }
 
         void AsyncWrite(std::string_view data) {
@@ -131,6 +124,8 @@ namespace connection {
                 });
         }
 
+        WriteStats GetWriteStats() const;
+
         bool IsConnected() const;
 
         net::io_context* GetContext();
@@ -138,35 +133,87 @@ namespace connection {
         bool IsSecured() const;
 
     private:
+        // Same strand as read_strand_, see constructors
         Strand& write_strand_;
         Strand& read_strand_;
         sys::error_code ec_;
         std::variant<tcp::socket, ssl::stream<tcp::socket>> socket_;
+        std::unique_ptr<ReadBuffer> read_buffer_ = std::make_unique<ReadBuffer>();
+        std::shared_ptr<CaptureWriter> capture_;
+        uint32_t capture_source_ = 0;
 
-        bool ssl_connected_ = false;
+        struct OutboundMessage {
+            std::string data;
+            WriteHandler handler;
+        };
+
+        static constexpr size_t MAX_COALESCED_WRITES = 64;
+
+        // write_strand_ only
+        std::deque<OutboundMessage> write_queue_;
+        std::vector<OutboundMessage> in_flight_;
+        std::vector<net::const_buffer> write_buffers_;
+        bool write_in_flight_ = false;
+
+        std::atomic<size_t> writes_{ 0 };
+        std::atomic<size_t> written_lines_{ 0 };
+
+        ConnectTimeouts connect_timeouts_;
+        size_t endpoint_offset_ = 0;
+
+        std::atomic<bool> ssl_connected_ = false;
         bool secured_ = false;
-        bool connected_ = false;
+        std::atomic<bool> connected_ = false;
         bool reconnect_required_ = false;
 
         net::io_context* ioc_ = nullptr;
 
-        class ConnectionVisitor {
+        void StartWrite();
+        void OnWrite(const sys::error_code& ec);
+
+        class AsyncConnectVisitor : public std::enable_shared_from_this<AsyncConnectVisitor> {
         public:
-            explicit ConnectionVisitor(Connection& connection, std::string_view host, std::string_view port)
-                : connection_(connection)
-                , host_(host)
-                , port_(port)
-            {
-            }
+            AsyncConnectVisitor(std::shared_ptr<Connection> connection, std::string_view host
+                , std::string_view port, ConnectHandler&& handler);
+
+            void Start();
 
+            // Adopt the socket that won the race
             void operator()(tcp::socket& socket);
 
             void operator()(ssl::stream<tcp::socket>& socket);
 
         private:
-            Connection& connection_;
+            enum class Step {
+                RESOLVE,
+                CONNECT,
+                HANDSHAKE,
+                DONE
+            };
+
+            std::shared_ptr<Connection> connection_;
             std::string host_;
             std::string port_;
+            ConnectHandler handler_;
+
+            tcp::resolver resolver_;
+            net::steady_timer step_timer_;
+            net::steady_timer attempt_timer_;
+            Step step_ = Step::RESOLVE;
+
+            std::vector<tcp::endpoint> endpoints_;
+            std::vector<std::unique_ptr<tcp::socket>> attempts_;
+            size_t failed_attempts_ = 0;
+            sys::error_code last_error_;
+            std::unique_ptr<tcp::socket> winner_;
+
+            void OnResolve(const sys::error_code& ec, tcp::resolver::results_type results);
+            void StartNextAttempt();
+            void OnAttempt(size_t index, const sys::error_code& ec);
+            void StartStepTimer(Step step, std::chrono::milliseconds timeout);
+            void OnStepTimeout(Step step, const sys::error_code& ec);
+            void CloseAttempts();
+            void Finish(const sys::error_code& ec);
         };
 
         class DisconnectVisitor {
@@ -196,12 +243,9 @@ namespace connection {
             AsyncReadVisitor(const AsyncReadVisitor&) = delete;
             AsyncReadVisitor& operator=(const AsyncReadVisitor&) = delete;
 
-            explicit AsyncReadVisitor(std::weak_ptr<Connection> connection
-                , Handler&& handler
-                , size_t read_buffer_size = 128)
+            explicit AsyncReadVisitor(std::shared_ptr<Connection> connection, Handler&& handler)
                 : connection_(connection)
                 , handler_(std::forward<Handler>(handler))
-                , read_buffer_size_(read_buffer_size)
             {
             }
 
@@ -217,116 +261,59 @@ namespace connection {
             HandlerType handler_;
             std::shared_ptr<Connection> connection_;
 
-            size_t read_buffer_size_;
-            std::shared_ptr<std::vector<char>> buffer_ = std::make_shared<std::vector<char>>(read_buffer_size_);
-
+            // Reads straight into the connection buffer. Only one read is in flight at a time:
+            // next one is requested by handler after it consumed the complete lines.
             template <typename Socket>
             void ReadMessages(bool is_connected, Socket& socket) {
-                if (is_connected) {
-                    net::async_read(socket, net::buffer(*buffer_), net::transfer_at_least(1)
-                        , net::bind_executor(connection_->read_strand_
-                            , [self = this->shared_from_this()]
-                            (const sys::error_code& ec, std::size_t bytes_readed) mutable
-                            {
-                                if (bytes_readed > 0) {
-                                    self->OnRead(ec, std::vector<char>(self->buffer_->begin(), self->buffer_->begin() + bytes_readed));
-                                }
-                                else {
-                                    LOG_ERROR("0 bytes readed");
-                                }
-                            }));
-                }
-                else {
+                if (!is_connected) {
                     throw std::runtime_error("Trying read socket without connection");
                 }
+                socket.async_read_some(connection_->read_buffer_->Prepare()
+                    , net::bind_executor(connection_->read_strand_
+                        , [self = this->shared_from_this()]
+                        (const sys::error_code& ec, std::size_t bytes_readed) mutable
+                        {
+                            self->OnRead(ec, bytes_readed);
+                        }));
             }
 
-
-            void OnRead(const sys::error_code& ec, std::vector<char>&& bytes) {
+            void OnRead(const sys::error_code& ec, std::size_t bytes_readed) {
                 if (ec) {
                     logging::ReportError(ec, "Reading");
                     connection_->reconnect_required_ = true;
                 }
-                net::post(connection_->read_strand_,
-                    [handler = handler_, bytes = std::move(bytes)]() mutable {
-                        handler(std::move(bytes));
-                    });
-            }
-        };
-
-        class WriteVisitor : public std::enable_shared_from_this<WriteVisitor> {
-        public:
-            explicit WriteVisitor(std::shared_ptr<Connection> connection, std::string_view data)
-                : connection_(connection)
-                , data_(data)
-            {
-
-            }
-
-            void operator()(tcp::socket& socket) {
-                WriteMessages(connection_->connected_, socket);
-            }
-
-            void operator()(ssl::stream<tcp::socket>& socket) {
-                WriteMessages(connection_->ssl_connected_, socket);
-            }
-
-        private:
-            std::shared_ptr<Connection> connection_;
-            std::string data_;
-
-            template <typename Socket>
-            void WriteMessages(bool is_connected, Socket& socket) {
-                if (!is_connected) {
-                    throw std::runtime_error("Writing socket without connection");
+                connection_->read_buffer_->Commit(bytes_readed);
+                if (connection_->capture_ && bytes_readed > 0) {
+                    auto data = connection_->read_buffer_->Data();
+                    connection_->capture_->Write(connection_->capture_source_, data.substr(data.size() - bytes_readed));
                 }
-                LOG_INFO("Sending: "s.append(data_));
-                net::write(socket, net::buffer(data_), connection_->ec_);
+                handler_(*connection_->read_buffer_);
             }
         };
 
-        template <typename Handler>
-        class AsyncWriteVisitor : public std::enable_shared_from_this<AsyncWriteVisitor<Handler>> {
+        class AsyncWriteVisitor {
         public:
-            explicit AsyncWriteVisitor(std::shared_ptr<Connection> connection, std::string_view data, Handler&& handler)
+            explicit AsyncWriteVisitor(std::shared_ptr<Connection> connection)
                 : connection_(connection)
-                , data_(data)
-                , handler_(std::forward<Handler>(handler))
             {
-
             }
 
             void operator()(tcp::socket& socket) {
-                AsyncWriteMessages(connection_->connected_, socket);
+                AsyncWriteMessages(socket);
             }
 
             void operator()(ssl::stream<tcp::socket>& socket) {
-                AsyncWriteMessages(connection_->ssl_connected_, socket);
+                AsyncWriteMessages(socket);
             }
 
         private:
             std::shared_ptr<Connection> connection_;
-            std::string data_;
-            Handler handler_;
 
             template <typename Socket>
-            void AsyncWriteMessages(bool is_connected, Socket& socket) {
-                if (!is_connected) {
-                    throw std::runtime_error("Writing socket without connection");
-                }
-                LOG_INFO("Sending: "s.append(data_));
-                net::write(socket, net::buffer(data_), connection_->ec_);
-
-                net::async_write(socket, net::buffer(data_), net::bind_executor(connection_->write_strand_
-                    , [self = this->shared_from_this()](const sys::error_code& ec, size_t bytes_writen) {
-                        if (ec) {
-                            if (ec == boost::asio::error::eof) {
-                                LOG_INFO("Connection closed gracefully by server");
-                            }
-                            else {
-                                self->handler_(ec);
-                            }
-                        }
+            void AsyncWriteMessages(Socket& socket) {
+                net::async_write(socket, connection_->write_buffers_, net::bind_executor(connection_->write_strand_
+                    , [connection = connection_](const sys::error_code& ec, [[maybe_unused]] size_t bytes_writen) {
+                        connection->OnWrite(ec);
                     }));
             }
         };
@@ -0,0 +1,204 @@
+#include "cooldown.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace commands {
+
+    namespace {
+
+        // Ready time minus now, times wrap in 32 bits
+        int64_t Until(uint32_t ready_at, uint32_t now) {
+            return static_cast<int32_t>(ready_at - now);
+        }
+
+        // Wait allowed before the call, burst - 1 periods are taken in advance
+        int64_t GetTolerance(const Cooldown& cooldown) {
+            return static_cast<int64_t>(std::max<uint32_t>(cooldown.burst, 1) - 1) * cooldown.period.count();
+        }
+
+        size_t Home(irc::domain::NameId key, size_t mask) {
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        }
+
+    } // namespace
+
+    CooldownTable::CooldownTable(size_t max_size)
+        : max_size_(max_size)
+        , processed_tick_(TICK_MASK)
+    {
+    }
+
+    CooldownTable::Verdict CooldownTable::Check(irc::domain::NameId key, uint32_t now, const Cooldown& cooldown) const {
+        if (!slots_.empty()) {
+            const Slot& slot = slots_[FindSlot(key)];
+            if (slot.key == key) {
+                return Until(slot.ready_at, now) <= GetTolerance(cooldown) ? Verdict::ALLOWED : Verdict::LIMITED;
+            }
+        }
+        return size_ < max_size_ ? Verdict::ALLOWED : Verdict::FULL;
+    }
+
+    void CooldownTable::Take(irc::domain::NameId key, uint32_t now, const Cooldown& cooldown) {
+        const auto period = static_cast<uint32_t>(cooldown.period.count());
+        if (!slots_.empty()) {
+            Slot& slot = slots_[FindSlot(key)];
+            if (slot.key == key) {
+                slot.ready_at = (Until(slot.ready_at, now) > 0 ? slot.ready_at : now) + period;
+                return;
+            }
+        }
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Rehash(std::max(slots_.size() * 2, MIN_CAPACITY));
+        }
+        slots_[FindSlot(key)] = Slot{ key, now + period };
+        ++size_;
+        Schedule(key, now + period);
+    }
+
+    void CooldownTable::Advance(uint32_t now) {
+        const uint32_t target = ((now >> TICK_BITS) - 1) & TICK_MASK;
+        const uint32_t ticks = (target - processed_tick_) & TICK_MASK;
+        // Upper half of the tick range is behind processed tick
+        if (ticks == 0 || ticks > TICK_MASK / 2) {
+            return;
+        }
+        // After a full turn every slot is visited once, keys that are not due stay
+        for (uint32_t i = std::min(ticks, WHEEL_SLOTS); i > 0; --i) {
+            ProcessTick(target - i + 1, now);
+        }
+        processed_tick_ = target;
+        if (slots_.size() > MIN_CAPACITY && size_ * 8 < slots_.size()) {
+            Rehash(slots_.size() / 2);
+        }
+    }
+
+    size_t CooldownTable::GetSize() const {
+        return size_;
+    }
+
+    size_t CooldownTable::FindSlot(irc::domain::NameId key) const {
+        const size_t mask = slots_.size() - 1;
+        size_t i = Home(key, mask);
+        while (slots_[i].key != key && slots_[i].key != NO_KEY) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // Backward shift: keys after the hole move into it unless that puts them before their home
+    void CooldownTable::Erase(size_t index) {
+        const size_t mask = slots_.size() - 1;
+        for (size_t next = (index + 1) & mask; slots_[next].key != NO_KEY; next = (next + 1) & mask) {
+            const size_t home = Home(slots_[next].key, mask);
+            if (((next - home) & mask) >= ((next - index) & mask)) {
+                slots_[index] = slots_[next];
+                index = next;
+            }
+        }
+        slots_[index] = Slot{};
+        --size_;
+    }
+
+    void CooldownTable::Rehash(size_t capacity) {
+        std::vector<Slot> old = std::exchange(slots_, std::vector<Slot>(capacity));
+        for (const Slot& slot : old) {
+            if (slot.key != NO_KEY) {
+                slots_[FindSlot(slot.key)] = slot;
+            }
+        }
+    }
+
+    void CooldownTable::Schedule(irc::domain::NameId key, uint32_t ready_at) {
+        wheel_[(ready_at >> TICK_BITS) & (WHEEL_SLOTS - 1)].push_back(key);
+    }
+
+    void CooldownTable::ProcessTick(uint32_t tick, uint32_t now) {
+        auto& wheel_slot = wheel_[tick & (WHEEL_SLOTS - 1)];
+        if (wheel_slot.empty()) {
+            return;
+        }
+        std::swap(wheel_slot, expiring_);
+        for (irc::domain::NameId key : expiring_) {
+            const size_t index = FindSlot(key);
+            if (slots_[index].key != key) {
+                continue;
+            }
+            if (Until(slots_[index].ready_at, now) <= 0) {
+                Erase(index);
+            }
+            else {
+                Schedule(key, slots_[index].ready_at);
+            }
+        }
+        expiring_.clear();
+    }
+
+    CooldownTracker::CooldownTracker(CooldownLimits limits)
+        : limits_(limits)
+        , start_(Clock::now())
+        , channels_(limits.max_tracked)
+        , users_(limits.max_tracked)
+    {
+    }
+
+    bool CooldownTracker::TryAcquire(irc::domain::NameId channel, irc::domain::NameId user, Clock::time_point now) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_).count();
+        const auto now_ms = static_cast<uint64_t>(std::max<int64_t>(elapsed, 0));
+        const auto now_wrapped = static_cast<uint32_t>(now_ms);
+        const bool by_global = limits_.global.period.count() > 0;
+        const bool by_channel = limits_.per_channel.period.count() > 0;
+        const bool by_user = limits_.per_user.period.count() > 0;
+
+        std::lock_guard lock(mutex_);
+        channels_.Advance(now_wrapped);
+        users_.Advance(now_wrapped);
+
+        if (by_global && static_cast<int64_t>(global_ready_at_ - now_ms) > GetTolerance(limits_.global)) {
+            ++stats_.limited_global;
+            return false;
+        }
+        const auto channel_verdict = by_channel
+            ? channels_.Check(channel, now_wrapped, limits_.per_channel) : CooldownTable::Verdict::ALLOWED;
+        const auto user_verdict = by_user
+            ? users_.Check(user, now_wrapped, limits_.per_user) : CooldownTable::Verdict::ALLOWED;
+        if (channel_verdict == CooldownTable::Verdict::LIMITED) {
+            ++stats_.limited_channel;
+            return false;
+        }
+        if (user_verdict == CooldownTable::Verdict::LIMITED) {
+            ++stats_.limited_user;
+            return false;
+        }
+        // Full table must not lock out every new chatter: its level is skipped, the others still hold
+        if (channel_verdict == CooldownTable::Verdict::FULL || user_verdict == CooldownTable::Verdict::FULL) {
+            ++stats_.overflowed;
+        }
+
+        if (by_global) {
+            global_ready_at_ = std::max(global_ready_at_, now_ms) + static_cast<uint64_t>(limits_.global.period.count());
+        }
+        if (by_channel && channel_verdict == CooldownTable::Verdict::ALLOWED) {
+            channels_.Take(channel, now_wrapped, limits_.per_channel);
+        }
+        if (by_user && user_verdict == CooldownTable::Verdict::ALLOWED) {
+            users_.Take(user, now_wrapped, limits_.per_user);
+        }
+        ++stats_.allowed;
+        return true;
+    }
+
+    CooldownStats CooldownTracker::GetStats() const {
+        std::lock_guard lock(mutex_);
+        CooldownStats stats = stats_;
+        stats.tracked_channels = channels_.GetSize();
+        stats.tracked_users = users_.GetSize();
+        return stats;
+    }
+
+    const CooldownLimits& CooldownTracker::GetLimits() const {
+        return limits_;
+    }
+
+}
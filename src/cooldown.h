@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "string_interner.h"
+
+
+namespace commands {
+
+    struct Cooldown {
+        // Time between calls once burst is spent, 0 - no limit
+        std::chrono::milliseconds period{ 0 };
+        // Calls allowed at once after a quiet period
+        uint32_t burst = 1;
+    };
+
+    struct CooldownLimits {
+        Cooldown global;
+        Cooldown per_channel;
+        Cooldown per_user;
+        // Users and channels tracked at once, each. When full, calls of untracked ones are checked only
+        // by the other levels and not remembered until old entries expire
+        size_t max_tracked = 1 << 20;
+    };
+
+    struct CooldownStats {
+        size_t allowed = 0;
+        size_t limited_global = 0;
+        size_t limited_channel = 0;
+        size_t limited_user = 0;
+        // Allowed by the other levels only, user or channel had no room among max_tracked entries
+        size_t overflowed = 0;
+        size_t tracked_channels = 0;
+        size_t tracked_users = 0;
+    };
+
+    // Cooldown state of many keys, GCRA: one time per key when its bucket is full again. Keys live in
+    // a flat open addressing table, 8 bytes each. A hashed timer wheel removes keys whose time has
+    // passed: such key is the same as a new one, so the table holds only keys limited right now.
+    // Times are milliseconds, wrapping in 32 bits. Not thread safe
+    class CooldownTable {
+    public:
+        enum class Verdict {
+            ALLOWED,
+            LIMITED,
+            FULL
+        };
+
+        explicit CooldownTable(size_t max_size);
+
+        Verdict Check(irc::domain::NameId key, uint32_t now, const Cooldown& cooldown) const;
+        // Call only after Check returned ALLOWED
+        void Take(irc::domain::NameId key, uint32_t now, const Cooldown& cooldown);
+        // Removes keys that expired before now
+        void Advance(uint32_t now);
+
+        size_t GetSize() const;
+
+    private:
+        static constexpr uint32_t NO_KEY = UINT32_MAX;
+        // Wheel slot covers 2^TICK_BITS ms, full turn is about 16 s. Keys due later stay in their
+        // slot and are checked again on the next turn
+        static constexpr uint32_t TICK_BITS = 6;
+        static constexpr uint32_t WHEEL_SLOTS = 256;
+        // Ticks are times shifted by TICK_BITS, they wrap in the remaining bits
+        static constexpr uint32_t TICK_MASK = UINT32_MAX >> TICK_BITS;
+        static constexpr size_t MIN_CAPACITY = 16;
+
+        struct Slot {
+            irc::domain::NameId key = NO_KEY;
+            uint32_t ready_at = 0;
+        };
+
+        size_t max_size_;
+        // Power of two size, at most half full
+        std::vector<Slot> slots_;
+        size_t size_ = 0;
+
+        std::array<std::vector<irc::domain::NameId>, WHEEL_SLOTS> wheel_;
+        // Slot being processed, kept to reuse its capacity
+        std::vector<irc::domain::NameId> expiring_;
+        // Last wheel tick fully processed
+        uint32_t processed_tick_;
+
+        size_t FindSlot(irc::domain::NameId key) const;
+        void Erase(size_t index);
+        void Rehash(size_t capacity);
+        void Schedule(irc::domain::NameId key, uint32_t ready_at);
+        void ProcessTick(uint32_t tick, uint32_t now);
+    };
+
+    // Global, per channel and per user cooldowns of one command, checked in O(1). A limited call
+    // spends nothing, so a spamming user doesn't block others. Thread safe
+    class CooldownTracker {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit CooldownTracker(CooldownLimits limits);
+
+        bool TryAcquire(irc::domain::NameId channel, irc::domain::NameId user, Clock::time_point now = Clock::now());
+        CooldownStats GetStats() const;
+        const CooldownLimits& GetLimits() const;
+
+    private:
+        CooldownLimits limits_;
+        Clock::time_point start_;
+
+        mutable std::mutex mutex_;
+        // Milliseconds from start_, when global bucket is full again
+        uint64_t global_ready_at_ = 0;
+        CooldownTable channels_;
+        CooldownTable users_;
+        CooldownStats stats_;
+    };
+
+}
@@ -0,0 +1,85 @@
+#include "dedup_window.h"
+
+#include <algorithm>
+
+
+namespace irc {
+
+    namespace dedup {
+
+        // One extra bucket: the current one is partially filled, the window must still be fully covered
+        DedupWindow::DedupWindow(std::chrono::milliseconds window, size_t buckets)
+            : bucket_span_(std::max<Clock::duration>(window / std::max<size_t>(buckets, 1), 1ms))
+            , buckets_(std::max<size_t>(buckets, 1) + 1)
+        {
+        }
+
+        bool DedupWindow::Insert(std::string_view id, size_t source, Clock::time_point now) {
+            if (id.empty()) {
+                ++unique_;
+                return true;
+            }
+
+            const int64_t epoch = now.time_since_epoch() / bucket_span_;
+
+            std::lock_guard lock(mutex_);
+            for (const auto& bucket : buckets_) {
+                if (bucket.epoch <= epoch - static_cast<int64_t>(buckets_.size())) {
+                    continue;
+                }
+                auto it = bucket.ids.find(id);
+                if (it == bucket.ids.end()) {
+                    continue;
+                }
+
+                ++duplicates_;
+                if (it->second.source != source) {
+                    ++GetSource(source).losses;
+                    auto& winner = GetSource(it->second.source);
+                    const auto lead = std::chrono::duration_cast<std::chrono::microseconds>(now - it->second.at);
+                    winner.total_lead += lead;
+                    winner.max_lead = std::max(winner.max_lead, lead);
+                    ++winner.leads;
+                }
+                return false;
+            }
+
+            auto& current = buckets_[static_cast<size_t>(epoch) % buckets_.size()];
+            if (current.epoch != epoch) {
+                current.ids.clear();
+                current.epoch = epoch;
+            }
+            current.ids.emplace(std::string(id), Arrival{ source, now });
+            ++GetSource(source).wins;
+            ++unique_;
+            return true;
+        }
+
+        void DedupWindow::Clear() {
+            std::lock_guard lock(mutex_);
+            for (auto& bucket : buckets_) {
+                bucket.ids.clear();
+                bucket.epoch = -1;
+            }
+        }
+
+        DedupStats DedupWindow::GetStats() const {
+            return { unique_.load(std::memory_order_relaxed), duplicates_.load(std::memory_order_relaxed) };
+        }
+
+        std::vector<SourceStats> DedupWindow::GetSourceStats() const {
+            std::lock_guard lock(mutex_);
+            return sources_;
+        }
+
+        // mutex_ must be held. Sources are connection indices: few and dense
+        SourceStats& DedupWindow::GetSource(size_t source) {
+            if (source >= sources_.size()) {
+                sources_.resize(source + 1);
+            }
+            return sources_[source];
+        }
+
+    } // namespace dedup
+
+} // namespace irc
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace irc {
+
+    namespace dedup {
+
+        using Clock = std::chrono::steady_clock;
+        using namespace std::literals;
+
+        struct DedupStats {
+            size_t unique = 0;
+            size_t duplicates = 0;
+        };
+
+        // Race results of one source (connection) feeding the window
+        struct SourceStats {
+            size_t wins = 0;   // first copy came from this source
+            size_t losses = 0; // copy came after another source already delivered it
+            // How far ahead of the slower copy this source was, over wins that had a slower copy
+            std::chrono::microseconds total_lead{};
+            std::chrono::microseconds max_lead{};
+            size_t leads = 0;
+        };
+
+        // Remembers message ids for at least `window`. Ids live in a ring of time buckets:
+        // when time moves past the oldest bucket it is cleared whole, so memory is bounded
+        // by the message rate of one window and no per-id expiry is tracked.
+        class DedupWindow {
+        public:
+            explicit DedupWindow(std::chrono::milliseconds window = 30s, size_t buckets = 4);
+
+            // true if id was not seen in the window. Empty ids are always unique
+            bool Insert(std::string_view id, size_t source = 0, Clock::time_point now = Clock::now());
+            void Clear();
+
+            DedupStats GetStats() const;
+            std::vector<SourceStats> GetSourceStats() const;
+
+        private:
+            struct Arrival {
+                size_t source = 0;
+                Clock::time_point at;
+            };
+
+            // Lets lookups take string_view, only inserts build a std::string
+            struct IdHash {
+                using is_transparent = void;
+
+                size_t operator()(std::string_view id) const {
+                    return std::hash<std::string_view>{}(id);
+                }
+            };
+
+            struct Bucket {
+                int64_t epoch = -1;
+                std::unordered_map<std::string, Arrival, IdHash, std::equal_to<>> ids;
+            };
+
+            mutable std::mutex mutex_;
+            Clock::duration bucket_span_;
+            std::vector<Bucket> buckets_;
+            std::vector<SourceStats> sources_;
+            std::atomic<size_t> unique_{ 0 };
+            std::atomic<size_t> duplicates_{ 0 };
+
+            SourceStats& GetSource(size_t source);
+        };
+
+    } // namespace dedup
+
+} // namespace irc
@@ -22,12 +22,20 @@ namespace irc {
             PART,
             PRIVMSG,
             PING,
+            PONG,
             STATUSCODE,
             CAPRES,
             UNKNOWN,
             EMPTY,
             CLEARCHAT,
-            USERNOTICE
+            USERNOTICE,
+            RECONNECT,
+            CLEARMSG,
+            NOTICE,
+            USERSTATE,
+            GLOBALUSERSTATE,
+            WHISPER,
+            HOSTTARGET
         };
 
         struct Command {
@@ -49,6 +57,13 @@ namespace irc {
             static constexpr std::string_view STATUSCODE = "STATUSCODE"sv;
             static constexpr std::string_view CLEARCHAT = "CLEARCHAT"sv;
             static constexpr std::string_view USERNOTICE = "USERNOTICE"sv;
+            static constexpr std::string_view RECONNECT = "RECONNECT"sv;
+            static constexpr std::string_view CLEARMSG = "CLEARMSG"sv;
+            static constexpr std::string_view NOTICE = "NOTICE"sv;
+            static constexpr std::string_view USERSTATE = "USERSTATE"sv;
+            static constexpr std::string_view GLOBALUSERSTATE = "GLOBALUSERSTATE"sv;
+            static constexpr std::string_view WHISPER = "WHISPER"sv;
+            static constexpr std::string_view HOSTTARGET = "HOSTTARGET"sv;
         };
 
         struct Capabilityes {
@@ -107,6 +122,9 @@ namespace irc {
             case MessageType::PING:
                 out << Command::PING;
                 break;
+            case MessageType::PONG:
+                out << Command::PONG;
+                break;
             case MessageType::PRIVMSG:
                 out << Command::PRIVMSG;
                 break;
@@ -119,6 +137,30 @@ namespace irc {
             case MessageType::CLEARCHAT:
                 out << Command::CLEARCHAT;
                 break;
+            case MessageType::RECONNECT:
+                out << Command::RECONNECT;
+                break;
+            case MessageType::USERNOTICE:
+                out << Command::USERNOTICE;
+                break;
+            case MessageType::CLEARMSG:
+                out << Command::CLEARMSG;
+                break;
+            case MessageType::NOTICE:
+                out << Command::NOTICE;
+                break;
+            case MessageType::USERSTATE:
+                out << Command::USERSTATE;
+                break;
+            case MessageType::GLOBALUSERSTATE:
+                out << Command::GLOBALUSERSTATE;
+                break;
+            case MessageType::WHISPER:
+                out << Command::WHISPER;
+                break;
+            case MessageType::HOSTTARGET:
+                out << Command::HOSTTARGET;
+                break;
             }
 
         }
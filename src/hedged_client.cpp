@@ -0,0 +1,112 @@
+#include "hedged_client.h"
+
+#include <stdexcept>
+
+
+namespace irc {
+
+    HedgedClient::HedgedClient(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, size_t connections_count
+        , bool secured, std::chrono::milliseconds dedup_window)
+        : rate_limiter_(std::make_shared<outbound::RateLimiter>())
+        , dedup_(std::make_shared<dedup::DedupWindow>(dedup_window))
+    {
+        if (connections_count == 0) {
+            throw std::invalid_argument("Hedged client requires at least one connection");
+        }
+        replicas_.reserve(connections_count);
+        for (size_t i = 0; i < connections_count; ++i) {
+            Replica replica{ std::make_shared<Client>(ioc, chat_bot, secured) };
+            replica.client->SetRateLimiter(rate_limiter_);
+            replica.client->SetDedupWindow(dedup_, i);
+            // i-th connection starts racing from i-th resolved address
+            replica.client->SetEndpointOffset(i);
+            replica.client->SetConnectionStateHandler([connected = replica.connected](bool is_connected) {
+                connected->store(is_connected);
+                });
+            replicas_.push_back(std::move(replica));
+        }
+    }
+
+    void HedgedClient::Connect() {
+        for (auto& replica : replicas_) {
+            replica.client->Connect();
+        }
+    }
+
+    void HedgedClient::Disconnect() {
+        for (auto& replica : replicas_) {
+            replica.client->Disconnect();
+        }
+    }
+
+    void HedgedClient::Authorize(const domain::AuthorizeData& auth_data) {
+        for (auto& replica : replicas_) {
+            replica.client->Authorize(auth_data);
+        }
+    }
+
+    void HedgedClient::CapRequest() {
+        for (auto& replica : replicas_) {
+            replica.client->CapRequest();
+        }
+    }
+
+    void HedgedClient::Read() {
+        for (auto& replica : replicas_) {
+            replica.client->Read();
+        }
+    }
+
+    void HedgedClient::Join(std::string_view channel_name) {
+        for (auto& replica : replicas_) {
+            replica.client->Join(channel_name);
+        }
+    }
+
+    void HedgedClient::Join(const std::vector<std::string_view>& channels_names) {
+        for (auto& replica : replicas_) {
+            replica.client->Join(channels_names);
+        }
+    }
+
+    void HedgedClient::Part(std::string_view channel_name) {
+        for (auto& replica : replicas_) {
+            replica.client->Part(channel_name);
+        }
+    }
+
+    void HedgedClient::SetRateLimits(const outbound::RateLimits& limits) {
+        rate_limiter_->SetLimits(limits);
+    }
+
+    std::vector<HedgeStats> HedgedClient::GetHedgeStats() const {
+        const auto sources = dedup_->GetSourceStats();
+        std::vector<HedgeStats> result;
+        result.reserve(replicas_.size());
+        for (size_t i = 0; i < replicas_.size(); ++i) {
+            HedgeStats stats;
+            stats.index = i;
+            stats.connected = replicas_[i].connected->load();
+            if (i < sources.size()) {
+                const auto& source = sources[i];
+                stats.wins = source.wins;
+                stats.losses = source.losses;
+                stats.max_lead = source.max_lead;
+                if (source.leads > 0) {
+                    stats.average_lead = source.total_lead / source.leads;
+                }
+            }
+            result.push_back(stats);
+        }
+        return result;
+    }
+
+    dedup::DedupStats HedgedClient::GetDedupStats() const {
+        return dedup_->GetStats();
+    }
+
+    size_t HedgedClient::Size() const {
+        return replicas_.size();
+    }
+
+} // namespace irc
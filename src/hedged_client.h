@@ -0,0 +1,64 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "auth_data.h"
+#include "chat_bot.h"
+#include "dedup_window.h"
+#include "irc_client.h"
+
+
+namespace irc {
+
+    struct HedgeStats {
+        size_t index = 0;
+        size_t wins = 0;
+        size_t losses = 0;
+        // Average and worst advantage over the slower copy when this connection won
+        std::chrono::microseconds average_lead{};
+        std::chrono::microseconds max_lead{};
+        bool connected = false;
+    };
+
+    // Reads the same channels over several connections to different resolved edges.
+    // Every message is handled once: the first copy wins, later copies are dropped by IRCv3 id
+    // in a dedup window shared by all connections, so a stalled edge doesn't delay chat.
+    class HedgedClient : public std::enable_shared_from_this<HedgedClient> {
+    public:
+        HedgedClient() = delete;
+        HedgedClient(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, size_t connections_count = 2
+            , bool secured = true, std::chrono::milliseconds dedup_window = 30s);
+
+        void Connect();
+        void Disconnect();
+        void Authorize(const domain::AuthorizeData& auth_data);
+        void CapRequest();
+        void Read();
+        void Join(std::string_view channel_name);
+        void Join(const std::vector<std::string_view>& channels_names);
+        void Part(std::string_view channel_name);
+        // All connections log in with one account and share its rate limits
+        void SetRateLimits(const outbound::RateLimits& limits);
+
+        std::vector<HedgeStats> GetHedgeStats() const;
+        dedup::DedupStats GetDedupStats() const;
+        size_t Size() const;
+
+    private:
+        struct Replica {
+            std::shared_ptr<Client> client;
+            std::shared_ptr<std::atomic<bool>> connected = std::make_shared<std::atomic<bool>>(false);
+        };
+
+        std::shared_ptr<outbound::RateLimiter> rate_limiter_;
+        std::shared_ptr<dedup::DedupWindow> dedup_;
+        std::vector<Replica> replicas_;
+    };
+
+} // namespace irc
@@ -1,123 +1,303 @@
 #include "irc_client.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
 namespace irc {
 
     Client::Client(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, bool secured)
         : read_strand_(net::make_strand(ioc))
         , write_strand_(net::make_strand(ioc))
         , connection_strand_(net::make_strand(ioc))
-        , reconnect_timer_(ioc)
-
+        , reconnect_timer_(connection_strand_)
+        , handover_timer_(connection_strand_)
+        , dedup_timer_(connection_strand_)
+        , secured_(secured)
+        , host_(domain::IRC_EPS::HOST)
+        , port_(secured ? domain::IRC_EPS::SSL_PORT : domain::IRC_EPS::PORT)
     {
+        rate_limiter_ = std::make_shared<outbound::RateLimiter>();
+        outbound_ = std::make_shared<outbound::OutboundScheduler>(ioc, rate_limiter_);
+        join_scheduler_ = std::make_shared<membership::JoinScheduler>(ioc, outbound_);
+        keepalive_ = std::make_shared<keepalive::Keepalive>(ioc, outbound_);
         if (secured) {
             ctx_ = connection::GetSSLContext();
             connection_ = std::make_shared<connection::Connection>(ioc, *ctx_, read_strand_, write_strand_);
-            message_handler_ = std::make_shared<handler::MessageHandler>(connection_, connection_strand_);
+            message_handler_ = std::make_shared<handler::MessageHandler>(connection_, connection_strand_, outbound_);
         }
         else {
             connection_ = std::make_shared<connection::Connection>(ioc, read_strand_, write_strand_);
-            message_handler_ = std::make_shared<handler::MessageHandler>(connection_, connection_strand_);
+            message_handler_ = std::make_shared<handler::MessageHandler>(connection_, connection_strand_, outbound_);
         }
+        outbound_->SetConnection(connection_);
+        active_connection_ = connection_.get();
         message_handler_->SetChatBot(chat_bot);
+        message_handler_->SetJoinScheduler(join_scheduler_);
+        message_handler_->SetKeepalive(keepalive_);
     }
 
     void Client::SetChatBot(std::shared_ptr<chat_bot::ChatBot> chat_bot) {
         message_handler_->SetChatBot(chat_bot);
     }
 
+    void Client::SetConnectionStateHandler(ConnectionStateHandler handler) {
+        connection_state_handler_ = std::move(handler);
+    }
+
+    // Lines written before connect wait in connection queue, reading starts on connect
     void Client::Connect() {
-        connection_->Connect(domain::IRC_EPS::HOST, domain::IRC_EPS::SSL_PORT);
+        keepalive_->SetDeadLinkHandler([weak_self = this->weak_from_this()]() {
+            if (auto self = weak_self.lock()) {
+                self->OnDeadLink();
+            }
+            });
+        message_handler_->SetServerReconnectHandler([weak_self = this->weak_from_this()]() {
+            if (auto self = weak_self.lock()) {
+                net::dispatch(self->connection_strand_, [self]() {
+                    self->StartHandover();
+                    });
+            }
+            });
+        connection_->AsyncConnect(host_, port_, [self = this->shared_from_this()](const sys::error_code& ec) {
+            self->OnConnect(ec);
+            });
     }
 
     void Client::Disconnect() {
+        keepalive_->Stop();
+        net::dispatch(connection_strand_, [self = this->shared_from_this()]() {
+            self->reconnect_timer_.cancel();
+            self->DropHandover();
+            });
         connection_->Disconnect();
+        if (capture_) {
+            capture_->Flush();
+        }
     }
 
+    // Channels are batched and paced by join scheduler
     void Client::Join(const std::vector<std::string_view>& channels_names) {
-        std::string join_command = GetChannelNamesInStringCommand(channels_names);
-        AddJoinCommandToBuffer(join_command);
-        connection_->Write(std::string(domain::Command::JOIN_CHANNEL) + join_command + "\r\n"s);
         for (const auto channel : channels_names) {
-            joined_channels_.insert(std::string(channel));
+            join_scheduler_->Join(channel);
         }
     }
 
     void Client::Join(const std::string_view channel_name) {
-        AddJoinCommandToBuffer(channel_name);
-        connection_->Write(std::string(domain::Command::JOIN_CHANNEL) + std::string(channel_name) + "\r\n"s);
-        joined_channels_.insert(std::string(channel_name));
+        join_scheduler_->Join(channel_name);
     }
 
+    // Rejoin after reconnect
     void Client::Join() {
-        if (!join_command_buffer_) {
-            throw std::runtime_error("Empty reconnect buffer");
-        }
-        connection_->Write(std::string(domain::Command::JOIN_CHANNEL) + *join_command_buffer_ + "\r\n"s);
+        join_scheduler_->Rejoin();
     }
 
     void Client::Part(const std::string_view channel_name) {
-        connection_->Write(std::string(domain::Command::PART_CHANNEL) + std::string(channel_name) + "\r\n"s);
-        joined_channels_.erase(std::string(channel_name));
+        join_scheduler_->Part(channel_name);
     }
 
     void Client::Authorize() {
         if (!auth_data_buffer_) {
             throw std::runtime_error("Empty reconnect buffer");
         }
-        connection_->Write(*auth_data_buffer_);
+        outbound_->Send(outbound::Priority::AUTH, *auth_data_buffer_);
     }
 
     void Client::Authorize(const domain::AuthorizeData& auth_data) {
         auth_data_buffer_ = auth_data.GetAuthMessage();
-        connection_->Write(*auth_data_buffer_);
+        join_scheduler_->SetNick(auth_data.GetNick());
+        outbound_->Send(outbound::Priority::AUTH, *auth_data_buffer_);
     }
 
     void Client::CapRequest() {
-        connection_->Write(std::string(domain::Command::CREQ)
+        outbound_->Send(outbound::Priority::AUTH, GetCapRequestLine());
+    }
+
+    std::string Client::GetCapRequestLine() const {
+        return std::string(domain::Command::CREQ)
             + std::string(domain::Capabilityes::COMMANDS) + " "
             + std::string(domain::Capabilityes::MEMBERSHIP) + " "
-            + std::string(domain::Capabilityes::TAGS) + "\r\n");
+            + std::string(domain::Capabilityes::TAGS) + "\r\n";
     }
 
     void Client::Read() {
-        auto process_message = net::bind_executor(read_strand_, [self = this->shared_from_this()](std::vector<char>&& bytes) {
-            self->OnRead(std::move(bytes));
+        net::dispatch(read_strand_, [self = this->shared_from_this()]() {
+            self->read_requested_ = true;
+            if (self->connection_->IsConnected()) {
+                self->StartRead(self->connection_);
+            }
+            });
+    }
+
+    void Client::OnConnect(const sys::error_code& ec) {
+        NotifyConnectionState(!ec);
+        if (ec) {
+            logging::ReportError(ec, "Connecting");
+            net::dispatch(connection_strand_, [self = this->shared_from_this()]() {
+                self->Reconnect(self->secured_);
+                });
+            return;
+        }
+        connected_at_ = keepalive::Clock::now().time_since_epoch().count();
+        keepalive_->Start();
+        if (read_requested_) {
+            StartRead(connection_);
+        }
+    }
+
+    void Client::StartRead(std::shared_ptr<connection::Connection> connection, std::shared_ptr<Handover> handover) {
+        auto process_message = net::bind_executor(read_strand_, [self = this->shared_from_this(), connection, handover]
+        (connection::ReadBuffer& buffer) {
+            self->OnRead(connection, handover, buffer);
             });
-        connection_->AsyncRead(process_message);
+        connection->AsyncRead(process_message);
     }
 
     bool Client::CheckConnect() {
         return connection_->IsConnected();
     }
 
+    void Client::SetRateLimits(const outbound::RateLimits& limits) {
+        rate_limiter_->SetLimits(limits);
+    }
+
+    void Client::SetJoinConfig(const membership::JoinConfig& config) {
+        join_scheduler_->SetConfig(config);
+    }
+
+    membership::JoinStats Client::GetJoinStats() const {
+        return join_scheduler_->GetStats();
+    }
+
+    bool Client::IsJoined(std::string_view channel_name) const {
+        return join_scheduler_->IsJoined(channel_name);
+    }
+
+    void Client::SetRateLimiter(std::shared_ptr<outbound::RateLimiter> limiter) {
+        rate_limiter_ = limiter;
+        outbound_->SetRateLimiter(limiter);
+    }
+
+    outbound::OutboundStats Client::GetOutboundStats() const {
+        return outbound_->GetStats();
+    }
+
+    void Client::SetKeepaliveConfig(const keepalive::KeepaliveConfig& config) {
+        keepalive_->SetConfig(config);
+    }
+
+    keepalive::KeepaliveStats Client::GetKeepaliveStats() const {
+        return keepalive_->GetStats();
+    }
+
+    void Client::SetBackoffConfig(const keepalive::BackoffConfig& config) {
+        backoff_.SetConfig(config);
+    }
+
+    keepalive::BackoffStats Client::GetBackoffStats() const {
+        return backoff_.GetStats();
+    }
+
     void Client::SetReconnectTimeout(int timeout) {
-        reconnect_timeout_ = timeout;
+        auto config = backoff_.GetConfig();
+        config.max = std::chrono::seconds(timeout);
+        backoff_.SetConfig(config);
+    }
+
+    int Client::GetReconnectTimeout() {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(backoff_.GetConfig().max).count());
+    }
+
+    void Client::SetHandoverTimeout(std::chrono::milliseconds timeout) {
+        net::dispatch(connection_strand_, [self = this->shared_from_this(), timeout]() {
+            self->handover_timeout_ = timeout;
+            });
+    }
+
+    size_t Client::GetHandoversCount() const {
+        return handovers_.load();
+    }
+
+    dedup::DedupStats Client::GetDedupStats() const {
+        return message_handler_->GetDedupStats();
+    }
+
+    void Client::SetDedupWindow(std::shared_ptr<dedup::DedupWindow> window, size_t source) {
+        message_handler_->SetDedupWindow(window, source);
+    }
+
+    // Call before Connect
+    void Client::SetEndpointOffset(size_t offset) {
+        endpoint_offset_ = offset;
+        connection_->SetEndpointOffset(offset);
+    }
+
+    void Client::SetServer(std::string_view host, std::string_view port) {
+        host_ = std::string(host);
+        port_ = std::string(port);
+    }
+
+    void Client::SetCaptureFile(const std::string& path) {
+        capture_ = std::make_shared<connection::CaptureWriter>(path);
+        connection_->SetCapture(capture_, capture_sources_++);
     }
 
-    inline int Client::GetReconnectTimeout() {
-        return reconnect_timeout_;
+    std::optional<connection::CaptureStats> Client::GetCaptureStats() const {
+        if (!capture_) {
+            return std::nullopt;
+        }
+        return capture_->GetStats();
     }
 
-    inline const std::unordered_set<std::string>& Client::GetJoinedChannels() {
-        return joined_channels_;
+    std::unordered_set<std::string> Client::GetJoinedChannels() {
+        return join_scheduler_->GetChannels();
     }
 
-    void Client::OnRead(std::vector<char>&& bytes) {
+    void Client::OnRead(const std::shared_ptr<connection::Connection>& connection, const std::shared_ptr<Handover>& handover
+        , connection::ReadBuffer& buffer) {
         try {
-            std::vector<char> saved_bytes = std::move(bytes);
-            auto messages = message_processor_.GetMessagesFromRawBytes(saved_bytes);
+            const bool is_active = connection.get() == active_connection_.load();
+            const bool is_standby = !is_active && handover && handover.get() == active_handover_.load();
+            if (!is_active && !is_standby) {
+                // Replaced by handover or reconnect: stop reading it
+                return;
+            }
+
+            size_t consumed = 0;
+            auto messages = message_processor_.GetMessagesFromRawBytes(buffer.Data(), consumed);
+            buffer.Consume(consumed);
+            if (is_active) {
+                keepalive_->OnActivity();
+            }
+            else {
+                FilterHandoverMessages(*handover, messages);
+            }
             net::post([self = this->shared_from_this(), messages = std::move(messages)]() mutable
                 {
                     (*self->message_handler_)(std::move(messages));
                 });
 
-            if (connection_->IsReconnectRequired()) {
-                net::dispatch(connection_strand_, [self = this->shared_from_this()]() {
-                    self->Reconnect();
-                    });
+            if (connection->IsReconnectRequired()) {
+                if (is_active) {
+                    OnConnectionLost();
+                }
+                else {
+                    LOG_WARN("Standby connection lost, staying on current one");
+                    net::dispatch(connection_strand_, [self = this->shared_from_this(), handover]() {
+                        if (self->handover_ == handover) {
+                            self->DropHandover();
+                        }
+                        });
+                }
+                return;
             }
-            else {
-                Read();
+
+            StartRead(connection, handover);
+            if (is_standby && handover->joins->IsSettled()) {
+                net::dispatch(connection_strand_, [self = this->shared_from_this(), handover]() {
+                    self->CompleteHandover(handover);
+                    });
             }
         }
         catch (const std::exception& e) {
@@ -126,63 +306,319 @@ namespace irc {
         }
     }
 
-    void Client::Reconnect(bool secured) {
-        net::io_context* ioc = nullptr;
-        ioc = connection_->GetContext();
+    // Current connection failed. If standby is already up it just takes over, otherwise reconnect
+    void Client::OnConnectionLost() {
+        net::dispatch(connection_strand_, [self = this->shared_from_this()]() {
+            if (self->handover_ && self->handover_->connection->IsConnected()) {
+                self->CompleteHandover(self->handover_);
+                return;
+            }
+            self->NotifyConnectionState(false);
+            self->Reconnect(self->secured_);
+            });
+    }
 
-        if (secured) {
-            ctx_.reset();
-            ctx_ = connection::GetSSLContext();
-            connection_ = std::make_shared<connection::Connection>(*ioc, *ctx_, write_strand_, read_strand_);
-        }
-        else {
-            connection_ = std::make_shared<connection::Connection>(*ioc, write_strand_, read_strand_);
+    void Client::Reconnect(bool secured) {
+        keepalive_->Stop();
+        DropHandover();
+        // Connection that lived long enough was healthy: start backoff from the beginning
+        const auto connected_at = keepalive::Clock::time_point(keepalive::Clock::duration(connected_at_.exchange(0)));
+        if (connected_at != keepalive::Clock::time_point{}
+            && keepalive::Clock::now() - connected_at >= backoff_.GetConfig().stable_after) {
+            backoff_.Reset();
         }
+        const auto delay = backoff_.NextDelay();
+        LOG_INFO("Reconnecting in "s.append(std::to_string(delay.count())).append(" ms"));
+
+        connection_ = MakeConnection();
+        active_connection_ = connection_.get();
 
         try {
-            reconnect_timer_.expires_after(std::chrono::seconds(reconnect_timeout_));
-            reconnect_timer_.async_wait([self = this->shared_from_this(), secured](const sys::error_code& ec) {
+            reconnect_timer_.expires_after(delay);
+            // Runs on connection strand with handover changes. Cancelled by Disconnect
+            reconnect_timer_.async_wait([self = this->shared_from_this()](const sys::error_code& ec) {
                 if (ec) {
-                    logging::ReportError(ec, "Waiting reconnect timer");
+                    return;
                 }
-                std::string_view port = secured ? domain::IRC_EPS::SSL_PORT : domain::IRC_EPS::PORT;
-                self->connection_->Connect(domain::IRC_EPS::HOST, port);
                 self->message_handler_->UpdateConnection(self->connection_);
-                self->message_processor_.FlushBuffer();
-                self->Authorize();
-                self->Read();
+                self->outbound_->SetConnection(self->connection_);
+                // Anonymous client has nothing to send again
+                if (self->auth_data_buffer_) {
+                    self->Authorize();
+                }
                 self->CapRequest();
                 self->Join();
+                self->Connect();
                 });
         }
         catch (const std::exception& e) {
             LOG_ERROR("Reconnecting error: "s.append(e.what()));
-            LOG_INFO("Retry after "s.append(std::to_string(reconnect_timeout_)).append(" sec"));
             Reconnect(secured);
         }
 
     }
 
-    std::string Client::GetChannelNamesInStringCommand(std::vector<std::string_view> channels_names) {
-        std::string command;
-        bool is_first = true;
-        for (const auto& channel_name : channels_names) {
-            if (!is_first) {
-                command += ",#";
+    std::shared_ptr<connection::Connection> Client::MakeConnection() {
+        net::io_context* ioc = connection_->GetContext();
+        auto connection = secured_
+            ? std::make_shared<connection::Connection>(*ioc, *ctx_, read_strand_, write_strand_)
+            : std::make_shared<connection::Connection>(*ioc, read_strand_, write_strand_);
+        connection->SetEndpointOffset(endpoint_offset_);
+        if (capture_) {
+            connection->SetCapture(capture_, capture_sources_++);
+        }
+        return connection;
+    }
+
+    // Make-before-break: current connection keeps reading while the new one connects,
+    // authorizes and joins. Runs on connection_strand_
+    void Client::StartHandover() {
+        if (handover_) {
+            return;
+        }
+        LOG_INFO("Opening standby connection");
+        auto handover = std::make_shared<Handover>();
+        handover->connection = MakeConnection();
+        handover->outbound = std::make_shared<outbound::OutboundScheduler>(*handover->connection->GetContext(), rate_limiter_);
+        handover->outbound->SetConnection(handover->connection);
+        if (auth_data_buffer_) {
+            handover->outbound->Send(outbound::Priority::AUTH, *auth_data_buffer_);
+        }
+        handover->outbound->Send(outbound::Priority::AUTH, GetCapRequestLine());
+        handover->joins = join_scheduler_->Fork(handover->outbound);
+        dedup_timer_.cancel();
+        message_handler_->SetHandoverDedup(true);
+
+        handover_ = handover;
+        active_handover_ = handover.get();
+
+        handover_timer_.expires_after(handover_timeout_);
+        handover_timer_.async_wait([self = this->shared_from_this(), handover](const sys::error_code& ec) {
+            if (ec || self->handover_ != handover) {
+                return;
+            }
+            if (handover->connection->IsConnected()) {
+                LOG_WARN("Standby didn't join every channel in time, switching anyway");
+                self->CompleteHandover(handover);
+            }
+            else {
+                LOG_WARN("Standby didn't connect in time");
+                self->DropHandover();
+            }
+            });
+
+        handover->connection->AsyncConnect(host_, port_
+            , [self = this->shared_from_this(), handover](const sys::error_code& ec) {
+                self->OnHandoverConnect(handover, ec);
+            });
+    }
+
+    void Client::OnHandoverConnect(std::shared_ptr<Handover> handover, const sys::error_code& ec) {
+        if (ec) {
+            logging::ReportError(ec, "Connecting standby");
+            net::dispatch(connection_strand_, [self = this->shared_from_this(), handover]() {
+                if (self->handover_ == handover) {
+                    self->DropHandover();
+                }
+                });
+            return;
+        }
+        net::dispatch(read_strand_, [self = this->shared_from_this(), handover]() {
+            self->StartRead(handover->connection, handover);
+            });
+    }
+
+    // Standby answers its own PINGs and confirms its own joins; chat goes to handler,
+    // where copies already delivered by current connection are dropped by id
+    void Client::FilterHandoverMessages(const Handover& handover, std::vector<domain::Message>& messages) {
+        auto it = std::remove_if(messages.begin(), messages.end(), [&handover](const domain::Message& message) {
+            switch (message.GetMessageType()) {
+            case domain::MessageType::PING:
+                handover.outbound->Send(outbound::Priority::PONG
+                    , std::string(domain::Command::PONG).append(" :").append(message.GetContent()).append("\r\n"));
+                return true;
+            case domain::MessageType::JOIN:
+            case domain::MessageType::PART:
+                handover.joins->OnMembership(message.GetMessageType(), message.GetLoginId(), message.GetChannelId());
+                return true;
+            case domain::MessageType::PONG:
+            case domain::MessageType::RECONNECT:
+                return true;
+            default:
+                return false;
             }
-            command += channel_name;
-            is_first = false;
+            });
+        messages.erase(it, messages.end());
+    }
+
+    // Runs on connection_strand_
+    void Client::CompleteHandover(std::shared_ptr<Handover> handover) {
+        if (!handover || handover_ != handover) {
+            return;
         }
-        return command;
+        handover_timer_.cancel();
+        auto old_connection = connection_;
+
+        connection_ = handover->connection;
+        active_connection_ = connection_.get();
+        active_handover_ = nullptr;
+        handover_.reset();
+
+        outbound_->SetConnection(connection_);
+        message_handler_->UpdateConnection(connection_);
+        join_scheduler_->TakeOver(*handover->joins);
+        connected_at_ = keepalive::Clock::now().time_since_epoch().count();
+        keepalive_->Start();
+        ++handovers_;
+        LOG_INFO("Switched to standby connection");
+        FinishHandoverDedup();
+
+        // Old server is going away, no need for polite shutdown
+        old_connection->Abort();
     }
 
-    inline void Client::AddJoinCommandToBuffer(std::string_view join_command) {
-        if (join_command_buffer_) {
-            (*join_command_buffer_) += ",#"s.append(std::string(join_command));
+    // Runs on connection_strand_
+    void Client::DropHandover() {
+        if (!handover_) {
+            return;
         }
-        else {
-            join_command_buffer_ = std::string(join_command);
+        handover_timer_.cancel();
+        active_handover_ = nullptr;
+        handover_->connection->Abort();
+        handover_.reset();
+        FinishHandoverDedup();
+    }
+
+    // Runs on connection_strand_. Messages already read from the connection that stopped are still
+    // on their way to handler, dedup stays on for them
+    void Client::FinishHandoverDedup() {
+        dedup_timer_.expires_after(HANDOVER_DEDUP_TAIL);
+        dedup_timer_.async_wait([self = this->shared_from_this()](const sys::error_code& ec) {
+            if (!ec && !self->handover_) {
+                self->message_handler_->SetHandoverDedup(false);
+            }
+            });
+    }
+
+    // Read is stuck on a half-open socket: closing it fails the read and the usual reconnect follows
+    void Client::OnDeadLink() {
+        net::dispatch(connection_strand_, [self = this->shared_from_this()]() {
+            self->connection_->Abort();
+            });
+    }
+
+    void Client::NotifyConnectionState(bool is_connected) {
+        if (connection_state_handler_) {
+            connection_state_handler_(is_connected);
+        }
+    }
+
+    struct Client::ReplaySession {
+        ReplaySession(const std::string& path, ReplayPace pace, ReplayHandler&& handler, Strand& strand)
+            : reader(path)
+            , pace(pace)
+            , handler(std::move(handler))
+            , timer(strand)
+        {
+        }
+
+        connection::CaptureReader reader;
+        ReplayPace pace;
+        ReplayHandler handler;
+        net::steady_timer timer;
+        std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        std::optional<connection::CaptureChunk> pending;
+        // Streams of recorded connections are split into lines separately, like they were read
+        std::unordered_map<uint32_t, std::unique_ptr<connection::ReadBuffer>> buffers;
+        ReplayStats stats;
+    };
+
+    void Client::Replay(const std::string& path, ReplayPace pace, ReplayHandler handler) {
+        if (connection_->IsConnected()) {
+            throw std::runtime_error("Replay into connected client");
+        }
+        auto session = std::make_shared<ReplaySession>(path, pace, std::move(handler), read_strand_);
+        LOG_INFO("Replaying "s.append(path).append(", ").append(std::to_string(session->reader.GetSize())).append(" bytes"));
+        net::post(read_strand_, [self = this->shared_from_this(), session]() {
+            self->ContinueReplay(session);
+            });
+    }
+
+    // Runs on read_strand_. Chunks go in batches, so live handlers on the strand are not starved
+    void Client::ContinueReplay(std::shared_ptr<ReplaySession> session) {
+        try {
+            for (size_t i = 0; i < REPLAY_BATCH; ++i) {
+                if (!session->pending) {
+                    session->pending = session->reader.Next();
+                }
+                if (!session->pending) {
+                    FinishReplay(*session);
+                    return;
+                }
+                if (session->pace == ReplayPace::ORIGINAL) {
+                    const auto due = session->started + session->pending->at;
+                    if (due > std::chrono::steady_clock::now()) {
+                        session->timer.expires_at(due);
+                        session->timer.async_wait([self = this->shared_from_this(), session](const sys::error_code& ec) {
+                            if (!ec) {
+                                self->ContinueReplay(session);
+                            }
+                            });
+                        return;
+                    }
+                }
+                ReplayChunk(*session, *session->pending);
+                session->pending.reset();
+            }
+            net::post(read_strand_, [self = this->shared_from_this(), session]() {
+                self->ContinueReplay(session);
+                });
+        }
+        catch (const std::exception& e) {
+            LOG_INFO("Catch exception in Client::ContinueReplay");
+            LOG_CRITICAL(e.what());
+            FinishReplay(*session);
+        }
+    }
+
+    // Same steps as OnRead, handler is called in place so replay time covers the whole pipeline
+    void Client::ReplayChunk(ReplaySession& session, const connection::CaptureChunk& chunk) {
+        auto& buffer = session.buffers[chunk.source];
+        if (!buffer) {
+            buffer = std::make_unique<connection::ReadBuffer>();
+        }
+
+        std::string_view bytes = chunk.bytes;
+        while (!bytes.empty()) {
+            auto free = buffer->Prepare();
+            const size_t size = std::min(free.size(), bytes.size());
+            std::memcpy(free.data(), bytes.data(), size);
+            buffer->Commit(size);
+            bytes.remove_prefix(size);
+
+            size_t consumed = 0;
+            auto messages = message_processor_.GetMessagesFromRawBytes(buffer->Data(), consumed);
+            buffer->Consume(consumed);
+            auto it = std::remove_if(messages.begin(), messages.end(), [](const domain::Message& message) {
+                auto type = message.GetMessageType();
+                return type == domain::MessageType::PING || type == domain::MessageType::PONG
+                    || type == domain::MessageType::RECONNECT;
+                });
+            messages.erase(it, messages.end());
+            session.stats.messages += messages.size();
+            (*message_handler_)(std::move(messages));
+        }
+        ++session.stats.chunks;
+        session.stats.bytes += chunk.bytes.size();
+    }
+
+    void Client::FinishReplay(ReplaySession& session) {
+        session.stats.duration = std::chrono::steady_clock::now() - session.started;
+        LOG_INFO("Replay finished: "s.append(std::to_string(session.stats.chunks)).append(" chunks, ")
+            .append(std::to_string(session.stats.messages)).append(" messages"));
+        if (session.handler) {
+            session.handler(session.stats);
         }
     }
 
-}
\ No newline at end of file
+}
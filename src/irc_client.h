@@ -5,6 +5,9 @@
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -13,9 +16,14 @@
 
 #include "auth_data.h"
 #include "connection.h"
+#include "dedup_window.h"
+#include "join_scheduler.h"
+#include "keepalive.h"
 #include "chat_bot.h"
 #include "message_handler.h"
 #include "message_processor.h"
+#include "outbound_scheduler.h"
+#include "traffic_capture.h"
 
 
 
@@ -28,6 +36,21 @@ namespace irc {
     using namespace std::literals;
 
     using Strand = net::strand<net::io_context::executor_type>;
+    using ConnectionStateHandler = std::function<void(bool is_connected)>;
+
+    enum class ReplayPace {
+        ORIGINAL,   // chunks are fed with the delays they were received with
+        MAX_SPEED
+    };
+
+    struct ReplayStats {
+        size_t chunks = 0;
+        size_t bytes = 0;
+        size_t messages = 0;
+        std::chrono::nanoseconds duration{ 0 };
+    };
+
+    using ReplayHandler = std::function<void(const ReplayStats& stats)>;
 
     class Client : public std::enable_shared_from_this<Client> {
     public:
@@ -35,6 +58,8 @@ namespace irc {
         Client(net::io_context& ioc, std::shared_ptr<chat_bot::ChatBot> chat_bot, bool secured = true);
 
         void SetChatBot(std::shared_ptr<chat_bot::ChatBot> chat_bot);
+        // Called on connect and on every connection loss or failed connect attempt
+        void SetConnectionStateHandler(ConnectionStateHandler handler);
         void Connect();
         void Disconnect();
         void Join(const std::vector<std::string_view>& channels_names);
@@ -46,32 +71,110 @@ namespace irc {
         void CapRequest();
         void Read();
         bool CheckConnect();
+        // Outbound pacing per account type. Connections of one account should share one limiter
+        void SetRateLimits(const outbound::RateLimits& limits);
+        void SetRateLimiter(std::shared_ptr<outbound::RateLimiter> limiter);
+        outbound::OutboundStats GetOutboundStats() const;
+        void SetJoinConfig(const membership::JoinConfig& config);
+        membership::JoinStats GetJoinStats() const;
+        bool IsJoined(std::string_view channel_name) const;
+        void SetKeepaliveConfig(const keepalive::KeepaliveConfig& config);
+        keepalive::KeepaliveStats GetKeepaliveStats() const;
+        // Reconnect delay grows from initial to max with jitter, resets after a stable connection
+        void SetBackoffConfig(const keepalive::BackoffConfig& config);
+        keepalive::BackoffStats GetBackoffStats() const;
+        // Upper bound of reconnect backoff
         void SetReconnectTimeout(int timeout_seconds);
         int GetReconnectTimeout();
-        const std::unordered_set<std::string>& GetJoinedChannels();
+        // Channels we want to be in, confirmed or not
+        std::unordered_set<std::string> GetJoinedChannels();
+        // Longest overlap of old and new connection after server RECONNECT
+        void SetHandoverTimeout(std::chrono::milliseconds timeout);
+        size_t GetHandoversCount() const;
+        dedup::DedupStats GetDedupStats() const;
+        // Redundant reading: clients reading the same channels share a dedup window
+        void SetDedupWindow(std::shared_ptr<dedup::DedupWindow> window, size_t source);
+        void SetEndpointOffset(size_t offset);
+        // Stand-in server instead of Twitch, e.g. local mock for load tests. Call before Connect
+        void SetServer(std::string_view host, std::string_view port);
+        // Bytes received by current and every later connection are recorded to file. Call before Connect
+        void SetCaptureFile(const std::string& path);
+        std::optional<connection::CaptureStats> GetCaptureStats() const;
+        // Feeds recorded bytes through parser, handler and chat bot without network. PING, PONG and
+        // RECONNECT belong to the recorded link and are skipped. Client must not be connected.
+        // handler is called on read strand when the capture is over
+        void Replay(const std::string& path, ReplayPace pace, ReplayHandler handler);
 
     private:
+        // Second connection opened on server RECONNECT. It gets its own outbound and joins,
+        // reads in parallel with the current one and replaces it when all channels are joined
+        struct Handover {
+            std::shared_ptr<connection::Connection> connection;
+            std::shared_ptr<outbound::OutboundScheduler> outbound;
+            std::shared_ptr<membership::JoinScheduler> joins;
+        };
+
         Strand write_strand_;
         Strand read_strand_;
         Strand connection_strand_;
         std::shared_ptr<ssl::context> ctx_;
         net::steady_timer reconnect_timer_;
-        int reconnect_timeout_ = 30;
+        net::steady_timer handover_timer_;
+        // Turns chat dedup off once messages read from the replaced connection are handled
+        net::steady_timer dedup_timer_;
+        std::chrono::milliseconds handover_timeout_ = 30s;
+        std::shared_ptr<Handover> handover_;
+        // Read path decides by these whether a finished read belongs to current, standby or replaced connection
+        std::atomic<const connection::Connection*> active_connection_{ nullptr };
+        std::atomic<const Handover*> active_handover_{ nullptr };
+        std::atomic<size_t> handovers_{ 0 };
+        keepalive::Backoff backoff_;
+        std::atomic<keepalive::Clock::rep> connected_at_{ 0 };
 
         message_processor::MessageProcessor message_processor_;
         std::shared_ptr<connection::Connection> connection_;
+        std::shared_ptr<outbound::RateLimiter> rate_limiter_;
+        std::shared_ptr<outbound::OutboundScheduler> outbound_;
+        std::shared_ptr<membership::JoinScheduler> join_scheduler_;
+        std::shared_ptr<keepalive::Keepalive> keepalive_;
         std::shared_ptr<handler::MessageHandler> message_handler_;
 
+        bool secured_ = true;
+        std::string host_;
+        std::string port_;
+        size_t endpoint_offset_ = 0;
+        bool read_requested_ = false;
         bool authorized_ = false;
-        std::unordered_set<std::string> joined_channels_;
+        ConnectionStateHandler connection_state_handler_;
 
-        std::optional<std::string> join_command_buffer_;
         std::optional<std::string> auth_data_buffer_;
 
-        void OnRead(std::vector<char>&& bytes);
+        struct ReplaySession;
+        static constexpr size_t REPLAY_BATCH = 64;
+        static constexpr std::chrono::milliseconds HANDOVER_DEDUP_TAIL = 5s;
+
+        std::shared_ptr<connection::CaptureWriter> capture_;
+        uint32_t capture_sources_ = 0;
+
+        void OnConnect(const sys::error_code& ec);
+        void StartRead(std::shared_ptr<connection::Connection> connection, std::shared_ptr<Handover> handover = nullptr);
+        void OnRead(const std::shared_ptr<connection::Connection>& connection, const std::shared_ptr<Handover>& handover
+            , connection::ReadBuffer& buffer);
+        void OnConnectionLost();
         void Reconnect(bool secured = true);
-        std::string GetChannelNamesInStringCommand(std::vector<std::string_view> channels_names);
-        void AddJoinCommandToBuffer(std::string_view join_command);
+        std::shared_ptr<connection::Connection> MakeConnection();
+        std::string GetCapRequestLine() const;
+        void StartHandover();
+        void OnHandoverConnect(std::shared_ptr<Handover> handover, const sys::error_code& ec);
+        void FilterHandoverMessages(const Handover& handover, std::vector<domain::Message>& messages);
+        void CompleteHandover(std::shared_ptr<Handover> handover);
+        void DropHandover();
+        void FinishHandoverDedup();
+        void NotifyConnectionState(bool is_connected);
+        void OnDeadLink();
+        void ContinueReplay(std::shared_ptr<ReplaySession> session);
+        void ReplayChunk(ReplaySession& session, const connection::CaptureChunk& chunk);
+        void FinishReplay(ReplaySession& session);
     };
 
 
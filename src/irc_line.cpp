@@ -0,0 +1,70 @@
+#include "irc_line.h"
+
+#include <algorithm>
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        std::string_view IrcLine::GetParam(size_t index) const {
+            return index < params_count ? params[index] : std::string_view{};
+        }
+
+        std::string_view IrcLine::GetNick() const {
+            size_t bang = prefix.find('!');
+            return bang == std::string_view::npos ? std::string_view{} : prefix.substr(0, bang);
+        }
+
+        std::string_view IrcLine::GetLastParam() const {
+            if (has_trailing) {
+                return trailing;
+            }
+            return params_count > 0 ? params[params_count - 1] : std::string_view{};
+        }
+
+        IrcLine LineTokenizer::Tokenize(std::string_view line) {
+            IrcLine result;
+            size_t pos = 0;
+            const size_t size = line.size();
+
+            auto skip_spaces = [&]() {
+                while (pos < size && line[pos] == ' ') {
+                    ++pos;
+                }
+            };
+            // Tag block is most of the line, memchr crosses it faster than a byte loop
+            auto take_word = [&]() {
+                size_t begin = pos;
+                pos = std::min(line.find(' ', pos), size);
+                std::string_view word = line.substr(begin, pos - begin);
+                skip_spaces();
+                return word;
+            };
+
+            skip_spaces();
+            if (pos < size && line[pos] == '@') {
+                ++pos;
+                result.tags = take_word();
+            }
+            if (pos < size && line[pos] == ':') {
+                ++pos;
+                result.prefix = take_word();
+            }
+            result.command = take_word();
+
+            while (pos < size) {
+                if (line[pos] == ':' || result.params_count == IrcLine::MAX_MIDDLE_PARAMS) {
+                    pos += line[pos] == ':' ? 1 : 0;
+                    result.trailing = line.substr(pos);
+                    result.has_trailing = true;
+                    break;
+                }
+                result.params[result.params_count++] = take_word();
+            }
+            return result;
+        }
+
+    } // namespace message_processor
+
+} // namespace irc
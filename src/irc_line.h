@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "domain.h"
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        // [@tags] [:prefix] COMMAND [params...] [:trailing], every part is a view into the line
+        struct IrcLine {
+            // RFC 1459 allows 15 params, the last one may be trailing
+            static constexpr size_t MAX_MIDDLE_PARAMS = 14;
+
+            std::string_view tags;      // without '@'
+            std::string_view prefix;    // without ':'
+            std::string_view command;
+            std::array<std::string_view, MAX_MIDDLE_PARAMS> params{};
+            size_t params_count = 0;
+            std::string_view trailing;  // without ':'
+            bool has_trailing = false;
+
+            // Empty if there is no such middle param
+            std::string_view GetParam(size_t index) const;
+            // nick!user@host -> nick, server prefix has no '!' and gives empty nick
+            std::string_view GetNick() const;
+            // Trailing if present, otherwise last middle param
+            std::string_view GetLastParam() const;
+        };
+
+        struct CommandEntry {
+            std::string_view name;
+            domain::MessageType type;
+        };
+
+        // Commands the parser knows. Numerics are not listed, any three digit command is STATUSCODE
+        inline constexpr std::array COMMANDS{
+            CommandEntry{ domain::Command::PRIVMSG, domain::MessageType::PRIVMSG },
+            CommandEntry{ domain::Command::USERNOTICE, domain::MessageType::USERNOTICE },
+            CommandEntry{ domain::Command::JOIN, domain::MessageType::JOIN },
+            CommandEntry{ domain::Command::PART, domain::MessageType::PART },
+            CommandEntry{ domain::Command::PING, domain::MessageType::PING },
+            CommandEntry{ domain::Command::PONG, domain::MessageType::PONG },
+            CommandEntry{ domain::Command::ROOMSTATE, domain::MessageType::ROOMSTATE },
+            CommandEntry{ domain::Command::CLEARCHAT, domain::MessageType::CLEARCHAT },
+            CommandEntry{ domain::Command::RECONNECT, domain::MessageType::RECONNECT },
+            CommandEntry{ domain::Command::CRES, domain::MessageType::CAPRES },
+            CommandEntry{ domain::Command::CLEARMSG, domain::MessageType::CLEARMSG },
+            CommandEntry{ domain::Command::NOTICE, domain::MessageType::NOTICE },
+            CommandEntry{ domain::Command::USERSTATE, domain::MessageType::USERSTATE },
+            CommandEntry{ domain::Command::GLOBALUSERSTATE, domain::MessageType::GLOBALUSERSTATE },
+            CommandEntry{ domain::Command::WHISPER, domain::MessageType::WHISPER },
+            CommandEntry{ domain::Command::HOSTTARGET, domain::MessageType::HOSTTARGET },
+        };
+
+        constexpr size_t COMMAND_SLOTS = 64;
+
+        constexpr uint32_t HashCommand(std::string_view token, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (char ch : token) {
+                hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+            }
+            return hash ^ (hash >> 15);
+        }
+
+        // First seed that gives every entry of COMMANDS its own slot
+        constexpr uint32_t FindCommandSeed() {
+            for (uint32_t seed = 0; ; ++seed) {
+                std::array<bool, COMMAND_SLOTS> used{};
+                bool collision = false;
+                for (const auto& entry : COMMANDS) {
+                    auto slot = HashCommand(entry.name, seed) % COMMAND_SLOTS;
+                    collision = collision || used[slot];
+                    used[slot] = true;
+                }
+                if (!collision) {
+                    return seed;
+                }
+            }
+        }
+
+        constexpr std::array<int, COMMAND_SLOTS> MakeCommandSlots(uint32_t seed) {
+            std::array<int, COMMAND_SLOTS> slots{};
+            for (auto& slot : slots) {
+                slot = -1;
+            }
+            for (size_t i = 0; i < COMMANDS.size(); ++i) {
+                slots[HashCommand(COMMANDS[i].name, seed) % COMMAND_SLOTS] = static_cast<int>(i);
+            }
+            return slots;
+        }
+
+        // Perfect hash of command token: FNV-1a with a seed picked at compile time.
+        // Lookup is one hash and one string compare
+        class CommandTable {
+        public:
+            static constexpr uint32_t SEED = FindCommandSeed();
+            static constexpr std::array<int, COMMAND_SLOTS> SLOT_TO_COMMAND = MakeCommandSlots(SEED);
+
+            static constexpr domain::MessageType Classify(std::string_view command) {
+                if (command.size() == 3 && IsDigit(command[0]) && IsDigit(command[1]) && IsDigit(command[2])) {
+                    return domain::MessageType::STATUSCODE;
+                }
+                int index = SLOT_TO_COMMAND[HashCommand(command, SEED) % COMMAND_SLOTS];
+                if (index >= 0 && COMMANDS[index].name == command) {
+                    return COMMANDS[index].type;
+                }
+                return domain::MessageType::UNKNOWN;
+            }
+
+        private:
+            static constexpr bool IsDigit(char ch) {
+                return ch >= '0' && ch <= '9';
+            }
+        };
+
+        static_assert(CommandTable::Classify(domain::Command::PRIVMSG) == domain::MessageType::PRIVMSG);
+        static_assert(CommandTable::Classify("PRIVMS") == domain::MessageType::UNKNOWN);
+        static_assert(CommandTable::Classify("001") == domain::MessageType::STATUSCODE);
+
+        class LineTokenizer {
+        public:
+            // Single pass over the line, never allocates. Runs of spaces between parts are skipped
+            static IrcLine Tokenize(std::string_view line);
+        };
+
+    } // namespace message_processor
+
+} // namespace irc
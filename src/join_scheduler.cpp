@@ -0,0 +1,361 @@
+#include "join_scheduler.h"
+
+#include "logging.h"
+
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+
+namespace irc {
+
+    namespace membership {
+
+        JoinScheduler::JoinScheduler(net::io_context& ioc, std::shared_ptr<outbound::OutboundScheduler> outbound)
+            : ioc_(ioc)
+            , outbound_(outbound)
+            , ack_timer_(ioc)
+        {
+        }
+
+        JoinScheduler::~JoinScheduler() {
+            auto& channels = domain::StringInterner::Channels();
+            for (const auto& [id, _] : channels_) {
+                channels.Unpin(id);
+            }
+            domain::StringInterner::Users().Unpin(nick_id_);
+        }
+
+        void JoinScheduler::SetConfig(const JoinConfig& config) {
+            std::lock_guard lock(mutex_);
+            config_ = config;
+        }
+
+        void JoinScheduler::SetNick(std::string_view nick) {
+            std::lock_guard lock(mutex_);
+            nick_ = Normalize(nick);
+            auto& users = domain::StringInterner::Users();
+            users.Unpin(nick_id_);
+            nick_id_ = users.Pin(nick_);
+        }
+
+        void JoinScheduler::Join(std::string_view channel_name) {
+            std::lock_guard lock(mutex_);
+            std::string name = Normalize(channel_name);
+            const domain::NameId id = domain::StringInterner::Channels().Pin(name);
+            auto [it, inserted] = channels_.try_emplace(id);
+            if (inserted) {
+                it->second.name = std::move(name);
+            }
+            else {
+                domain::StringInterner::Channels().Unpin(id);
+                if (it->second.state != ChannelState::PARTING) {
+                    return;
+                }
+            }
+            MakePending(it->first, it->second);
+            ScheduleFlush();
+        }
+
+        void JoinScheduler::Part(std::string_view channel_name) {
+            std::lock_guard lock(mutex_);
+            auto it = channels_.find(domain::StringInterner::Channels().Find(Normalize(channel_name)));
+            if (it == channels_.end() || it->second.state == ChannelState::PARTING) {
+                return;
+            }
+            if (it->second.state == ChannelState::PENDING) {
+                // Never sent - nothing to leave
+                EraseChannel(it);
+                return;
+            }
+            it->second.state = ChannelState::PARTING;
+            it->second.sent_at = Clock::now();
+            outbound_->Send(outbound::Priority::MEMBERSHIP
+                , std::string(domain::Command::PART_CHANNEL).append(it->second.name).append("\r\n"));
+            ArmAckTimer();
+        }
+
+        void JoinScheduler::Rejoin() {
+            std::lock_guard lock(mutex_);
+            for (auto it = channels_.begin(); it != channels_.end();) {
+                if (it->second.state == ChannelState::PARTING) {
+                    it = EraseChannel(it);
+                    continue;
+                }
+                if (it->second.state != ChannelState::PENDING) {
+                    MakePending(it->first, it->second);
+                }
+                ++it;
+            }
+            ScheduleFlush();
+        }
+
+        std::shared_ptr<JoinScheduler> JoinScheduler::Fork(std::shared_ptr<outbound::OutboundScheduler> outbound) const {
+            auto standby = std::make_shared<JoinScheduler>(ioc_, outbound);
+            std::lock_guard lock(mutex_);
+            standby->config_ = config_;
+            standby->nick_ = nick_;
+            // Own pin, standby recognizes its JOIN echoes and unpins on destruction
+            standby->nick_id_ = domain::StringInterner::Users().Pin(nick_);
+            for (const auto& [_, channel] : channels_) {
+                if (channel.state != ChannelState::PARTING) {
+                    standby->Join(channel.name);
+                }
+            }
+            return standby;
+        }
+
+        void JoinScheduler::TakeOver(const JoinScheduler& standby) {
+            std::lock_guard lock(mutex_);
+            for (auto it = channels_.begin(); it != channels_.end();) {
+                if (it->second.state == ChannelState::PARTING) {
+                    // Never asked on new connection
+                    it = EraseChannel(it);
+                    continue;
+                }
+                if (standby.IsJoined(it->first)) {
+                    it->second.state = ChannelState::JOINED;
+                    it->second.sent_at = Clock::time_point::max();
+                }
+                else {
+                    MakePending(it->first, it->second);
+                }
+                ++it;
+            }
+            if (!pending_.empty()) {
+                ScheduleFlush();
+            }
+        }
+
+        bool JoinScheduler::IsSettled() const {
+            std::lock_guard lock(mutex_);
+            return std::all_of(channels_.begin(), channels_.end(), [](const auto& entry) {
+                return entry.second.state == ChannelState::JOINED;
+                });
+        }
+
+        void JoinScheduler::OnMembership(domain::MessageType type, domain::NameId login, domain::NameId channel) {
+            std::lock_guard lock(mutex_);
+            if (nick_id_ == domain::NO_NAME || login != nick_id_) {
+                return;
+            }
+
+            auto it = channels_.find(channel);
+            if (it == channels_.end()) {
+                return;
+            }
+            if (type == domain::MessageType::JOIN && it->second.state == ChannelState::JOINING) {
+                it->second.state = ChannelState::JOINED;
+            }
+            else if (type == domain::MessageType::PART && it->second.state == ChannelState::PARTING) {
+                EraseChannel(it);
+            }
+        }
+
+        bool JoinScheduler::IsJoined(std::string_view channel_name) const {
+            if (!channel_name.empty() && channel_name[0] == '#') {
+                channel_name.remove_prefix(1);
+            }
+            return IsJoined(domain::StringInterner::Channels().Find(channel_name));
+        }
+
+        bool JoinScheduler::IsJoined(domain::NameId channel) const {
+            std::lock_guard lock(mutex_);
+            auto it = channels_.find(channel);
+            return it != channels_.end() && it->second.state == ChannelState::JOINED;
+        }
+
+        std::unordered_set<std::string> JoinScheduler::GetChannels() const {
+            std::lock_guard lock(mutex_);
+            std::unordered_set<std::string> result;
+            for (const auto& [_, channel] : channels_) {
+                if (channel.state != ChannelState::PARTING) {
+                    result.insert(channel.name);
+                }
+            }
+            return result;
+        }
+
+        JoinStats JoinScheduler::GetStats() const {
+            std::lock_guard lock(mutex_);
+            JoinStats stats;
+            for (const auto& [_, channel] : channels_) {
+                switch (channel.state) {
+                case ChannelState::PENDING:
+                    ++stats.pending;
+                    break;
+                case ChannelState::JOINING:
+                    ++stats.joining;
+                    break;
+                case ChannelState::JOINED:
+                    ++stats.joined;
+                    break;
+                case ChannelState::PARTING:
+                    ++stats.parting;
+                    break;
+                }
+            }
+            stats.batches = batches_;
+            stats.retries = retries_;
+            return stats;
+        }
+
+        // mutex_ must be held
+        void JoinScheduler::MakePending(domain::NameId id, Channel& channel) {
+            channel.state = ChannelState::PENDING;
+            channel.sent_at = Clock::time_point::max();
+            pending_.push_back(id);
+        }
+
+        // mutex_ must be held
+        std::unordered_map<domain::NameId, JoinScheduler::Channel>::iterator JoinScheduler::EraseChannel(
+            std::unordered_map<domain::NameId, Channel>::iterator it) {
+            domain::StringInterner::Channels().Unpin(it->first);
+            return channels_.erase(it);
+        }
+
+        // mutex_ must be held. Joins of one handler run end up in one flush and share batches
+        void JoinScheduler::ScheduleFlush() {
+            if (flush_scheduled_) {
+                return;
+            }
+            flush_scheduled_ = true;
+            net::post(ioc_, [self = this->shared_from_this()]() {
+                self->Flush();
+                });
+        }
+
+        void JoinScheduler::Flush() {
+            std::lock_guard lock(mutex_);
+            flush_scheduled_ = false;
+
+            constexpr size_t CRLF_SIZE = 2;
+            const size_t max_channels = std::max<size_t>(config_.max_channels_per_batch, 1);
+            std::string line;
+            std::vector<domain::NameId> batch;
+
+            while (!pending_.empty()) {
+                const domain::NameId id = pending_.front();
+                pending_.pop_front();
+                auto it = channels_.find(id);
+                // Stale entry: parted or already batched
+                if (it == channels_.end() || it->second.state != ChannelState::PENDING) {
+                    continue;
+                }
+
+                const std::string& name = it->second.name;
+                const size_t added_size = batch.empty()
+                    ? domain::Command::JOIN_CHANNEL.size() + name.size()
+                    : ",#"sv.size() + name.size();
+                if (!batch.empty() && (line.size() + added_size + CRLF_SIZE > config_.max_line_size
+                    || batch.size() == max_channels)) {
+                    SendBatch(std::move(line), std::move(batch));
+                    line.clear();
+                    batch.clear();
+                }
+
+                line.append(batch.empty() ? domain::Command::JOIN_CHANNEL : ",#"sv).append(name);
+                batch.push_back(id);
+                it->second.state = ChannelState::JOINING;
+            }
+
+            if (!batch.empty()) {
+                SendBatch(std::move(line), std::move(batch));
+            }
+        }
+
+        // mutex_ must be held
+        void JoinScheduler::SendBatch(std::string&& line, std::vector<domain::NameId>&& batch) {
+            ++batches_;
+            const size_t cost = batch.size();
+            outbound_->Send(outbound::Priority::MEMBERSHIP, line.append("\r\n"), cost
+                , [weak_self = this->weak_from_this(), batch = std::move(batch)]() {
+                    if (auto self = weak_self.lock()) {
+                        self->OnBatchSent(batch);
+                    }
+                });
+        }
+
+        // Ack timeout counts from the moment rate limiter let batch go, not from queueing
+        void JoinScheduler::OnBatchSent(const std::vector<domain::NameId>& batch) {
+            std::lock_guard lock(mutex_);
+            const auto now = Clock::now();
+            for (const auto id : batch) {
+                if (auto it = channels_.find(id); it != channels_.end() && it->second.state == ChannelState::JOINING) {
+                    it->second.sent_at = now;
+                }
+            }
+            ArmAckTimer();
+        }
+
+        // mutex_ must be held
+        void JoinScheduler::ArmAckTimer() {
+            if (ack_timer_armed_) {
+                return;
+            }
+            ack_timer_armed_ = true;
+            ack_timer_.expires_after(config_.ack_timeout / 2);
+            ack_timer_.async_wait([weak_self = this->weak_from_this()](const sys::error_code& ec) {
+                if (ec) {
+                    return;
+                }
+                if (auto self = weak_self.lock()) {
+                    self->CheckAcks();
+                }
+                });
+        }
+
+        void JoinScheduler::CheckAcks() {
+            std::lock_guard lock(mutex_);
+            ack_timer_armed_ = false;
+
+            const auto now = Clock::now();
+            size_t missing = 0;
+            bool waiting = false;
+            for (auto it = channels_.begin(); it != channels_.end();) {
+                auto& channel = it->second;
+                const bool expired = channel.sent_at != Clock::time_point::max() && now - channel.sent_at >= config_.ack_timeout;
+                if (channel.state == ChannelState::JOINING) {
+                    if (expired) {
+                        MakePending(it->first, channel);
+                        ++missing;
+                    }
+                    else {
+                        waiting = true;
+                    }
+                }
+                else if (channel.state == ChannelState::PARTING) {
+                    if (expired) {
+                        it = EraseChannel(it);
+                        continue;
+                    }
+                    waiting = true;
+                }
+                ++it;
+            }
+
+            if (missing > 0) {
+                retries_ += missing;
+                LOG_WARN("No JOIN echo for "s.append(std::to_string(missing)).append(" channels, joining again"));
+                ScheduleFlush();
+            }
+            if (waiting) {
+                ArmAckTimer();
+            }
+        }
+
+        std::string JoinScheduler::Normalize(std::string_view channel_name) {
+            if (!channel_name.empty() && channel_name[0] == '#') {
+                channel_name.remove_prefix(1);
+            }
+            std::string result(channel_name);
+            std::transform(result.begin(), result.end(), result.begin(), [](unsigned char ch) {
+                return static_cast<char>(std::tolower(ch));
+                });
+            return result;
+        }
+
+    } // namespace membership
+
+} // namespace irc
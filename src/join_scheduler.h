@@ -0,0 +1,122 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "domain.h"
+#include "outbound_scheduler.h"
+#include "string_interner.h"
+
+
+namespace irc {
+
+    namespace membership {
+
+        namespace net = boost::asio;
+        namespace sys = boost::system;
+        using Clock = std::chrono::steady_clock;
+        using namespace std::literals;
+
+        struct JoinConfig {
+            size_t max_line_size = 512; // IRC limit with CRLF
+            size_t max_channels_per_batch = 20;
+            std::chrono::milliseconds ack_timeout = 30s;
+        };
+
+        enum class ChannelState {
+            PENDING,
+            JOINING,
+            JOINED,
+            PARTING
+        };
+
+        struct JoinStats {
+            size_t pending = 0;
+            size_t joining = 0;
+            size_t joined = 0;
+            size_t parting = 0;
+            size_t batches = 0;
+            size_t retries = 0;
+        };
+
+        // Registry of wanted channels of one connection. Joins are packed into JOIN lines below line limit,
+        // paced by MEMBERSHIP bucket of outbound scheduler and confirmed by server echo of our own JOIN.
+        // Channels without echo in ack_timeout and all channels after reconnect are joined again.
+        // Channels are kept by interned id and pinned in interner while wanted
+        class JoinScheduler : public std::enable_shared_from_this<JoinScheduler> {
+        public:
+            JoinScheduler(net::io_context& ioc, std::shared_ptr<outbound::OutboundScheduler> outbound);
+            ~JoinScheduler();
+
+            void SetConfig(const JoinConfig& config);
+            void SetNick(std::string_view nick);
+
+            void Join(std::string_view channel_name);
+            void Part(std::string_view channel_name);
+            // New connection has no channels: everything wanted goes back to pending
+            void Rejoin();
+
+            // Scheduler for a second connection of the same account: same config and nick,
+            // every wanted channel pending on it
+            std::shared_ptr<JoinScheduler> Fork(std::shared_ptr<outbound::OutboundScheduler> outbound) const;
+            // Connection of standby became ours: its confirmed channels are joined,
+            // the rest is joined again over our outbound
+            void TakeOver(const JoinScheduler& standby);
+            // Nothing pending or waiting for echo
+            bool IsSettled() const;
+
+            // JOIN / PART echo from server, ids of message login and channel
+            void OnMembership(domain::MessageType type, domain::NameId login, domain::NameId channel);
+
+            bool IsJoined(std::string_view channel_name) const;
+            bool IsJoined(domain::NameId channel) const;
+            std::unordered_set<std::string> GetChannels() const;
+            JoinStats GetStats() const;
+
+        private:
+            struct Channel {
+                std::string name;
+                ChannelState state = ChannelState::PENDING;
+                Clock::time_point sent_at = Clock::time_point::max();
+            };
+
+            net::io_context& ioc_;
+            std::shared_ptr<outbound::OutboundScheduler> outbound_;
+
+            mutable std::mutex mutex_;
+            net::steady_timer ack_timer_;
+            bool ack_timer_armed_ = false;
+            bool flush_scheduled_ = false;
+            JoinConfig config_;
+            std::string nick_;
+            domain::NameId nick_id_ = domain::NO_NAME;
+            std::unordered_map<domain::NameId, Channel> channels_;
+            std::deque<domain::NameId> pending_;
+            size_t batches_ = 0;
+            size_t retries_ = 0;
+
+            void MakePending(domain::NameId id, Channel& channel);
+            std::unordered_map<domain::NameId, Channel>::iterator EraseChannel(std::unordered_map<domain::NameId, Channel>::iterator it);
+            void ScheduleFlush();
+            void Flush();
+            void SendBatch(std::string&& line, std::vector<domain::NameId>&& batch);
+            void OnBatchSent(const std::vector<domain::NameId>& batch);
+            void ArmAckTimer();
+            void CheckAcks();
+
+            static std::string Normalize(std::string_view channel_name);
+        };
+
+    } // namespace membership
+
+} // namespace irc
@@ -0,0 +1,227 @@
+#include "keepalive.h"
+
+#include "logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+
+namespace irc {
+
+    namespace keepalive {
+
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::milliseconds;
+
+        Keepalive::Keepalive(net::io_context& ioc, std::shared_ptr<outbound::OutboundScheduler> outbound)
+            : strand_(net::make_strand(ioc))
+            , timer_(strand_)
+            , outbound_(outbound)
+        {
+        }
+
+        void Keepalive::SetConfig(const KeepaliveConfig& config) {
+            net::dispatch(strand_, [self = this->shared_from_this(), config]() {
+                self->config_ = config;
+                });
+        }
+
+        void Keepalive::SetDeadLinkHandler(DeadLinkHandler handler) {
+            net::dispatch(strand_, [self = this->shared_from_this(), handler = std::move(handler)]() mutable {
+                self->dead_link_handler_ = std::move(handler);
+                });
+        }
+
+        void Keepalive::Start() {
+            OnActivity();
+            net::dispatch(strand_, [self = this->shared_from_this()]() {
+                self->running_ = true;
+                ++self->generation_;
+                self->outstanding_ping_.reset();
+                self->Arm(self->GetLastActivity() + self->config_.idle_interval);
+                });
+        }
+
+        void Keepalive::Stop() {
+            net::dispatch(strand_, [self = this->shared_from_this()]() {
+                self->running_ = false;
+                ++self->generation_;
+                self->outstanding_ping_.reset();
+                self->timer_.cancel();
+                });
+        }
+
+        void Keepalive::OnActivity() {
+            last_activity_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        void Keepalive::OnPong(std::string_view token) {
+            const auto received_at = Clock::now();
+            if (token.substr(0, TOKEN_PREFIX.size()) != TOKEN_PREFIX) {
+                return;
+            }
+            token.remove_prefix(TOKEN_PREFIX.size());
+            uint64_t sequence = 0;
+            auto [_, ec] = std::from_chars(token.data(), token.data() + token.size(), sequence);
+            if (ec != std::errc{}) {
+                return;
+            }
+
+            net::dispatch(strand_, [self = this->shared_from_this(), sequence, received_at]() {
+                if (self->outstanding_ping_ != sequence) {
+                    return; // Late answer to ping of previous connection
+                }
+                self->outstanding_ping_.reset();
+                ++self->pongs_received_;
+                self->RecordRtt(received_at - self->ping_sent_at_);
+                });
+        }
+
+        KeepaliveStats Keepalive::GetStats() const {
+            KeepaliveStats stats;
+            stats.pings_sent = pings_sent_.load(std::memory_order_relaxed);
+            stats.pongs_received = pongs_received_.load(std::memory_order_relaxed);
+            stats.dead_links = dead_links_.load(std::memory_order_relaxed);
+            stats.last_rtt = microseconds(last_rtt_us_.load(std::memory_order_relaxed));
+            stats.min_rtt = microseconds(min_rtt_us_.load(std::memory_order_relaxed));
+            stats.max_rtt = microseconds(max_rtt_us_.load(std::memory_order_relaxed));
+            stats.smoothed_rtt = microseconds(smoothed_rtt_us_.load(std::memory_order_relaxed));
+            return stats;
+        }
+
+        // Activity doesn't touch the timer: on wake up we look at the last activity and sleep again
+        void Keepalive::Arm(Clock::time_point deadline) {
+            timer_.expires_at(deadline);
+            timer_.async_wait([self = this->shared_from_this(), generation = generation_](const sys::error_code& ec) {
+                if (ec) {
+                    return;
+                }
+                self->OnTimer(generation);
+                });
+        }
+
+        void Keepalive::OnTimer(uint64_t generation) {
+            if (!running_ || generation != generation_) {
+                return;
+            }
+
+            const auto now = Clock::now();
+            const auto last_activity = GetLastActivity();
+            const auto silence = now - last_activity;
+
+            if (silence >= config_.dead_after) {
+                running_ = false;
+                ++dead_links_;
+                LOG_WARN("No data from server for "s.append(std::to_string(duration_cast<milliseconds>(silence).count()))
+                    .append(" ms, link is dead"));
+                if (dead_link_handler_) {
+                    dead_link_handler_();
+                }
+                return;
+            }
+
+            if (silence >= config_.idle_interval && !outstanding_ping_) {
+                SendPing();
+            }
+
+            // Data arrived after ping was sent: link is alive, ping will be answered or forgotten
+            if (outstanding_ping_ && last_activity > ping_sent_at_ && silence < config_.idle_interval) {
+                outstanding_ping_.reset();
+            }
+
+            const auto next = outstanding_ping_ || silence >= config_.idle_interval
+                ? last_activity + config_.dead_after
+                : last_activity + config_.idle_interval;
+            Arm(std::max(next, now + 1ms));
+        }
+
+        void Keepalive::SendPing() {
+            const uint64_t sequence = ++ping_sequence_;
+            outstanding_ping_ = sequence;
+            ping_sent_at_ = Clock::now();
+            ++pings_sent_;
+
+            std::string line = std::string(domain::Command::PING).append(" :");
+            line.append(TOKEN_PREFIX).append(std::to_string(sequence)).append("\r\n");
+            // Control lines share the unlimited class with PONG. RTT counts from the moment line leaves the limiter
+            outbound_->Send(outbound::Priority::PONG, std::move(line), 1
+                , [weak_self = this->weak_from_this(), sequence]() {
+                    if (auto self = weak_self.lock()) {
+                        const auto sent_at = Clock::now();
+                        net::dispatch(self->strand_, [self, sequence, sent_at]() {
+                            if (self->outstanding_ping_ == sequence) {
+                                self->ping_sent_at_ = sent_at;
+                            }
+                            });
+                    }
+                });
+        }
+
+        void Keepalive::RecordRtt(Clock::duration rtt) {
+            const int64_t rtt_us = std::max<int64_t>(duration_cast<microseconds>(rtt).count(), 0);
+            last_rtt_us_.store(rtt_us, std::memory_order_relaxed);
+
+            const int64_t min_rtt = min_rtt_us_.load(std::memory_order_relaxed);
+            if (min_rtt == 0 || rtt_us < min_rtt) {
+                min_rtt_us_.store(rtt_us, std::memory_order_relaxed);
+            }
+            if (rtt_us > max_rtt_us_.load(std::memory_order_relaxed)) {
+                max_rtt_us_.store(rtt_us, std::memory_order_relaxed);
+            }
+
+            const int64_t smoothed = smoothed_rtt_us_.load(std::memory_order_relaxed);
+            smoothed_rtt_us_.store(smoothed == 0 ? rtt_us : smoothed + (rtt_us - smoothed) / 8, std::memory_order_relaxed);
+        }
+
+        Clock::time_point Keepalive::GetLastActivity() const {
+            return Clock::time_point(Clock::duration(last_activity_.load(std::memory_order_relaxed)));
+        }
+
+        Backoff::Backoff(const BackoffConfig& config)
+            : config_(config)
+            , random_(std::random_device{}())
+        {
+        }
+
+        void Backoff::SetConfig(const BackoffConfig& config) {
+            std::lock_guard lock(mutex_);
+            config_ = config;
+        }
+
+        BackoffConfig Backoff::GetConfig() const {
+            std::lock_guard lock(mutex_);
+            return config_;
+        }
+
+        std::chrono::milliseconds Backoff::NextDelay() {
+            std::lock_guard lock(mutex_);
+            const double max_ms = static_cast<double>(config_.max.count());
+            const double step_ms = std::min(max_ms
+                , config_.initial.count() * std::pow(std::max(config_.multiplier, 1.0), static_cast<double>(attempts_)));
+
+            std::uniform_real_distribution<double> jitter(0.0, step_ms / 2);
+            last_delay_ = milliseconds(static_cast<int64_t>(step_ms / 2 + jitter(random_)));
+            ++attempts_;
+            ++total_attempts_;
+            return last_delay_;
+        }
+
+        void Backoff::Reset() {
+            std::lock_guard lock(mutex_);
+            attempts_ = 0;
+        }
+
+        BackoffStats Backoff::GetStats() const {
+            std::lock_guard lock(mutex_);
+            return { attempts_, total_attempts_, last_delay_ };
+        }
+
+    } // namespace keepalive
+
+} // namespace irc
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "domain.h"
+#include "outbound_scheduler.h"
+
+
+namespace irc {
+
+    namespace keepalive {
+
+        namespace net = boost::asio;
+        namespace sys = boost::system;
+        using Clock = std::chrono::steady_clock;
+        using Strand = net::strand<net::io_context::executor_type>;
+        using namespace std::literals;
+
+        struct KeepaliveConfig {
+            // Silence after which we send our own PING
+            std::chrono::milliseconds idle_interval = 60s;
+            // Silence after which the link is declared dead. Twitch itself pings every ~5 minutes
+            std::chrono::milliseconds dead_after = 90s;
+        };
+
+        struct KeepaliveStats {
+            size_t pings_sent = 0;
+            size_t pongs_received = 0;
+            size_t dead_links = 0;
+            std::chrono::microseconds last_rtt{};
+            std::chrono::microseconds min_rtt{};
+            std::chrono::microseconds max_rtt{};
+            // Exponentially weighted, 1/8 per sample as in TCP SRTT
+            std::chrono::microseconds smoothed_rtt{};
+        };
+
+        using DeadLinkHandler = std::function<void()>;
+
+        // Watches inbound silence of one connection. Every received chunk counts as activity.
+        // After idle_interval of silence sends "PING :<token>" and measures RTT by matching PONG,
+        // after dead_after of silence calls the dead link handler once and stops until next Start.
+        class Keepalive : public std::enable_shared_from_this<Keepalive> {
+        public:
+            Keepalive(net::io_context& ioc, std::shared_ptr<outbound::OutboundScheduler> outbound);
+
+            void SetConfig(const KeepaliveConfig& config);
+            void SetDeadLinkHandler(DeadLinkHandler handler);
+
+            void Start();
+            void Stop();
+
+            // Any inbound bytes. Called on the read path, lock-free
+            void OnActivity();
+            void OnPong(std::string_view token);
+
+            KeepaliveStats GetStats() const;
+
+        private:
+            Strand strand_;
+            net::steady_timer timer_;
+            std::shared_ptr<outbound::OutboundScheduler> outbound_;
+            KeepaliveConfig config_;
+            DeadLinkHandler dead_link_handler_;
+
+            std::atomic<Clock::rep> last_activity_{ 0 };
+            bool running_ = false;
+            uint64_t generation_ = 0;
+            uint64_t ping_sequence_ = 0;
+            std::optional<uint64_t> outstanding_ping_;
+            Clock::time_point ping_sent_at_{};
+
+            std::atomic<size_t> pings_sent_{ 0 };
+            std::atomic<size_t> pongs_received_{ 0 };
+            std::atomic<size_t> dead_links_{ 0 };
+            std::atomic<int64_t> last_rtt_us_{ 0 };
+            std::atomic<int64_t> min_rtt_us_{ 0 };
+            std::atomic<int64_t> max_rtt_us_{ 0 };
+            std::atomic<int64_t> smoothed_rtt_us_{ 0 };
+
+            void Arm(Clock::time_point deadline);
+            void OnTimer(uint64_t generation);
+            void SendPing();
+            void RecordRtt(Clock::duration rtt);
+            Clock::time_point GetLastActivity() const;
+
+            static constexpr std::string_view TOKEN_PREFIX = "keepalive-"sv;
+        };
+
+        struct BackoffConfig {
+            std::chrono::milliseconds initial = 1s;
+            std::chrono::milliseconds max = 30s;
+            double multiplier = 2.0;
+            // Connection that lived that long resets the backoff
+            std::chrono::milliseconds stable_after = 60s;
+        };
+
+        struct BackoffStats {
+            size_t attempts = 0;
+            size_t total_attempts = 0;
+            std::chrono::milliseconds last_delay{};
+        };
+
+        // Exponential reconnect delay with equal jitter: half of the current step is fixed,
+        // the other half is random, so clients dropped together don't come back together
+        class Backoff {
+        public:
+            explicit Backoff(const BackoffConfig& config = {});
+
+            void SetConfig(const BackoffConfig& config);
+            BackoffConfig GetConfig() const;
+
+            std::chrono::milliseconds NextDelay();
+            void Reset();
+
+            BackoffStats GetStats() const;
+
+        private:
+            mutable std::mutex mutex_;
+            BackoffConfig config_;
+            std::mt19937_64 random_;
+            size_t attempts_ = 0;
+            size_t total_attempts_ = 0;
+            std::chrono::milliseconds last_delay_{};
+        };
+
+    } // namespace keepalive
+
+} // namespace irc
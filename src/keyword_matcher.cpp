@@ -0,0 +1,123 @@
+#include "keyword_matcher.h"
+
+#include <stdexcept>
+
+
+namespace commands {
+
+    namespace {
+
+        unsigned char ToLower(char ch) {
+            return static_cast<unsigned char>(ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch);
+        }
+
+    } // namespace
+
+    void KeywordMatcher::Add(std::string_view keyword, uint32_t value) {
+        if (keyword.empty()) {
+            throw std::invalid_argument("Keyword is empty");
+        }
+        keywords_.emplace_back(std::string(keyword), value);
+    }
+
+    void KeywordMatcher::Clear() {
+        keywords_.clear();
+        Build();
+    }
+
+    void KeywordMatcher::Build() {
+        classes_.fill(0);
+        classes_count_ = 1;
+        transitions_.clear();
+        outputs_begin_.clear();
+        outputs_.clear();
+        if (keywords_.empty()) {
+            return;
+        }
+
+        for (const auto& [keyword, value] : keywords_) {
+            for (char ch : keyword) {
+                uint32_t& cls = classes_[ToLower(ch)];
+                if (cls == 0) {
+                    cls = classes_count_++;
+                }
+            }
+        }
+        for (char ch = 'A'; ch <= 'Z'; ++ch) {
+            classes_[static_cast<unsigned char>(ch)] = classes_[ToLower(ch)];
+        }
+
+        // Trie of keywords, 0 stands for missing edge: root is never a child
+        const uint32_t width = classes_count_;
+        std::vector<uint32_t> next(width, 0);
+        std::vector<std::vector<uint32_t>> own_outputs(1);
+        for (const auto& [keyword, value] : keywords_) {
+            uint32_t state = 0;
+            for (char ch : keyword) {
+                uint32_t& child = next[state * width + classes_[static_cast<unsigned char>(ch)]];
+                if (child == 0) {
+                    child = static_cast<uint32_t>(own_outputs.size());
+                    own_outputs.emplace_back();
+                    next.resize(next.size() + width, 0);
+                }
+                // next may be reallocated above, read the edge again
+                state = next[state * width + classes_[static_cast<unsigned char>(ch)]];
+            }
+            own_outputs[state].push_back(value);
+        }
+        const size_t states_count = own_outputs.size();
+        if (states_count * width >= OUTPUT_FLAG) {
+            throw std::length_error("Too many keywords");
+        }
+
+        // Breadth first: failure link of a state is known before its children. Missing edges are
+        // replaced with edges of the failure state, which turns the trie into DFA
+        std::vector<uint32_t> fail(states_count, 0);
+        std::vector<uint32_t> order;
+        order.reserve(states_count);
+        order.push_back(0);
+        for (size_t i = 0; i < order.size(); ++i) {
+            const uint32_t state = order[i];
+            for (uint32_t cls = 0; cls < width; ++cls) {
+                uint32_t& edge = next[state * width + cls];
+                if (edge != 0) {
+                    fail[edge] = state == 0 ? 0 : next[fail[state] * width + cls];
+                    order.push_back(edge);
+                }
+                else if (state != 0) {
+                    edge = next[fail[state] * width + cls];
+                }
+            }
+        }
+
+        // Outputs of failure state are complete before the state itself
+        std::vector<std::vector<uint32_t>> merged(states_count);
+        for (uint32_t state : order) {
+            merged[state] = std::move(own_outputs[state]);
+            if (state != 0) {
+                merged[state].insert(merged[state].end(), merged[fail[state]].begin(), merged[fail[state]].end());
+            }
+        }
+        outputs_begin_.reserve(states_count + 1);
+        for (const auto& values : merged) {
+            outputs_begin_.push_back(static_cast<uint32_t>(outputs_.size()));
+            outputs_.insert(outputs_.end(), values.begin(), values.end());
+        }
+        outputs_begin_.push_back(static_cast<uint32_t>(outputs_.size()));
+
+        transitions_.resize(next.size());
+        for (size_t i = 0; i < next.size(); ++i) {
+            const uint32_t target = next[i];
+            transitions_[i] = target * width | (merged[target].empty() ? 0 : OUTPUT_FLAG);
+        }
+    }
+
+    size_t KeywordMatcher::GetKeywordsCount() const {
+        return keywords_.size();
+    }
+
+    size_t KeywordMatcher::GetStatesCount() const {
+        return classes_count_ == 0 ? 0 : transitions_.size() / classes_count_;
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace commands {
+
+    // Finds all keywords in text in one pass (Aho-Corasick), ASCII case-insensitive. Keywords are
+    // compiled by Build into a DFA over classes of bytes that occur in them: one row of next states
+    // per state, so every byte of text costs one table load. Keywords match anywhere, also inside
+    // words. Changed while configuring, Scan is read only and safe from several threads
+    class KeywordMatcher {
+    public:
+        // Throws std::invalid_argument for empty keyword. Takes effect after Build
+        void Add(std::string_view keyword, uint32_t value);
+        void Clear();
+        // Compiles all added keywords from scratch
+        void Build();
+
+        size_t GetKeywordsCount() const;
+        size_t GetStatesCount() const;
+
+        // Calls fn(value) for every occurrence of every keyword, a value can come several times
+        template <typename Fn>
+        void Scan(std::string_view text, Fn&& fn) const {
+            if (transitions_.empty()) {
+                return;
+            }
+            uint32_t state = 0;
+            for (char ch : text) {
+                const uint32_t next = transitions_[state + classes_[static_cast<unsigned char>(ch)]];
+                state = next & ~OUTPUT_FLAG;
+                if (next & OUTPUT_FLAG) {
+                    const uint32_t row = state / classes_count_;
+                    for (uint32_t i = outputs_begin_[row]; i < outputs_begin_[row + 1]; ++i) {
+                        fn(outputs_[i]);
+                    }
+                }
+            }
+        }
+
+    private:
+        // Set in transition when the target state ends some keyword
+        static constexpr uint32_t OUTPUT_FLAG = 1u << 31;
+
+        std::vector<std::pair<std::string, uint32_t>> keywords_;
+
+        // Class of every byte, 0 for bytes absent in keywords
+        std::array<uint32_t, 256> classes_{};
+        uint32_t classes_count_ = 0;
+        // classes_count_ next states per state, stored premultiplied by classes_count_
+        std::vector<uint32_t> transitions_;
+        // Values of keywords ending in state, including suffixes: outputs_[outputs_begin_[state]...]
+        std::vector<uint32_t> outputs_begin_;
+        std::vector<uint32_t> outputs_;
+    };
+
+}
@@ -0,0 +1,195 @@
+#include "line_splitter.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LINE_SPLITTER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile AVX2 intrinsics only inside functions marked for it, MSVC always does
+#if defined(LINE_SPLITTER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define LINE_SPLITTER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LINE_SPLITTER_TARGET_AVX2
+#endif
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        namespace {
+
+            constexpr size_t CRLF_SIZE = 2;
+
+            int CountTrailingZeros(uint64_t mask) {
+#ifdef _MSC_VER
+                unsigned long index = 0;
+                _BitScanForward64(&index, mask);
+                return static_cast<int>(index);
+#else
+                return __builtin_ctzll(mask);
+#endif
+            }
+
+            // Lines are emitted in order, line_start is the begin of the current unfinished line
+            inline void EmitLine(size_t cr_position, size_t& line_start, std::vector<LineRange>& lines) {
+                lines.push_back(LineRange{ line_start, cr_position - line_start });
+                line_start = cr_position + CRLF_SIZE;
+            }
+
+            // LF found at lf_position ends a line if CR of the current line is right before it
+            inline void OnLineFeed(const char* data, size_t lf_position, size_t& line_start, std::vector<LineRange>& lines) {
+                if (lf_position > line_start && data[lf_position - 1] == '\r') {
+                    EmitLine(lf_position - 1, line_start, lines);
+                }
+            }
+
+            // Bits of mask are LF positions relative to position
+            inline void OnLineFeeds(const char* data, size_t position, uint64_t mask, size_t& line_start
+                , std::vector<LineRange>& lines) {
+                while (mask != 0) {
+                    OnLineFeed(data, position + CountTrailingZeros(mask), line_start, lines);
+                    mask &= mask - 1;
+                }
+            }
+
+            // Handles everything from position on; used as whole scanner and as tail of vector ones
+            size_t SplitScalar(const char* data, size_t size, size_t position, size_t line_start
+                , std::vector<LineRange>& lines) {
+                while (position < size) {
+                    const void* lf = std::memchr(data + position, '\n', size - position);
+                    if (!lf) {
+                        break;
+                    }
+                    const size_t lf_position = static_cast<const char*>(lf) - data;
+                    OnLineFeed(data, lf_position, line_start, lines);
+                    position = lf_position + 1;
+                }
+                return line_start;
+            }
+
+#ifdef LINE_SPLITTER_X86
+            // Chat lines are a few hundred bytes: LF is rare, so 64 byte steps mostly test one mask and move on
+            size_t SplitSse2(const char* data, size_t size, std::vector<LineRange>& lines) {
+                constexpr size_t STEP = 64;
+                const __m128i lf = _mm_set1_epi8('\n');
+                size_t line_start = 0;
+                size_t position = 0;
+
+                for (; position + STEP <= size; position += STEP) {
+                    uint64_t mask = 0;
+                    for (size_t i = 0; i < STEP / 16; ++i) {
+                        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + i * 16));
+                        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf)))) << (i * 16);
+                    }
+                    OnLineFeeds(data, position, mask, line_start, lines);
+                }
+                return SplitScalar(data, size, position, line_start, lines);
+            }
+
+            LINE_SPLITTER_TARGET_AVX2
+            size_t SplitAvx2(const char* data, size_t size, std::vector<LineRange>& lines) {
+                constexpr size_t STEP = 64;
+                const __m256i lf = _mm256_set1_epi8('\n');
+                size_t line_start = 0;
+                size_t position = 0;
+
+                for (; position + STEP <= size; position += STEP) {
+                    const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+                    const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position + 32));
+                    const uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, lf)))
+                        | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, lf)))) << 32);
+                    OnLineFeeds(data, position, mask, line_start, lines);
+                }
+                return SplitScalar(data, size, position, line_start, lines);
+            }
+
+            bool CpuHasAvx2() {
+#ifdef _MSC_VER
+                int info[4] = {};
+                __cpuid(info, 0);
+                if (info[0] < 7) {
+                    return false;
+                }
+                __cpuid(info, 1);
+                const bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+                __cpuidex(info, 7, 0);
+                return os_saves_ymm && (info[1] & (1 << 5));
+#else
+                return __builtin_cpu_supports("avx2");
+#endif
+            }
+#endif
+
+            ScanKind DetectKind() {
+#ifdef LINE_SPLITTER_X86
+                if (CpuHasAvx2()) {
+                    return ScanKind::AVX2;
+                }
+                // Baseline of every x86-64 CPU
+                return ScanKind::SSE2;
+#else
+                return ScanKind::SCALAR;
+#endif
+            }
+
+        } // namespace
+
+        size_t LineSplitter::Split(std::string_view bytes, std::vector<LineRange>& lines) {
+            static const ScanKind kind = DetectKind();
+            return Split(bytes, lines, kind);
+        }
+
+        size_t LineSplitter::Split(std::string_view bytes, std::vector<LineRange>& lines, ScanKind kind) {
+            switch (kind) {
+#ifdef LINE_SPLITTER_X86
+            case ScanKind::AVX2:
+                return SplitAvx2(bytes.data(), bytes.size(), lines);
+            case ScanKind::SSE2:
+                return SplitSse2(bytes.data(), bytes.size(), lines);
+#endif
+            default:
+                return SplitScalar(bytes.data(), bytes.size(), 0, 0, lines);
+            }
+        }
+
+        ScanKind LineSplitter::GetActiveKind() {
+            static const ScanKind kind = DetectKind();
+            return kind;
+        }
+
+        bool LineSplitter::IsSupported(ScanKind kind) {
+            switch (kind) {
+            case ScanKind::SCALAR:
+                return true;
+#ifdef LINE_SPLITTER_X86
+            case ScanKind::SSE2:
+                return true;
+            case ScanKind::AVX2:
+                return CpuHasAvx2();
+#endif
+            default:
+                return false;
+            }
+        }
+
+        std::string_view LineSplitter::GetKindName(ScanKind kind) {
+            switch (kind) {
+            case ScanKind::SSE2:
+                return "SSE2";
+            case ScanKind::AVX2:
+                return "AVX2";
+            default:
+                return "SCALAR";
+            }
+        }
+
+    } // namespace message_processor
+
+} // namespace irc
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        struct LineRange {
+            size_t begin = 0;
+            size_t size = 0; // without CRLF
+        };
+
+        enum class ScanKind {
+            SCALAR,
+            SSE2,
+            AVX2
+        };
+
+        // Finds CRLF terminated lines in raw socket bytes. Vector kernels compare 64 byte steps against '\n'
+        // and check the byte before every hit for '\r'; bytes without LF cost one mask test.
+        // The widest kernel supported by the running CPU is picked once at startup.
+        class LineSplitter {
+        public:
+            // Appends ranges of complete lines to lines and returns size of their bytes with terminators.
+            // Bytes after the last CRLF are the unfinished tail and stay with the caller
+            static size_t Split(std::string_view bytes, std::vector<LineRange>& lines);
+            static size_t Split(std::string_view bytes, std::vector<LineRange>& lines, ScanKind kind);
+
+            static ScanKind GetActiveKind();
+            static bool IsSupported(ScanKind kind);
+            static std::string_view GetKindName(ScanKind kind);
+        };
+
+    } // namespace message_processor
+
+} // namespace irc
@@ -22,7 +22,8 @@ void RunWorkers(unsigned int num_workers, Fn&& fn) {
     fn();
 }
 
-int main() {
+// Optional argument: file to record received traffic to, for TwitchTrafficReplay
+int main(int argc, char* argv[]) {
     unsigned thread_pool = 2;
     net::io_context ioc(thread_pool);
     auto wg = net::make_work_guard(ioc);
@@ -35,9 +36,12 @@ int main() {
     commands::Command mode(std::move(test_executor2));
 
     chat_bot->AddCommand("test", std::move(command));
-    chat_bot->AddMode(std::move(mode));
+    chat_bot->AddMode("test", std::move(mode));
 
     auto client = std::make_shared<irc::Client>(ioc, chat_bot);
+    if (argc > 1) {
+        client->SetCaptureFile(argv[1]);
+    }
 
     irc::domain::AuthorizeData auth_data;
     client->Connect();
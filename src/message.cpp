@@ -1,4 +1,6 @@
 #include "message.h"
+#include <algorithm>
+#include <charconv>
 #include <memory>
 
 
@@ -6,53 +8,21 @@ namespace irc {
 
     namespace domain {
 
-        Message::Message(domain::MessageType message_type, std::string&& content, std::string&& badges)
+        Message::Message(MessageType message_type, std::string&& content)
             : message_type_(message_type)
-            , content_(std::move(content))
         {
-            if (badges.empty()) return;
-            std::string badge;
-            bool badge_seted = false;
-            std::string value;
-            for (const char ch : badges) {
-                if (!badge_seted && ch != '=') {
-                    badge += ch;
-                    continue;
-                }
-                else {
-                    badge_seted = true;
-                }
-                if (ch == ',') {
-                    badges_[badge].push_back(value);
-                    value.clear();
-                }
-                else if (ch == ';') {
-                    badges_[badge].push_back(value);
-                    value.clear();
-                    badge.clear();
-                    badge_seted = false;
-                }
-                else if (ch != '=') {
-                    value += ch;
-                }
+            if (!content.empty()) {
+                slab_ = SlabPool::Instance().AcquireOwned(content.size());
+                content_ = slab_->Store(content);
             }
-
-            SetRole();
-
         }
 
-        Message Message::TakeTypeAndMegre(Message&& other) {
-            if (other.message_type_ == MessageType::PRIVMSG) {
-                for (auto& [badge, value] : other.badges_) {
-                    for (auto& v : value) {
-                        this->badges_[badge].push_back(std::move(v));
-                    };
-                }
-            }
+        Message::Message(MessageType message_type, SlabRef slab, std::string_view content)
+            : slab_(std::move(slab))
+            , message_type_(message_type)
+            , content_(content)
+        {
 
-            this->message_type_ = other.message_type_;
-            content_.append(other.content_);
-            return *this;
         }
 
         domain::MessageType Message::GetMessageType() const {
@@ -67,84 +37,221 @@ namespace irc {
             if (message_type_ != domain::MessageType::PRIVMSG) {
                 throw std::logic_error("Only PRIMSG can have nick");
             }
-            std::string badge = "display-name";
-            auto it = badges_.find(badge);
-            if (it != badges_.end()) {
-                if (!it->second.empty()) {
-                    return it->second[0];
-                }
+            if (auto nick = tags_.Find("display-name")) {
+                return *nick;
+            }
+            // Connection without twitch.tv/tags capability
+            if (!login_.empty()) {
+                return login_;
             }
             throw std::invalid_argument("Wrong username after parse badges");
             return "";
         }
 
+        std::string_view Message::GetLogin() const {
+            switch (message_type_) {
+            case MessageType::JOIN:
+            case MessageType::PART:
+            case MessageType::PRIVMSG:
+            case MessageType::USERNOTICE:
+            case MessageType::WHISPER:
+            case MessageType::CLEARMSG:
+                return login_;
+            default:
+                throw std::logic_error("Only JOIN, PART and user messages have login");
+            }
+        }
+
+        std::string_view Message::GetChannel() const {
+            return channel_;
+        }
+
+        std::string_view Message::GetId() const {
+            return GetTag("id");
+        }
+
+        NameId Message::GetLoginId() const {
+            return login_id_;
+        }
+
+        NameId Message::GetChannelId() const {
+            return channel_id_;
+        }
+
+        std::optional<uint64_t> Message::GetUserId() const {
+            return GetNumericTag("user-id");
+        }
+
+        std::optional<uint64_t> Message::GetRoomId() const {
+            return GetNumericTag("room-id");
+        }
+
+        std::optional<std::chrono::system_clock::time_point> Message::GetSentTime() const {
+            if (auto sent = GetNumericTag("tmi-sent-ts")) {
+                return std::chrono::system_clock::time_point(std::chrono::milliseconds(*sent));
+            }
+            return std::nullopt;
+        }
+
+        uint32_t Message::GetBits() const {
+            return static_cast<uint32_t>(GetNumericTag("bits").value_or(0));
+        }
+
+        std::string_view Message::GetReplyParentId() const {
+            return GetTag("reply-parent-msg-id");
+        }
+
+        // emotes=25:0-4,6-10/1902:12-16
+        std::vector<EmoteRange> Message::GetEmotes() const {
+            std::vector<EmoteRange> emotes;
+            std::string_view raw_emotes = GetTag("emotes");
+            while (!raw_emotes.empty()) {
+                size_t slash = raw_emotes.find('/');
+                std::string_view emote = raw_emotes.substr(0, slash);
+                raw_emotes.remove_prefix(slash == std::string_view::npos ? raw_emotes.size() : slash + 1);
+
+                size_t colon = emote.find(':');
+                if (colon == std::string_view::npos) {
+                    continue;
+                }
+                std::string_view id = emote.substr(0, colon);
+                std::string_view ranges = emote.substr(colon + 1);
+                while (!ranges.empty()) {
+                    size_t comma = ranges.find(',');
+                    std::string_view range = ranges.substr(0, comma);
+                    ranges.remove_prefix(comma == std::string_view::npos ? ranges.size() : comma + 1);
+
+                    size_t dash = range.find('-');
+                    if (dash == std::string_view::npos) {
+                        continue;
+                    }
+                    EmoteRange emote_range{ id };
+                    auto begin = std::from_chars(range.data(), range.data() + dash, emote_range.begin);
+                    auto end = std::from_chars(range.data() + dash + 1, range.data() + range.size(), emote_range.end);
+                    if (begin.ec == std::errc{} && end.ec == std::errc{}) {
+                        emotes.push_back(emote_range);
+                    }
+                }
+            }
+            return emotes;
+        }
+
+        std::string_view Message::GetTag(std::string_view key) const {
+            return tags_.Get(key);
+        }
+
+        const Tags& Message::GetTags() const {
+            return tags_;
+        }
+
+        const Payload& Message::GetPayload() const {
+            return payload_;
+        }
+
         Badges Message::GetBadges() const {
             if (message_type_ != domain::MessageType::PRIVMSG) {
                 throw std::logic_error("Only PRIMSG can have badges");
             }
-            return badges_;
+            Badges badges;
+            tags_.ForEach([&badges](const Tag& tag) {
+                auto& values = badges[std::string(tag.key)];
+                std::string_view value = tag.value;
+                size_t comma = value.find(',');
+                while (comma != std::string_view::npos) {
+                    values.emplace_back(value.substr(0, comma));
+                    value.remove_prefix(comma + 1);
+                    comma = value.find(',');
+                }
+                values.emplace_back(value);
+                });
+            return badges;
         }
 
+        // badges=broadcaster/1,subscriber/12 -> first known badge with non zero version
         Role Message::GetRole() const {
             if (message_type_ != domain::MessageType::PRIVMSG) {
                 throw std::logic_error("Only PRIMSG can have badges");
             }
-            return role_;
+            std::string_view raw_badges = GetTag("badges");
+            while (!raw_badges.empty()) {
+                size_t comma = raw_badges.find(',');
+                std::string_view raw_badge = raw_badges.substr(0, comma);
+                raw_badges.remove_prefix(comma == std::string_view::npos ? raw_badges.size() : comma + 1);
+
+                size_t delimer = raw_badge.find('/');
+                if (delimer == std::string_view::npos) {
+                    continue;
+                }
+
+                std::string_view badge = raw_badge.substr(0, delimer);
+                std::string_view value = raw_badge.substr(delimer + 1);
+
+                if (value == "0") {
+                    continue;
+                }
+                if (badge == "broadcaster") {
+                    return Role::BROADCASTER;
+                }
+                else if (badge == "moderator") {
+                    return Role::MODERATOR;
+                }
+                else if (badge == "vip") {
+                    return Role::VIP;
+                }
+                else if (badge == "subscriber") {
+                    return Role::SUBSCRIBER;
+                }
+            }
+            return Role::EMPTY;
         }
 
         std::string Message::GetColorFromHex() const {
-            auto it = badges_.find("color");
-            if (it != badges_.end() && !it->second.empty() && !it->second[0].empty()) {
-                return it->second[0].substr(1);
+            std::string_view color = GetTag("color");
+            if (!color.empty()) {
+                return std::string(color.substr(1));
             }
             return "";
         }
 
-        void Message::SetRole() {
-            if (auto it = badges_.find("badges"); it != badges_.end()) {
-                if (it->second.empty()) {
-                    role_ = Role::EMPTY;
-                    return;
-                }
-                auto& raw_badges = it->second;
-                for (const auto& raw_badge : raw_badges) {
-                    size_t delimer = raw_badge.find('/');
-                    if (delimer == std::string::npos) { 
-                        continue; 
-                    }
-                    
-                    std::string_view badge(raw_badge.data(), delimer);
-                    std::string_view value(raw_badge.data() + delimer + 1, raw_badge.size() - delimer - 1);
-                    
-                    if (value == "0") {
-                        continue;
-                    }
-                    if (badge == "broadcaster" && role_ < Role::BROADCASTER) {
-                        role_ = Role::BROADCASTER;
-                        return;
-                    }
-                    else if (badge == "moderator" && role_ < Role::MODERATOR) {
-                        role_ = Role::MODERATOR;
-                        return;
-                    }
-                    else if (badge == "vip" && role_ < Role::VIP) {
-                        role_ = Role::VIP;
-                        return;
-                    }
-                    else if (badge == "subscriber" && role_ < Role::SUBSCRIBER) {
-                        role_ = Role::SUBSCRIBER;
-                        return;
-                    }
-                }
+        void Message::SetLogin(std::string_view login) {
+            login_ = login;
+        }
+
+        void Message::SetChannel(std::string_view channel) {
+            channel_ = channel;
+        }
+
+        void Message::SetLoginId(NameId id) {
+            login_id_ = id;
+        }
+
+        void Message::SetChannelId(NameId id) {
+            channel_id_ = id;
+        }
+
+        void Message::SetTags(Tags tags) {
+            tags_ = tags;
+        }
+
+        void Message::SetPayload(Payload payload) {
+            payload_ = payload;
+        }
+
+        std::optional<uint64_t> Message::GetNumericTag(std::string_view key) const {
+            std::string_view raw_number = GetTag(key);
+            uint64_t number = 0;
+            auto result = std::from_chars(raw_number.data(), raw_number.data() + raw_number.size(), number);
+            if (raw_number.empty() || result.ec != std::errc{} || result.ptr != raw_number.data() + raw_number.size()) {
+                return std::nullopt;
             }
-            
+            return number;
         }
 
         bool Message::operator==(const Message& other) const {
-            return this->badges_ == other.badges_
-                && this->content_ == other.content_;
+            return this->content_ == other.content_
+                && this->tags_ == other.tags_;
         }
 
     }
 
-}
\ No newline at end of file
+}
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
 
 #include "domain.h"
+#include "message_payloads.h"
+#include "message_slab.h"
+#include "message_tags.h"
+#include "string_interner.h"
 
 namespace irc {
 
@@ -21,34 +29,85 @@ namespace irc {
             BROADCASTER = 4
         };
 
+        // emotes=25:0-4,6-10 -> { "25", 0, 4 }, { "25", 6, 10 }. Positions are inclusive, in code points
+        struct EmoteRange {
+            std::string_view id;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        // Content, login, channel and tags are views into slab shared by all messages of one read,
+        // slab lives while any message of it is alive
         class Message {
         public:
             Message() = delete;
-            Message(MessageType message_type, std::string&& content)
-                : content_(content)
-                , message_type_(message_type)
-            {
-
-            }
-
-            Message(domain::MessageType message_type, std::string&& content, std::string&& badges);
+            // Copies content into its own slab. For messages built outside read path
+            Message(MessageType message_type, std::string&& content);
+            // Content must point into slab
+            Message(MessageType message_type, SlabRef slab, std::string_view content);
+            // Move only: consumers share one message through SharedMessage
+            Message(const Message&) = delete;
+            Message& operator=(const Message&) = delete;
+            Message(Message&&) noexcept = default;
+            Message& operator=(Message&&) noexcept = default;
             bool operator==(const Message& other) const;
 
-            Message TakeTypeAndMegre(Message&& other);
             MessageType GetMessageType() const;
             std::string_view GetContent() const;
             std::string_view GetNick() const;
+            // Login from message prefix or login tag: JOIN, PART, PRIVMSG, USERNOTICE, WHISPER and CLEARMSG
+            std::string_view GetLogin() const;
+            // Channel without '#', empty if command has none
+            std::string_view GetChannel() const;
+            // Interned login and channel, set by parser. NO_NAME if message has none
+            NameId GetLoginId() const;
+            NameId GetChannelId() const;
+            // IRCv3 id tag of PRIVMSG and USERNOTICE, empty if server didn't send it
+            std::string_view GetId() const;
+            std::optional<uint64_t> GetUserId() const;
+            std::optional<uint64_t> GetRoomId() const;
+            std::optional<std::chrono::system_clock::time_point> GetSentTime() const;
+            // Cheered bits, 0 if message is not a cheer
+            uint32_t GetBits() const;
+            // Message this one replies to, empty if it is not a reply
+            std::string_view GetReplyParentId() const;
+            // Parsed on every call, allocates
+            std::vector<EmoteRange> GetEmotes() const;
+            // Unescaped value of tag, empty if absent
+            std::string_view GetTag(std::string_view key) const;
+            const Tags& GetTags() const;
+            // Parsed data of CLEARCHAT, CLEARMSG, NOTICE, USERNOTICE, USERSTATE, GLOBALUSERSTATE, WHISPER,
+            // HOSTTARGET and ROOMSTATE, monostate for other types
+            const Payload& GetPayload() const;
+            template <typename T>
+            const T* GetPayloadIf() const {
+                return std::get_if<T>(&payload_);
+            }
+            // Builds map on every call, prefer GetTag on hot path
             Badges GetBadges() const;
             Role GetRole() const;
             std::string GetColorFromHex() const;
 
+            // Views below must point into message slab
+            void SetLogin(std::string_view login);
+            void SetChannel(std::string_view channel);
+            void SetLoginId(NameId id);
+            void SetChannelId(NameId id);
+            void SetTags(Tags tags);
+            void SetPayload(Payload payload);
+
         private:
+            SlabRef slab_;
             MessageType message_type_;
-            std::string content_;
-            Badges badges_;
-            Role role_ = Role::EMPTY;
-
-            void SetRole();
+            std::string_view content_;
+            std::string_view login_;
+            std::string_view channel_;
+            NameId login_id_ = NO_NAME;
+            NameId channel_id_ = NO_NAME;
+            Tags tags_;
+            Payload payload_;
+
+            std::optional<uint64_t> GetNumericTag(std::string_view key) const;
         };
 
         static std::ostream& operator<<(std::ostream& out, const Message& msg) { // TODO: TEST ONLY! Remove in prod!!!
@@ -74,4 +133,4 @@ namespace irc {
 
     }
 
-}
\ No newline at end of file
+}
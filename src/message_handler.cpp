@@ -12,17 +12,43 @@ namespace irc {
                     case MessageType::PING:
                         SendPong(message.GetContent());
                         break;
+                    case MessageType::PONG:
+                        if (keepalive_) {
+                            keepalive_->OnPong(message.GetContent());
+                        }
+                        break;
+                    case MessageType::JOIN:
+                    case MessageType::PART:
+                        if (join_scheduler_) {
+                            join_scheduler_->OnMembership(message.GetMessageType(), message.GetLoginId(), message.GetChannelId());
+                        }
+                        break;
+                    case MessageType::NOTICE:
+                        if (auto notice = message.GetPayloadIf<domain::Notice>()) {
+                            LOG_WARN("Notice "s.append(notice->notice_id).append(": ").append(notice->text));
+                        }
+                        break;
+                    case MessageType::RECONNECT:
+                        LOG_WARN("Server requested reconnect");
+                        if (server_reconnect_handler_) {
+                            server_reconnect_handler_();
+                        }
+                        break;
                     case MessageType::PRIVMSG:
+                        if (dedup_active_.load(std::memory_order_acquire)
+                            && !dedup_window_.load(std::memory_order_relaxed)->Insert(message.GetId(), dedup_source_)) {
+                            break;
+                        }
                         ss << '[' << static_cast<int>(message.GetRole()) << ']' << message.GetNick() << ' ' << message.GetContent() << "\n";
                         LOG_INFO(ss.str());
                         if (!chat_bot_) {
                             LOG_INFO("Chat bot not setted");
-                            return;
+                            break;
                         }
-                        net::post([self = this->shared_from_this(), message = std::move(message)]() mutable
-                            {
-                                self->chat_bot_->ParseAndExecute(std::move(message));
-                            });
+                        // Chat bot posts its handlers itself, the message is moved into a shared node once
+                        chat_bot_->ParseAndExecute(domain::SharedMessage::Make(std::move(message)));
+                        break;
+                    default:
                         break;
                     }
                 }
@@ -43,10 +69,50 @@ namespace irc {
             chat_bot_ = chat_bot;
         }
 
+        void MessageHandler::SetJoinScheduler(std::shared_ptr<membership::JoinScheduler> join_scheduler) {
+            join_scheduler_ = join_scheduler;
+        }
+
+        void MessageHandler::SetKeepalive(std::shared_ptr<keepalive::Keepalive> keepalive) {
+            keepalive_ = keepalive;
+        }
+
+        void MessageHandler::SetServerReconnectHandler(ServerReconnectHandler handler) {
+            server_reconnect_handler_ = std::move(handler);
+        }
+
+        dedup::DedupStats MessageHandler::GetDedupStats() const {
+            const auto* window = dedup_window_.load(std::memory_order_acquire);
+            return window ? window->GetStats() : dedup::DedupStats{};
+        }
+
+        void MessageHandler::SetDedupWindow(std::shared_ptr<dedup::DedupWindow> window, size_t source) {
+            dedup_ = window;
+            dedup_source_ = source;
+            shared_dedup_ = window != nullptr;
+            dedup_window_.store(window.get(), std::memory_order_release);
+            dedup_active_.store(shared_dedup_, std::memory_order_release);
+        }
+
+        void MessageHandler::SetHandoverDedup(bool active) {
+            if (shared_dedup_) {
+                return;
+            }
+            if (active) {
+                // Ids of the previous handover are long gone from chat
+                if (dedup_) {
+                    dedup_->Clear();
+                }
+                else {
+                    dedup_ = std::make_shared<dedup::DedupWindow>();
+                    dedup_window_.store(dedup_.get(), std::memory_order_release);
+                }
+            }
+            dedup_active_.store(active, std::memory_order_release);
+        }
+
         void MessageHandler::SendPong(const std::string_view ball) {
-            net::dispatch(connection_strand_, [self = this->shared_from_this(), ball = std::string(ball)]() {
-                self->connection_->AsyncWrite(std::string(domain::Command::PONG).append(ball).append("\r\n"));
-                });
+            outbound_->Send(outbound::Priority::PONG, std::string(domain::Command::PONG).append(" :").append(ball).append("\r\n"));
         }
 
     }
@@ -3,8 +3,10 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <atomic>
 #include <string>
 #include <string_view>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -12,7 +14,11 @@
 
 #include "chat_bot.h"
 #include "connection.h"
+#include "dedup_window.h"
+#include "join_scheduler.h"
+#include "keepalive.h"
 #include "message.h"
+#include "outbound_scheduler.h"
 
 namespace irc {
 
@@ -24,13 +30,16 @@ namespace irc {
         namespace sys = boost::system;
         using Strand = net::strand<net::io_context::executor_type>;
         using MessageType = irc::domain::MessageType;
+        using ServerReconnectHandler = std::function<void()>;
 
         class MessageHandler : public std::enable_shared_from_this<MessageHandler> {
 
         public:
-            MessageHandler(std::shared_ptr<connection::Connection> connection, Strand& connection_strand)
+            MessageHandler(std::shared_ptr<connection::Connection> connection, Strand& connection_strand
+                , std::shared_ptr<outbound::OutboundScheduler> outbound)
                 : connection_(connection)
                 , connection_strand_(connection_strand)
+                , outbound_(outbound)
             {
 
             }
@@ -39,11 +48,33 @@ namespace irc {
 
             void UpdateConnection(std::shared_ptr<connection::Connection> new_connection);
             void SetChatBot(std::shared_ptr<chat_bot::ChatBot> chat_bot);
+            void SetJoinScheduler(std::shared_ptr<membership::JoinScheduler> join_scheduler);
+            void SetKeepalive(std::shared_ptr<keepalive::Keepalive> keepalive);
+            // Called when server announces RECONNECT
+            void SetServerReconnectHandler(ServerReconnectHandler handler);
+            dedup::DedupStats GetDedupStats() const;
+            // Handlers of redundant connections share one window, source tells which connection delivered.
+            // Shared window is always on. Call before reading
+            void SetDedupWindow(std::shared_ptr<dedup::DedupWindow> window, size_t source);
+            // On while current and standby connections both deliver chat. Without shared window
+            // chat is not deduplicated otherwise. Called on connection strand
+            void SetHandoverDedup(bool active);
 
         private:
             Strand& connection_strand_;
             std::shared_ptr<connection::Connection> connection_;
+            std::shared_ptr<outbound::OutboundScheduler> outbound_;
             std::shared_ptr<chat_bot::ChatBot> chat_bot_{ nullptr };
+            std::shared_ptr<membership::JoinScheduler> join_scheduler_{ nullptr };
+            std::shared_ptr<keepalive::Keepalive> keepalive_{ nullptr };
+            ServerReconnectHandler server_reconnect_handler_;
+            // Both connections deliver the same chat while switching over, ids drop the second copy.
+            // Window is made on first handover and kept, readers see it through dedup_window_
+            std::shared_ptr<dedup::DedupWindow> dedup_{ nullptr };
+            std::atomic<dedup::DedupWindow*> dedup_window_{ nullptr };
+            std::atomic<bool> dedup_active_{ false };
+            bool shared_dedup_ = false;
+            size_t dedup_source_ = 0;
 
             void SendPong(const std::string_view ball);
         };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <variant>
+
+
+namespace irc {
+
+    namespace domain {
+
+        // Payloads are filled by parser in the same pass as the message. Views point into message slab,
+        // channel is without '#' and empty for commands that are not bound to a channel
+
+        // CLEARCHAT #channel [:login]. No login means the whole chat was cleared
+        struct ClearChat {
+            std::string_view channel;
+            std::string_view target_login;
+            std::optional<uint64_t> target_user_id;
+            // Timeout length, empty for permanent ban and for clear of the whole chat
+            std::optional<std::chrono::seconds> ban_duration;
+
+            bool IsChatCleared() const {
+                return target_login.empty();
+            }
+            bool IsPermanentBan() const {
+                return !target_login.empty() && !ban_duration;
+            }
+        };
+
+        // CLEARMSG #channel :text. One message deleted by moderator
+        struct ClearMsg {
+            std::string_view channel;
+            std::string_view login;
+            std::string_view target_message_id;
+            std::string_view text;
+        };
+
+        // NOTICE #channel :text, msg-id tells what happened (msg_banned, slow_on, ...)
+        struct Notice {
+            std::string_view channel;
+            std::string_view notice_id;
+            std::string_view text;
+        };
+
+        enum class SubTier {
+            NONE,
+            PRIME,
+            TIER1,
+            TIER2,
+            TIER3
+        };
+
+        // USERNOTICE #channel [:text]. Subs, gifts, raids and other events with system message
+        struct UserNotice {
+            std::string_view channel;
+            std::string_view notice_id; // sub, resub, subgift, raid, ...
+            std::string_view login;
+            std::string_view display_name;
+            std::string_view system_text;
+            std::string_view text;
+            SubTier tier = SubTier::NONE;
+            uint32_t cumulative_months = 0;
+            // subgift
+            std::string_view recipient_login;
+            // raid
+            std::string_view raider_display_name;
+            uint32_t raid_viewers = 0;
+        };
+
+        // USERSTATE #channel. Our own state in the channel after join and after every sent message
+        struct UserState {
+            std::string_view channel;
+            std::string_view display_name;
+            std::string_view badges;
+            std::string_view color;
+            bool is_moderator = false;
+        };
+
+        // GLOBALUSERSTATE, sent once after successful login
+        struct GlobalUserState {
+            std::optional<uint64_t> user_id;
+            std::string_view display_name;
+            std::string_view color;
+        };
+
+        // :from!from@from.tmi.twitch.tv WHISPER to :text
+        struct Whisper {
+            std::string_view from_login;
+            std::string_view from_display_name;
+            std::string_view to_login;
+            std::string_view text;
+            std::string_view message_id;
+        };
+
+        // HOSTTARGET #channel :<target|-> [viewers]
+        struct HostTarget {
+            std::string_view channel;
+            // Empty when hosting stopped
+            std::string_view target_channel;
+            std::optional<uint32_t> viewers;
+        };
+
+        // ROOMSTATE #channel. Full state after join, only changed settings later
+        struct RoomState {
+            std::string_view channel;
+            std::optional<bool> emote_only;
+            std::optional<int32_t> followers_only_minutes; // -1 disabled
+            std::optional<bool> r9k;
+            std::optional<uint32_t> slow_seconds;
+            std::optional<bool> subs_only;
+        };
+
+        using Payload = std::variant<std::monostate, ClearChat, ClearMsg, Notice, UserNotice, UserState
+            , GlobalUserState, Whisper, HostTarget, RoomState>;
+
+    } // namespace domain
+
+} // namespace irc
@@ -2,6 +2,8 @@
 #include "message.h"
 #include "domain.h"
 
+#include <algorithm>
+#include <new>
 #include <vector>
 #include <iostream>
 #include <exception>
@@ -15,226 +17,142 @@ namespace irc {
 
     namespace message_processor {
 
-        void MessageProcessor::FlushBuffer() {
-            if (!last_read_incomplete_message_.empty()) {
-                last_read_incomplete_message_.clear();
-            }
-        }
-
-        std::vector<domain::Message> MessageProcessor::GetMessagesFromRawBytes(const std::vector<char>& raw_bytes) {
+        std::vector<domain::Message> MessageProcessor::GetMessagesFromRawBytes(std::string_view raw_bytes, size_t& consumed) {
             std::vector<domain::Message> read_result;
-            std::string raw_message;
-
-            try {
-                if (!last_read_incomplete_message_.empty()) {
-                    raw_message = last_read_incomplete_message_;
-                    last_read_incomplete_message_.clear();
-                }
+            GetMessagesFromRawBytes(raw_bytes, consumed, read_result);
+            return read_result;
+        }
 
-                for (int i = 0; i < raw_bytes.size(); ++i) {
-                    if (domain::IsCRLF(raw_bytes, i)) {
-                        read_result.push_back(IdentifyMessageType(raw_message));
-                        raw_message.clear();
-                        ++i;
-                        continue;
+        void MessageProcessor::GetMessagesFromRawBytes(std::string_view raw_bytes, size_t& consumed
+            , std::vector<domain::Message>& messages) {
+            messages.clear();
+            lines_.clear();
+            consumed = LineSplitter::Split(raw_bytes, lines_);
+            if (lines_.empty()) {
+                return;
+            }
+            messages.reserve(lines_.size());
+
+            // One slab per read: parsed bytes plus decode space of tag blocks that have escapes
+            size_t escaped_size = 0;
+            for (const auto& line : lines_) {
+                std::string_view raw_line = raw_bytes.substr(line.begin, line.size);
+                if (!raw_line.empty() && raw_line[0] == '@') {
+                    std::string_view raw_tags = raw_line.substr(0, raw_line.find(' '));
+                    if (raw_tags.find('\\') != std::string_view::npos) {
+                        escaped_size += sizeof(domain::EscapedTags) + alignof(domain::EscapedTags)
+                            + (std::count(raw_tags.begin(), raw_tags.end(), ';') + 1) * sizeof(domain::Tag)
+                            + raw_tags.size();
                     }
-                    raw_message += raw_bytes[i];
                 }
-                if (!raw_message.empty()) {
-                    last_read_incomplete_message_ = raw_message;
+            }
+
+            try {
+                slab_ = domain::SlabPool::Instance().Acquire(consumed + escaped_size);
+                std::string_view stored = slab_->Store(raw_bytes.substr(0, consumed));
+                for (const auto& line : lines_) {
+                    messages.push_back(IdentifyMessageType(stored.substr(line.begin, line.size)));
                 }
             }
             catch (const std::exception& e) {
                 LOG_CRITICAL(e.what());
             }
-
-            return read_result;
+            slab_ = {};
         }
 
         domain::Message MessageProcessor::IdentifyMessageType(std::string_view raw_message) {
             try {
-                auto split_raw_message = domain::Split(raw_message);
-                domain::Message message(domain::MessageType::UNKNOWN, std::string(raw_message));
-
-                // 99.99% of all messages. No any unnecessary operations required!
-                if (split_raw_message.size() >= USER_MESSAGE_MINIMUM_SIZE) {
-                    if (auto msg = CheckForUserMessage(split_raw_message, raw_message)) {
-                        return *msg;
-                    }
+                const IrcLine line = LineTokenizer::Tokenize(raw_message);
+                if (line.command.empty()) {
+                    return MakeMessage(domain::MessageType::EMPTY, "");
                 }
 
-                switch (split_raw_message.size()) {
-                case (EMPTY):
-                    return domain::Message(domain::MessageType::EMPTY, "");
-
-                case (JOIN_PART_EXPECTED):
-                    return CheckForJoinPart(split_raw_message, raw_message); // TODO: split to 2 methods
-
+                const domain::MessageType type = CommandTable::Classify(line.command);
+                switch (type) {
+                case domain::MessageType::PRIVMSG:
+                case domain::MessageType::USERNOTICE:
+                case domain::MessageType::CLEARMSG:
+                case domain::MessageType::NOTICE:
+                case domain::MessageType::WHISPER:
+                case domain::MessageType::HOSTTARGET:
+                    return MakeChannelMessage(type, line, line.trailing);
+                case domain::MessageType::JOIN:
+                case domain::MessageType::PART:
+                    return MakeChannelMessage(type, line, line.GetParam(0));
+                case domain::MessageType::ROOMSTATE:
+                case domain::MessageType::CLEARCHAT:
+                case domain::MessageType::USERSTATE:
+                case domain::MessageType::GLOBALUSERSTATE:
+                    return MakeChannelMessage(type, line, raw_message);
+                // PING :tmi.twitch.tv and answer to our keepalive :tmi.twitch.tv PONG tmi.twitch.tv :<token>
+                case domain::MessageType::PING:
+                case domain::MessageType::PONG:
+                    return MakeMessage(type, line.GetLastParam());
+                // Server is going down for maintenance: ":tmi.twitch.tv RECONNECT"
+                case domain::MessageType::RECONNECT:
+                    return MakeMessage(type, "");
                 default:
-                    if (split_raw_message.size() >= PING_MESSAGE_MINIMUM_SIZE) {
-                        if (auto msg = CheckForPing(split_raw_message, raw_message)) {
-                            return *msg;
-                        }
-                    }
-                    if (split_raw_message.size() >= ROOMSTATE_MINIMUM_SIZE) {
-                        if (auto msg = CheckForRoomstate(split_raw_message)) {
-                            return message.TakeTypeAndMegre(std::move(*msg));
-                        }
-                    }
-
-                    if (split_raw_message.size() >= STATUSCODE_MINIMUM_SIZE) {
-                        if (auto msg = CheckForStatusCode(split_raw_message)) {
-                            return message.TakeTypeAndMegre(std::move(*msg));
-                        }
-                    }
-
-                    if (split_raw_message.size() >= CAPRES_MINIMUM_SIZE) {
-                        if (auto msg = CheckForCapRes(split_raw_message)) {
-                            return message.TakeTypeAndMegre(std::move(*msg));
-                        }
-                        else if (auto msg = CheckForClearChat(split_raw_message)) {
-                            return message.TakeTypeAndMegre(std::move(*msg));
-                        }
-                    }
+                    return MakeMessage(type, raw_message);
                 }
-                return message;
             }
             catch (const std::exception& e) {
                 LOG_CRITICAL(e.what());
             }
+            return MakeMessage(domain::MessageType::UNKNOWN, raw_message);
         }
 
-        std::optional<domain::Message> MessageProcessor::CheckForCapRes(const std::vector<std::string_view>& split_raw_message) {
-            return CheckForCapRes(split_raw_message, "");
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForCapRes(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const size_t CAPABILITIES_REQUEST_TAG_INDEX = 1;
-            const size_t CAPABILITIES_MESSAGE_MINIMUM_SIZE = 4;
-
-            if (split_raw_message[CAPABILITIES_REQUEST_TAG_INDEX] == domain::Command::CRES) {
-                return domain::Message(domain::MessageType::CAPRES
-                    , std::string(raw_message)); // Dummy
+        // Every view taken from the line already lives in read slab, outside of read path content is copied
+        domain::Message MessageProcessor::MakeMessage(domain::MessageType type, std::string_view content) const {
+            if (slab_) {
+                return domain::Message(type, slab_, content);
             }
-            return std::nullopt;
+            return domain::Message(type, std::string(content));
         }
 
-        std::optional<domain::Message> MessageProcessor::CheckForPing(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_content) {
-            const int PING_COMMAND_INDEX = 0;
-            const int PING_CONTENT_INDEX = 1;
-            const int PING_COMMAND_SIZE = 4;
-
-            if (split_raw_message[PING_COMMAND_INDEX] == domain::Command::PING) {
-                return domain::Message(domain::MessageType::PING
-                    , std::string(raw_content.substr(PING_COMMAND_SIZE)));
+        domain::Message MessageProcessor::MakeChannelMessage(domain::MessageType type, const IrcLine& line
+            , std::string_view content) {
+            domain::Message message = MakeMessage(type, content);
+            // WHISPER target, '*' of global NOTICE and commands without params are not channels
+            std::string_view channel = line.GetParam(0);
+            if (!channel.empty() && channel[0] == '#') {
+                message.SetChannel(channel.substr(1));
             }
-            return std::nullopt;
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForClearChat(const std::vector<std::string_view>& split_raw_message) {
-            return CheckForClearChat(split_raw_message, "");
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForClearChat(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const int CLEARCHAT_TAG_INDEX = 2;
-            if (split_raw_message[CLEARCHAT_TAG_INDEX] == domain::Command::CLEARCHAT) {
-                return domain::Message(domain::MessageType::CLEARCHAT, std::string(raw_message)); // TODO?
-            }
-            return std::nullopt;
-        }
-
-        domain::Message MessageProcessor::CheckForJoinPart(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const int ACTION_TAG_INDEX = 1;
-            const int CHANNEL_NAME_INDEX = 2;
-
-            if (split_raw_message[ACTION_TAG_INDEX] == domain::Command::JOIN) {
-                return domain::Message(domain::MessageType::JOIN
-                    , std::string(split_raw_message[CHANNEL_NAME_INDEX]));
-            }
-            if (split_raw_message[ACTION_TAG_INDEX] == domain::Command::PART) {
-                return domain::Message(domain::MessageType::PART
-                    , std::string(split_raw_message[CHANNEL_NAME_INDEX]));
-            }
-
-            return domain::Message(domain::MessageType::UNKNOWN, std::string(raw_message));
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForStatusCode(const std::vector<std::string_view>& split_raw_message) {
-            return CheckForStatusCode(split_raw_message, "");
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForStatusCode(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const size_t CORRECT_STATUSCODE_MESSAGE_MINIMUM_SIZE = 3;
-            const int STATUSCODE_INDEX = 1;
-
-            if (domain::IsNumber(split_raw_message[STATUSCODE_INDEX])) {
-                return domain::Message(domain::MessageType::STATUSCODE
-                    , std::string(split_raw_message[STATUSCODE_INDEX]));
+            if (!line.tags.empty()) {
+                message.SetTags(MakeTags(line.tags));
             }
-            return std::nullopt;
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForRoomstate(const std::vector<std::string_view>& split_raw_message) {
-            return CheckForRoomstate(split_raw_message, "");
-        }
-        std::optional<domain::Message> MessageProcessor::CheckForRoomstate(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const int ROOMSTATE_CONTENT_INDEX = 1;
-            const int ROOMSTATE_TAG_INDEX = 2;
-
-            if (split_raw_message.size() > ROOMSTATE_TAG_INDEX && split_raw_message[ROOMSTATE_TAG_INDEX] == domain::Command::ROOMSTATE) {
-                return domain::Message(domain::MessageType::ROOMSTATE
-                    , std::string(split_raw_message[ROOMSTATE_CONTENT_INDEX]));
+            // login!login@login.tmi.twitch.tv, server notices carry login in tags
+            std::string_view login = line.GetNick();
+            login = login.empty() ? message.GetTag("login") : login;
+            message.SetLogin(login);
+            // Names are interned once here, handlers and chat bot compare ids
+            if (!login.empty()) {
+                const bool is_sender = type == domain::MessageType::PRIVMSG || type == domain::MessageType::USERNOTICE
+                    || type == domain::MessageType::WHISPER;
+                message.SetLoginId(domain::StringInterner::Users().Intern(login
+                    , is_sender ? message.GetUserId().value_or(0) : 0));
             }
-
-            return std::nullopt;
-        }
-
-        std::optional<domain::Message> MessageProcessor::CheckForUserMessage(const std::vector<std::string_view>& split_raw_message
-            , std::string_view raw_message) {
-            const int BADGES_INDEX = 0;
-            const int MSG_TAG_INDEX = 2;
-
-            if (split_raw_message[MSG_TAG_INDEX] == domain::Command::PRIVMSG
-                || split_raw_message[MSG_TAG_INDEX] == domain::Command::USERNOTICE) {
-                std::string user_content = GetUserMessageFromSplitRawMessage(split_raw_message);
-
-                if (split_raw_message[MSG_TAG_INDEX] == domain::Command::PRIVMSG) {
-                    return domain::Message(domain::MessageType::PRIVMSG
-                        , std::move(user_content)
-                        , std::string(split_raw_message[BADGES_INDEX]));
-                }
-                else {
-                    return domain::Message(domain::MessageType::USERNOTICE // TODO: process usernotice
-                        , std::move(user_content)
-                        , std::string(split_raw_message[BADGES_INDEX]));
-                }
+            if (!message.GetChannel().empty()) {
+                message.SetChannelId(domain::StringInterner::Channels().Intern(message.GetChannel()
+                    , message.GetRoomId().value_or(0)));
             }
-
-            return std::nullopt;
+            message.SetPayload(PayloadParser::Parse(type, line, message));
+            return message;
         }
 
-        std::string MessageProcessor::GetUserMessageFromSplitRawMessage(const std::vector<std::string_view>& split_raw_message) {
-            const int USER_MESSAGE_START = 4;
-
-            std::string content;
-            bool is_first = true;
-            for (int i = USER_MESSAGE_START; i < split_raw_message.size(); ++i) {
-                if (!is_first) {
-                    content += ' ';
-                }
-                content += split_raw_message[i];
-                is_first = false;
+        // Tags stay raw. Blocks with escapes get decode space in read slab, unescaped there on first access
+        domain::Tags MessageProcessor::MakeTags(std::string_view raw_tags) {
+            if (raw_tags.find('\\') == std::string_view::npos) {
+                return domain::Tags(raw_tags);
             }
-            if (content[0] == ':') {
-                return content.substr(1);
+            if (!slab_) {
+                throw std::logic_error("Escaped tags are decoded in read slab only");
             }
-            return content;
+            const size_t count = std::count(raw_tags.begin(), raw_tags.end(), ';') + 1;
+            auto* escaped = new (slab_->Allocate(sizeof(domain::EscapedTags), alignof(domain::EscapedTags))) domain::EscapedTags;
+            escaped->tags = reinterpret_cast<domain::Tag*>(slab_->Allocate(count * sizeof(domain::Tag), alignof(domain::Tag)));
+            escaped->count = count;
+            escaped->values = slab_->Allocate(raw_tags.size());
+            return domain::Tags(raw_tags, escaped);
         }
 
 
@@ -4,15 +4,21 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <syncstream>
+#include <vector>
 
 #include "auth_data.h"
 #include "domain.h"
+#include "irc_line.h"
+#include "line_splitter.h"
 #include "logging.h"
 #include "message.h"
+#include "message_slab.h"
+#include "payload_parser.h"
 
 
 namespace irc {
@@ -21,39 +27,26 @@ namespace irc {
 
     namespace message_processor {
 
-        const size_t EMPTY = 0;
-        const size_t STATUSCODE_TAG_INDEX = 1;
-        const size_t CAPABILITIES_REQUEST_TAG_INDEX = 1;
-        const size_t PING_MESSAGE_MINIMUM_SIZE = 2;
-        const size_t CLEARCHAT_TAG_INDEX = 2;
-        const size_t ROOMSTATE_MINIMUM_SIZE = 2;
-        const size_t JOIN_PART_EXPECTED = 3;
-        const size_t STATUSCODE_MINIMUM_SIZE = 3;
-        const size_t USER_MESSAGE_MINIMUM_SIZE = 4;
-        const size_t CLEARCHAT_MINIMUM_SIZE = 4;
-        const size_t CAPRES_MINIMUM_SIZE = 4;
-
         class MessageProcessor {
         public:
-            std::vector<domain::Message> GetMessagesFromRawBytes(const std::vector<char>& raw_bytes);
-            void FlushBuffer();
+            // Parses every complete CRLF terminated line of raw_bytes.
+            // consumed receives the size of parsed part, unfinished tail is left to the caller buffer.
+            // Parsed part is copied once into a pooled slab, messages are views into it
+            std::vector<domain::Message> GetMessagesFromRawBytes(std::string_view raw_bytes, size_t& consumed);
+            // Same, fills caller vector. Reusing it keeps steady state reading allocation free
+            void GetMessagesFromRawBytes(std::string_view raw_bytes, size_t& consumed, std::vector<domain::Message>& messages);
 
         private:
-            std::string last_read_incomplete_message_;
+            // Reused between reads, keeps splitting allocation free once warmed up
+            std::vector<LineRange> lines_;
+            // Slab of the read being parsed, released when parsing is done
+            domain::SlabRef slab_;
 
             domain::Message IdentifyMessageType(std::string_view raw_message);
-            std::optional<domain::Message> CheckForCapRes(const std::vector<std::string_view>& split_raw_message);
-            std::optional<domain::Message> CheckForCapRes(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            std::optional<domain::Message> CheckForPing(const std::vector<std::string_view>& split_raw_message, std::string_view raw_content);
-            std::optional<domain::Message> CheckForClearChat(const std::vector<std::string_view>& split_raw_message);
-            std::optional<domain::Message> CheckForClearChat(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            domain::Message CheckForJoinPart(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            std::optional<domain::Message> CheckForStatusCode(const std::vector<std::string_view>& split_raw_message);
-            std::optional<domain::Message> CheckForStatusCode(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            std::optional<domain::Message> CheckForRoomstate(const std::vector<std::string_view>& split_raw_message);
-            std::optional<domain::Message> CheckForRoomstate(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            std::optional<domain::Message> CheckForUserMessage(const std::vector<std::string_view>& split_raw_message, std::string_view raw_message);
-            std::string GetUserMessageFromSplitRawMessage(const std::vector<std::string_view>& split_raw_message);
+            domain::Message MakeMessage(domain::MessageType type, std::string_view content) const;
+            // Channel from first param, login from prefix, tags and typed payload
+            domain::Message MakeChannelMessage(domain::MessageType type, const IrcLine& line, std::string_view content);
+            domain::Tags MakeTags(std::string_view raw_tags);
         };
 
     } // namesapce message_processor
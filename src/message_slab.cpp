@@ -0,0 +1,184 @@
+#include "message_slab.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+
+namespace irc {
+
+    namespace domain {
+
+        Slab* Slab::Create(size_t capacity) {
+            void* memory = ::operator new(sizeof(Slab) + capacity);
+            return new (memory) Slab(capacity);
+        }
+
+        void Slab::Destroy(Slab* slab) {
+            slab->~Slab();
+            ::operator delete(slab);
+        }
+
+        char* Slab::Allocate(size_t size, size_t alignment) {
+            size_t begin = (used_ + alignment - 1) & ~(alignment - 1);
+            if (begin + size > capacity_) {
+                throw std::length_error("Slab is full");
+            }
+            used_ = begin + size;
+            return Data() + begin;
+        }
+
+        std::string_view Slab::Store(std::string_view bytes) {
+            if (bytes.empty()) {
+                return {};
+            }
+            char* place = Allocate(bytes.size());
+            std::memcpy(place, bytes.data(), bytes.size());
+            return { place, bytes.size() };
+        }
+
+        void Slab::Reset() {
+            used_ = 0;
+        }
+
+        size_t Slab::GetCapacity() const {
+            return capacity_;
+        }
+
+        size_t Slab::GetUsed() const {
+            return used_;
+        }
+
+        char* Slab::Data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        SlabRef::SlabRef(Slab* slab)
+            : slab_(slab)
+        {
+            if (slab_) {
+                slab_->refs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        SlabRef::SlabRef(const SlabRef& other)
+            : SlabRef(other.slab_)
+        {
+        }
+
+        SlabRef::SlabRef(SlabRef&& other) noexcept
+            : slab_(other.slab_)
+        {
+            other.slab_ = nullptr;
+        }
+
+        SlabRef& SlabRef::operator=(const SlabRef& other) {
+            if (slab_ != other.slab_) {
+                SlabRef copy(other);
+                std::swap(slab_, copy.slab_);
+            }
+            return *this;
+        }
+
+        SlabRef& SlabRef::operator=(SlabRef&& other) noexcept {
+            if (this != &other) {
+                Release();
+                slab_ = other.slab_;
+                other.slab_ = nullptr;
+            }
+            return *this;
+        }
+
+        SlabRef::~SlabRef() {
+            Release();
+        }
+
+        Slab* SlabRef::Get() const {
+            return slab_;
+        }
+
+        Slab* SlabRef::operator->() const {
+            return slab_;
+        }
+
+        SlabRef::operator bool() const {
+            return slab_ != nullptr;
+        }
+
+        bool SlabRef::operator==(const SlabRef& other) const {
+            return slab_ == other.slab_;
+        }
+
+        void SlabRef::Release() {
+            if (slab_ && slab_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                SlabPool::Instance().Release(slab_);
+            }
+            slab_ = nullptr;
+        }
+
+        SlabPool& SlabPool::Instance() {
+            static SlabPool instance;
+            return instance;
+        }
+
+        SlabPool::SlabPool() {
+            free_.reserve(MAX_FREE);
+        }
+
+        SlabPool::~SlabPool() {
+            for (Slab* slab : free_) {
+                Slab::Destroy(slab);
+            }
+        }
+
+        SlabRef SlabPool::Acquire(size_t min_capacity) {
+            {
+                std::lock_guard lock(mutex_);
+                auto it = std::find_if(free_.rbegin(), free_.rend(), [min_capacity](const Slab* slab) {
+                    return slab->GetCapacity() >= min_capacity;
+                    });
+                if (it != free_.rend()) {
+                    Slab* slab = *it;
+                    *it = free_.back();
+                    free_.pop_back();
+                    reused_.fetch_add(1, std::memory_order_relaxed);
+                    slab->Reset();
+                    return SlabRef(slab);
+                }
+            }
+            created_.fetch_add(1, std::memory_order_relaxed);
+            return SlabRef(Slab::Create(std::max(min_capacity, DEFAULT_CAPACITY)));
+        }
+
+        SlabRef SlabPool::AcquireOwned(size_t capacity) {
+            created_.fetch_add(1, std::memory_order_relaxed);
+            return SlabRef(Slab::Create(capacity));
+        }
+
+        SlabStats SlabPool::GetStats() const {
+            SlabStats stats;
+            stats.created = created_.load(std::memory_order_relaxed);
+            stats.reused = reused_.load(std::memory_order_relaxed);
+            stats.destroyed = destroyed_.load(std::memory_order_relaxed);
+            std::lock_guard lock(mutex_);
+            stats.free = free_.size();
+            return stats;
+        }
+
+        void SlabPool::Release(Slab* slab) {
+            // Owned slabs are sized for one message, reads can't use them
+            if (slab->GetCapacity() >= DEFAULT_CAPACITY) {
+                std::lock_guard lock(mutex_);
+                if (free_.size() < MAX_FREE) {
+                    free_.push_back(slab);
+                    return;
+                }
+            }
+            destroyed_.fetch_add(1, std::memory_order_relaxed);
+            Slab::Destroy(slab);
+        }
+
+    } // namespace domain
+
+} // namespace irc
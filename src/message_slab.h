@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+
+namespace irc {
+
+    namespace domain {
+
+        struct SlabStats {
+            size_t created = 0;
+            size_t reused = 0;
+            size_t destroyed = 0;
+            size_t free = 0;
+        };
+
+        // Bump arena for one read: raw lines and tag arrays of every message parsed from it.
+        // Header and bytes are one allocation. Filled on read strand only, read-only after that
+        class Slab {
+        public:
+            static Slab* Create(size_t capacity);
+            static void Destroy(Slab* slab);
+
+            Slab(const Slab&) = delete;
+            Slab& operator=(const Slab&) = delete;
+
+            // Throws std::length_error when there is no room, caller sizes slab up front
+            char* Allocate(size_t size, size_t alignment = 1);
+            std::string_view Store(std::string_view bytes);
+            void Reset();
+            size_t GetCapacity() const;
+            size_t GetUsed() const;
+
+        private:
+            friend class SlabRef;
+
+            explicit Slab(size_t capacity)
+                : capacity_(capacity)
+            {
+            }
+
+            char* Data();
+
+            size_t capacity_;
+            size_t used_ = 0;
+            std::atomic<size_t> refs_{ 0 };
+        };
+
+        // Intrusive handle, messages of one read share the slab. Last handle returns it to the pool
+        class SlabRef {
+        public:
+            SlabRef() = default;
+            explicit SlabRef(Slab* slab);
+            SlabRef(const SlabRef& other);
+            SlabRef(SlabRef&& other) noexcept;
+            SlabRef& operator=(const SlabRef& other);
+            SlabRef& operator=(SlabRef&& other) noexcept;
+            ~SlabRef();
+
+            Slab* Get() const;
+            Slab* operator->() const;
+            explicit operator bool() const;
+            bool operator==(const SlabRef& other) const;
+
+        private:
+            Slab* slab_ = nullptr;
+
+            void Release();
+        };
+
+        // Process wide free list. Steady reading takes and returns the same few slabs without touching the heap
+        class SlabPool {
+        public:
+            static constexpr size_t DEFAULT_CAPACITY = 16 * 1024;
+            static constexpr size_t MAX_FREE = 64;
+
+            static SlabPool& Instance();
+
+            SlabPool(const SlabPool&) = delete;
+            SlabPool& operator=(const SlabPool&) = delete;
+            ~SlabPool();
+
+            // Slab of at least min_capacity bytes, never smaller than DEFAULT_CAPACITY
+            SlabRef Acquire(size_t min_capacity = DEFAULT_CAPACITY);
+            // Exact size, not kept by pool. For messages built outside read path
+            SlabRef AcquireOwned(size_t capacity);
+            SlabStats GetStats() const;
+
+        private:
+            friend class SlabRef;
+
+            SlabPool();
+
+            void Release(Slab* slab);
+
+            mutable std::mutex mutex_;
+            std::vector<Slab*> free_;
+            std::atomic<size_t> created_{ 0 };
+            std::atomic<size_t> reused_{ 0 };
+            std::atomic<size_t> destroyed_{ 0 };
+        };
+
+    } // namespace domain
+
+} // namespace irc
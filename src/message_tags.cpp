@@ -0,0 +1,141 @@
+#include "message_tags.h"
+
+#include <algorithm>
+
+
+namespace irc {
+
+    namespace domain {
+
+        size_t UnescapeTagValue(char* value, size_t size) {
+            size_t out = 0;
+            for (size_t in = 0; in < size; ++in) {
+                if (value[in] != '\\') {
+                    value[out++] = value[in];
+                    continue;
+                }
+                if (++in == size) {
+                    break;
+                }
+                switch (value[in]) {
+                case ':':
+                    value[out++] = ';';
+                    break;
+                case 's':
+                    value[out++] = ' ';
+                    break;
+                case 'r':
+                    value[out++] = '\r';
+                    break;
+                case 'n':
+                    value[out++] = '\n';
+                    break;
+                default:
+                    value[out++] = value[in];
+                    break;
+                }
+            }
+            return out;
+        }
+
+        Tags::Tags(std::string_view raw, EscapedTags* escaped)
+            : raw_(raw)
+            , escaped_(escaped)
+        {
+        }
+
+        // Raw values never contain ';', so key preceded by ';' or block start is a real key
+        std::optional<std::string_view> Tags::Find(std::string_view key) const {
+            if (key.empty()) {
+                return std::nullopt;
+            }
+            if (escaped_) {
+                Decode();
+                for (size_t i = 0; i < escaped_->count; ++i) {
+                    if (escaped_->tags[i].key == key) {
+                        return escaped_->tags[i].value;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            for (size_t pos = raw_.find(key); pos != std::string_view::npos; pos = raw_.find(key, pos + 1)) {
+                const size_t end = pos + key.size();
+                if (pos != 0 && raw_[pos - 1] != ';') {
+                    continue;
+                }
+                if (end == raw_.size() || raw_[end] == ';') {
+                    return std::string_view{};
+                }
+                if (raw_[end] == '=') {
+                    std::string_view value = raw_.substr(end + 1);
+                    return value.substr(0, value.find(';'));
+                }
+            }
+            return std::nullopt;
+        }
+
+        std::string_view Tags::Get(std::string_view key) const {
+            return Find(key).value_or(std::string_view{});
+        }
+
+        bool Tags::Has(std::string_view key) const {
+            return Find(key).has_value();
+        }
+
+        bool Tags::Empty() const {
+            return raw_.empty();
+        }
+
+        size_t Tags::Count() const {
+            if (raw_.empty()) {
+                return 0;
+            }
+            if (escaped_) {
+                return escaped_->count;
+            }
+            return std::count(raw_.begin(), raw_.end(), ';') + 1;
+        }
+
+        bool Tags::operator==(const Tags& other) const {
+            if (Count() != other.Count()) {
+                return false;
+            }
+            bool equal = true;
+            ForEach([&other, &equal](const Tag& tag) {
+                equal = equal && other.Find(tag.key) == tag.value;
+                });
+            return equal;
+        }
+
+        // Runs once per block whoever asks first. Delimiters are found in the raw block, so ';'
+        // produced by unescaping doesn't split anything
+        void Tags::Decode() const {
+            std::call_once(escaped_->decoded, [this]() {
+                char* out = escaped_->values;
+                size_t begin = 0;
+                for (size_t i = 0; i < escaped_->count; ++i) {
+                    size_t end = std::min(raw_.find(';', begin), raw_.size());
+                    Tag tag = SplitTag(raw_.substr(begin, end - begin));
+                    if (tag.value.find('\\') != std::string_view::npos) {
+                        std::copy(tag.value.begin(), tag.value.end(), out);
+                        tag.value = std::string_view(out, UnescapeTagValue(out, tag.value.size()));
+                        out += tag.value.size();
+                    }
+                    escaped_->tags[i] = tag;
+                    begin = end + 1;
+                }
+                });
+        }
+
+        Tag Tags::SplitTag(std::string_view raw_tag) {
+            size_t equal = raw_tag.find('=');
+            if (equal == std::string_view::npos) {
+                return { raw_tag, {} };
+            }
+            return { raw_tag.substr(0, equal), raw_tag.substr(equal + 1) };
+        }
+
+    } // namespace domain
+
+} // namespace irc
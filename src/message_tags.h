@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+
+namespace irc {
+
+    namespace domain {
+
+        // IRCv3 tag: key and unescaped value
+        struct Tag {
+            std::string_view key;
+            std::string_view value;
+        };
+
+        // Decoded form of a tag block that has escapes. Placed in read slab by parser,
+        // filled on first access: values are unescaped into a separate buffer and indexed here. Raw block is
+        // left intact, content of some messages is a view of the whole line
+        struct EscapedTags {
+            std::once_flag decoded;
+            Tag* tags = nullptr;
+            size_t count = 0;
+            // Raw block size is enough, unescaping never makes a value longer
+            char* values = nullptr;
+        };
+
+        // \: -> ';'  \s -> ' '  \\ -> '\'  \r -> CR  \n -> LF, other \x -> x, trailing '\' is dropped.
+        // Rewrites value in place, returns unescaped size
+        size_t UnescapeTagValue(char* value, size_t size);
+
+        // Raw block "key=value;key2=value2" without '@'. Nothing is parsed up front: lookup searches
+        // the block for the key, values are unescaped only in blocks that have escapes and only when asked
+        class Tags {
+        public:
+            Tags() = default;
+            // escaped must be given when raw block contains '\'
+            explicit Tags(std::string_view raw, EscapedTags* escaped = nullptr);
+
+            std::optional<std::string_view> Find(std::string_view key) const;
+            // Empty if tag is absent
+            std::string_view Get(std::string_view key) const;
+            bool Has(std::string_view key) const;
+            bool Empty() const;
+            size_t Count() const;
+
+            template <typename Fn>
+            void ForEach(Fn&& fn) const {
+                if (escaped_) {
+                    Decode();
+                    for (size_t i = 0; i < escaped_->count; ++i) {
+                        fn(escaped_->tags[i]);
+                    }
+                    return;
+                }
+                std::string_view raw = raw_;
+                while (!raw.empty()) {
+                    size_t end = raw.find(';');
+                    fn(SplitTag(raw.substr(0, end)));
+                    raw.remove_prefix(end == std::string_view::npos ? raw.size() : end + 1);
+                }
+            }
+
+            bool operator==(const Tags& other) const;
+
+        private:
+            std::string_view raw_;
+            EscapedTags* escaped_ = nullptr;
+
+            void Decode() const;
+            static Tag SplitTag(std::string_view raw_tag);
+        };
+
+    } // namespace domain
+
+} // namespace irc
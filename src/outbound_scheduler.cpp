@@ -0,0 +1,191 @@
+#include "outbound_scheduler.h"
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <utility>
+
+
+namespace irc {
+
+    namespace outbound {
+
+        namespace {
+
+            void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+                int64_t current = max.load(std::memory_order_relaxed);
+                while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+                }
+            }
+
+            void UpdateMax(std::atomic<size_t>& max, size_t value) {
+                size_t current = max.load(std::memory_order_relaxed);
+                while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+                }
+            }
+
+        }
+
+        bool TokenBucket::TryTake(size_t cost, Clock::time_point now) {
+            cost = std::min(cost, limit_.count);
+            if (Available(now) < cost) {
+                return false;
+            }
+            spent_.insert(spent_.end(), cost, now);
+            return true;
+        }
+
+        Clock::duration TokenBucket::TimeUntilAvailable(size_t cost, Clock::time_point now) {
+            cost = std::min(cost, limit_.count);
+            const size_t available = Available(now);
+            if (available >= cost) {
+                return Clock::duration::zero();
+            }
+            // Oldest spent tokens come back first
+            return spent_[cost - available - 1] + limit_.period - now;
+        }
+
+        size_t TokenBucket::Available(Clock::time_point now) {
+            Refill(now);
+            return limit_.count - std::min(limit_.count, spent_.size());
+        }
+
+        void TokenBucket::Refill(Clock::time_point now) {
+            while (!spent_.empty() && spent_.front() + limit_.period <= now) {
+                spent_.pop_front();
+            }
+        }
+
+        RateLimiter::RateLimiter(const RateLimits& limits)
+            : auth_(limits.auth)
+            , membership_(limits.membership)
+            , message_(limits.message)
+        {
+        }
+
+        void RateLimiter::SetLimits(const RateLimits& limits) {
+            std::lock_guard lock(mutex_);
+            auth_ = TokenBucket(limits.auth);
+            membership_ = TokenBucket(limits.membership);
+            message_ = TokenBucket(limits.message);
+        }
+
+        bool RateLimiter::TryAcquire(Priority priority, size_t cost, Clock::time_point now, Clock::duration& wait) {
+            std::lock_guard lock(mutex_);
+            TokenBucket* bucket = GetBucket(priority);
+            if (!bucket || bucket->TryTake(cost, now)) {
+                return true;
+            }
+            wait = bucket->TimeUntilAvailable(cost, now);
+            return false;
+        }
+
+        TokenBucket* RateLimiter::GetBucket(Priority priority) {
+            switch (priority) {
+            case Priority::AUTH:
+                return &auth_;
+            case Priority::MEMBERSHIP:
+                return &membership_;
+            case Priority::MESSAGE:
+                return &message_;
+            default:
+                return nullptr;
+            }
+        }
+
+        OutboundScheduler::OutboundScheduler(net::io_context& ioc, std::shared_ptr<RateLimiter> limiter)
+            : strand_(net::make_strand(ioc))
+            , timer_(strand_)
+            , limiter_(limiter)
+        {
+        }
+
+        void OutboundScheduler::SetConnection(std::shared_ptr<connection::Connection> connection) {
+            net::dispatch(strand_, [self = this->shared_from_this(), connection]() {
+                self->connection_ = connection;
+                self->Pump();
+                });
+        }
+
+        void OutboundScheduler::SetRateLimiter(std::shared_ptr<RateLimiter> limiter) {
+            net::dispatch(strand_, [self = this->shared_from_this(), limiter]() {
+                self->limiter_ = limiter;
+                self->Pump();
+                });
+        }
+
+        void OutboundScheduler::Send(Priority priority, std::string line, size_t cost, std::function<void()> on_sent) {
+            net::post(strand_, [self = this->shared_from_this(), priority, line = std::move(line), cost
+                , on_sent = std::move(on_sent)]() mutable {
+                const size_t index = static_cast<size_t>(priority);
+                self->queues_[index].push_back(Pending{ std::move(line), cost, Clock::now(), std::move(on_sent) });
+                const size_t queued = self->stats_[index].queued.fetch_add(1, std::memory_order_relaxed) + 1;
+                UpdateMax(self->stats_[index].max_queued, queued);
+                self->Pump();
+                });
+        }
+
+        OutboundStats OutboundScheduler::GetStats() const {
+            OutboundStats result;
+            for (size_t i = 0; i < PRIORITIES_COUNT; ++i) {
+                result[i].queued = stats_[i].queued.load(std::memory_order_relaxed);
+                result[i].max_queued = stats_[i].max_queued.load(std::memory_order_relaxed);
+                result[i].sent = stats_[i].sent.load(std::memory_order_relaxed);
+                result[i].total_wait = std::chrono::microseconds(stats_[i].total_wait_us.load(std::memory_order_relaxed));
+                result[i].max_wait = std::chrono::microseconds(stats_[i].max_wait_us.load(std::memory_order_relaxed));
+            }
+            return result;
+        }
+
+        // Classes have separate buckets: lower class may go while higher one waits for own tokens
+        void OutboundScheduler::Pump() {
+            if (!connection_ || !limiter_) {
+                return;
+            }
+
+            const auto now = Clock::now();
+            auto next_wait = Clock::duration::max();
+            for (size_t index = 0; index < PRIORITIES_COUNT; ++index) {
+                auto& queue = queues_[index];
+                while (!queue.empty()) {
+                    Clock::duration wait{};
+                    if (!limiter_->TryAcquire(static_cast<Priority>(index), queue.front().cost, now, wait)) {
+                        next_wait = std::min(next_wait, wait);
+                        break;
+                    }
+                    RecordSent(index, now - queue.front().enqueued);
+                    connection_->AsyncWrite(queue.front().line);
+                    if (queue.front().on_sent) {
+                        queue.front().on_sent();
+                    }
+                    queue.pop_front();
+                }
+            }
+
+            if (next_wait != Clock::duration::max()) {
+                ArmTimer(next_wait);
+            }
+        }
+
+        void OutboundScheduler::ArmTimer(Clock::duration wait) {
+            timer_.expires_after(wait);
+            timer_.async_wait([self = this->shared_from_this()](const sys::error_code& ec) {
+                if (!ec) {
+                    self->Pump();
+                }
+                });
+        }
+
+        void OutboundScheduler::RecordSent(size_t index, Clock::duration wait) {
+            auto& stats = stats_[index];
+            const int64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(wait).count();
+            stats.queued.fetch_sub(1, std::memory_order_relaxed);
+            stats.sent.fetch_add(1, std::memory_order_relaxed);
+            stats.total_wait_us.fetch_add(wait_us, std::memory_order_relaxed);
+            UpdateMax(stats.max_wait_us, wait_us);
+        }
+
+    } // namespace outbound
+
+} // namespace irc
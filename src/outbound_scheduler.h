@@ -0,0 +1,159 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "connection.h"
+
+
+namespace irc {
+
+    namespace outbound {
+
+        namespace net = boost::asio;
+        namespace sys = boost::system;
+        using Strand = net::strand<net::io_context::executor_type>;
+        using Clock = std::chrono::steady_clock;
+        using namespace std::literals;
+
+        // Lower value goes first
+        enum class Priority {
+            PONG = 0,
+            AUTH = 1,
+            MEMBERSHIP = 2, // JOIN / PART
+            MESSAGE = 3     // PRIVMSG
+        };
+
+        constexpr size_t PRIORITIES_COUNT = 4;
+
+        struct Limit {
+            size_t count = 0;
+            Clock::duration period{};
+        };
+
+        // Twitch limits per account
+        struct RateLimits {
+            Limit auth;
+            Limit membership;
+            Limit message;
+
+            static RateLimits Normal() {
+                return { { 20, 10s }, { 20, 10s }, { 20, 30s } };
+            }
+
+            static RateLimits Moderator() {
+                return { { 20, 10s }, { 20, 10s }, { 100, 30s } };
+            }
+
+            static RateLimits VerifiedBot() {
+                return { { 200, 10s }, { 2000, 10s }, { 7500, 30s } };
+            }
+        };
+
+        // Token spent at t comes back at t + period, so no window of period length sees more than count
+        // sends, while full count is always usable. Plain refill rate would allow up to 2 * count per window.
+        class TokenBucket {
+        public:
+            explicit TokenBucket(Limit limit)
+                : limit_(limit)
+            {
+            }
+
+            bool TryTake(size_t cost, Clock::time_point now);
+            Clock::duration TimeUntilAvailable(size_t cost, Clock::time_point now);
+            size_t Available(Clock::time_point now);
+
+        private:
+            Limit limit_;
+            std::deque<Clock::time_point> spent_;
+
+            void Refill(Clock::time_point now);
+        };
+
+        // Buckets of one account, shared by every connection logged in with it
+        class RateLimiter {
+        public:
+            explicit RateLimiter(const RateLimits& limits = RateLimits::Normal());
+
+            void SetLimits(const RateLimits& limits);
+
+            // PONG is never limited. On failure wait receives time until enough tokens are back
+            bool TryAcquire(Priority priority, size_t cost, Clock::time_point now, Clock::duration& wait);
+
+        private:
+            std::mutex mutex_;
+            TokenBucket auth_;
+            TokenBucket membership_;
+            TokenBucket message_;
+
+            TokenBucket* GetBucket(Priority priority);
+        };
+
+        struct PriorityStats {
+            size_t queued = 0;
+            size_t max_queued = 0;
+            size_t sent = 0;
+            std::chrono::microseconds total_wait{ 0 };
+            std::chrono::microseconds max_wait{ 0 };
+        };
+
+        using OutboundStats = std::array<PriorityStats, PRIORITIES_COUNT>;
+
+        // Paces lines of one connection: strict priority between classes, FIFO inside of class
+        class OutboundScheduler : public std::enable_shared_from_this<OutboundScheduler> {
+        public:
+            OutboundScheduler(net::io_context& ioc, std::shared_ptr<RateLimiter> limiter);
+
+            void SetConnection(std::shared_ptr<connection::Connection> connection);
+            void SetRateLimiter(std::shared_ptr<RateLimiter> limiter);
+
+            // cost - tokens taken from class bucket, e.g. number of channels in JOIN.
+            // on_sent is called on scheduler strand when line is handed to connection
+            void Send(Priority priority, std::string line, size_t cost = 1, std::function<void()> on_sent = nullptr);
+
+            OutboundStats GetStats() const;
+
+        private:
+            struct Pending {
+                std::string line;
+                size_t cost = 1;
+                Clock::time_point enqueued;
+                std::function<void()> on_sent;
+            };
+
+            struct AtomicStats {
+                std::atomic<size_t> queued{ 0 };
+                std::atomic<size_t> max_queued{ 0 };
+                std::atomic<size_t> sent{ 0 };
+                std::atomic<int64_t> total_wait_us{ 0 };
+                std::atomic<int64_t> max_wait_us{ 0 };
+            };
+
+            Strand strand_;
+            net::steady_timer timer_;
+
+            // strand_ only
+            std::shared_ptr<connection::Connection> connection_;
+            std::shared_ptr<RateLimiter> limiter_;
+            std::array<std::deque<Pending>, PRIORITIES_COUNT> queues_;
+
+            std::array<AtomicStats, PRIORITIES_COUNT> stats_;
+
+            void Pump();
+            void ArmTimer(Clock::duration wait);
+            void RecordSent(size_t index, Clock::duration wait);
+        };
+
+    } // namespace outbound
+
+} // namespace irc
@@ -0,0 +1,181 @@
+#include "payload_parser.h"
+
+#include <charconv>
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        namespace {
+
+            template <typename Number>
+            std::optional<Number> ParseNumber(std::string_view raw_number) {
+                Number number{};
+                auto result = std::from_chars(raw_number.data(), raw_number.data() + raw_number.size(), number);
+                if (raw_number.empty() || result.ec != std::errc{} || result.ptr != raw_number.data() + raw_number.size()) {
+                    return std::nullopt;
+                }
+                return number;
+            }
+
+            template <typename Number>
+            std::optional<Number> GetNumericTag(const domain::Message& message, std::string_view key) {
+                return ParseNumber<Number>(message.GetTag(key));
+            }
+
+            std::optional<bool> GetFlagTag(const domain::Message& message, std::string_view key) {
+                if (auto flag = message.GetTags().Find(key)) {
+                    return *flag == "1";
+                }
+                return std::nullopt;
+            }
+
+        } // namespace
+
+        domain::Payload PayloadParser::Parse(domain::MessageType type, const IrcLine& line, const domain::Message& message) {
+            switch (type) {
+            case domain::MessageType::CLEARCHAT:
+                return ParseClearChat(line, message);
+            case domain::MessageType::CLEARMSG:
+                return ParseClearMsg(line, message);
+            case domain::MessageType::NOTICE:
+                return ParseNotice(line, message);
+            case domain::MessageType::USERNOTICE:
+                return ParseUserNotice(line, message);
+            case domain::MessageType::USERSTATE:
+                return ParseUserState(message);
+            case domain::MessageType::GLOBALUSERSTATE:
+                return ParseGlobalUserState(message);
+            case domain::MessageType::WHISPER:
+                return ParseWhisper(line, message);
+            case domain::MessageType::HOSTTARGET:
+                return ParseHostTarget(line, message);
+            case domain::MessageType::ROOMSTATE:
+                return ParseRoomState(message);
+            default:
+                return std::monostate{};
+            }
+        }
+
+        // @ban-duration=600;target-user-id=1 :tmi.twitch.tv CLEARCHAT #channel :login
+        domain::ClearChat PayloadParser::ParseClearChat(const IrcLine& line, const domain::Message& message) {
+            domain::ClearChat clear_chat;
+            clear_chat.channel = message.GetChannel();
+            clear_chat.target_login = line.trailing;
+            clear_chat.target_user_id = GetNumericTag<uint64_t>(message, "target-user-id");
+            if (auto duration = GetNumericTag<int64_t>(message, "ban-duration")) {
+                clear_chat.ban_duration = std::chrono::seconds(*duration);
+            }
+            return clear_chat;
+        }
+
+        // @login=user;target-msg-id=abc :tmi.twitch.tv CLEARMSG #channel :deleted text
+        domain::ClearMsg PayloadParser::ParseClearMsg(const IrcLine& line, const domain::Message& message) {
+            domain::ClearMsg clear_msg;
+            clear_msg.channel = message.GetChannel();
+            clear_msg.login = message.GetTag("login");
+            clear_msg.target_message_id = message.GetTag("target-msg-id");
+            clear_msg.text = line.trailing;
+            return clear_msg;
+        }
+
+        // @msg-id=slow_on :tmi.twitch.tv NOTICE #channel :text, channel is '*' for global notices
+        domain::Notice PayloadParser::ParseNotice(const IrcLine& line, const domain::Message& message) {
+            domain::Notice notice;
+            notice.channel = message.GetChannel();
+            notice.notice_id = message.GetTag("msg-id");
+            notice.text = line.trailing;
+            return notice;
+        }
+
+        domain::UserNotice PayloadParser::ParseUserNotice(const IrcLine& line, const domain::Message& message) {
+            domain::UserNotice user_notice;
+            user_notice.channel = message.GetChannel();
+            user_notice.notice_id = message.GetTag("msg-id");
+            user_notice.login = message.GetTag("login");
+            user_notice.display_name = message.GetTag("display-name");
+            user_notice.system_text = message.GetTag("system-msg");
+            user_notice.text = line.trailing;
+            user_notice.tier = ParseSubTier(message.GetTag("msg-param-sub-plan"));
+            user_notice.cumulative_months = GetNumericTag<uint32_t>(message, "msg-param-cumulative-months").value_or(0);
+            user_notice.recipient_login = message.GetTag("msg-param-recipient-user-name");
+            user_notice.raider_display_name = message.GetTag("msg-param-displayName");
+            user_notice.raid_viewers = GetNumericTag<uint32_t>(message, "msg-param-viewerCount").value_or(0);
+            return user_notice;
+        }
+
+        domain::UserState PayloadParser::ParseUserState(const domain::Message& message) {
+            domain::UserState user_state;
+            user_state.channel = message.GetChannel();
+            user_state.display_name = message.GetTag("display-name");
+            user_state.badges = message.GetTag("badges");
+            user_state.color = message.GetTag("color");
+            user_state.is_moderator = message.GetTag("mod") == "1";
+            return user_state;
+        }
+
+        domain::GlobalUserState PayloadParser::ParseGlobalUserState(const domain::Message& message) {
+            domain::GlobalUserState global_user_state;
+            global_user_state.user_id = GetNumericTag<uint64_t>(message, "user-id");
+            global_user_state.display_name = message.GetTag("display-name");
+            global_user_state.color = message.GetTag("color");
+            return global_user_state;
+        }
+
+        domain::Whisper PayloadParser::ParseWhisper(const IrcLine& line, const domain::Message& message) {
+            domain::Whisper whisper;
+            whisper.from_login = line.GetNick();
+            whisper.from_display_name = message.GetTag("display-name");
+            whisper.to_login = line.GetParam(0);
+            whisper.text = line.trailing;
+            whisper.message_id = message.GetTag("message-id");
+            return whisper;
+        }
+
+        // :tmi.twitch.tv HOSTTARGET #channel :target 42, "-" instead of target when hosting stops
+        domain::HostTarget PayloadParser::ParseHostTarget(const IrcLine& line, const domain::Message& message) {
+            domain::HostTarget host_target;
+            host_target.channel = message.GetChannel();
+            std::string_view trailing = line.trailing;
+            size_t space = trailing.find(' ');
+            std::string_view target = trailing.substr(0, space);
+            if (target != "-") {
+                host_target.target_channel = target;
+            }
+            if (space != std::string_view::npos) {
+                host_target.viewers = ParseNumber<uint32_t>(trailing.substr(space + 1));
+            }
+            return host_target;
+        }
+
+        domain::RoomState PayloadParser::ParseRoomState(const domain::Message& message) {
+            domain::RoomState room_state;
+            room_state.channel = message.GetChannel();
+            room_state.emote_only = GetFlagTag(message, "emote-only");
+            room_state.followers_only_minutes = GetNumericTag<int32_t>(message, "followers-only");
+            room_state.r9k = GetFlagTag(message, "r9k");
+            room_state.slow_seconds = GetNumericTag<uint32_t>(message, "slow");
+            room_state.subs_only = GetFlagTag(message, "subs-only");
+            return room_state;
+        }
+
+        domain::SubTier PayloadParser::ParseSubTier(std::string_view plan) {
+            if (plan == "Prime") {
+                return domain::SubTier::PRIME;
+            }
+            if (plan == "1000") {
+                return domain::SubTier::TIER1;
+            }
+            if (plan == "2000") {
+                return domain::SubTier::TIER2;
+            }
+            if (plan == "3000") {
+                return domain::SubTier::TIER3;
+            }
+            return domain::SubTier::NONE;
+        }
+
+    } // namespace message_processor
+
+} // namespace irc
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "domain.h"
+#include "irc_line.h"
+#include "message.h"
+#include "message_payloads.h"
+
+
+namespace irc {
+
+    namespace message_processor {
+
+        // Typed data of server commands from tokenized line and tags of already built message
+        class PayloadParser {
+        public:
+            // monostate for commands without payload
+            static domain::Payload Parse(domain::MessageType type, const IrcLine& line, const domain::Message& message);
+
+        private:
+            static domain::ClearChat ParseClearChat(const IrcLine& line, const domain::Message& message);
+            static domain::ClearMsg ParseClearMsg(const IrcLine& line, const domain::Message& message);
+            static domain::Notice ParseNotice(const IrcLine& line, const domain::Message& message);
+            static domain::UserNotice ParseUserNotice(const IrcLine& line, const domain::Message& message);
+            static domain::UserState ParseUserState(const domain::Message& message);
+            static domain::GlobalUserState ParseGlobalUserState(const domain::Message& message);
+            static domain::Whisper ParseWhisper(const IrcLine& line, const domain::Message& message);
+            static domain::HostTarget ParseHostTarget(const IrcLine& line, const domain::Message& message);
+            static domain::RoomState ParseRoomState(const domain::Message& message);
+            static domain::SubTier ParseSubTier(std::string_view plan);
+        };
+
+    } // namespace message_processor
+
+} // namespace irc
@@ -0,0 +1,113 @@
+#include "read_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace connection {
+
+    ReadBuffer::ReadBuffer(size_t initial_size, size_t max_size)
+        : data_(std::make_unique<char[]>(initial_size))
+        , capacity_(initial_size)
+        , max_size_(std::max(initial_size, max_size))
+    {
+        if (initial_size == 0) {
+            throw std::invalid_argument("Read buffer can't be empty");
+        }
+    }
+
+    net::mutable_buffer ReadBuffer::Prepare() {
+        if (begin_ == end_) {
+            begin_ = end_ = 0;
+        }
+
+        // Last read filled everything we gave to socket - there is more data waiting
+        if (grow_required_ && capacity_ < max_size_) {
+            Reallocate(std::min(capacity_ * 2, max_size_));
+        }
+        grow_required_ = false;
+
+        // Keep reads big: move tail to front when less than a quarter is free
+        if (begin_ > 0 && (capacity_ - end_) < capacity_ / 4) {
+            Compact();
+        }
+
+        // Single incomplete line bigger than the whole buffer
+        if (end_ == capacity_) {
+            if (capacity_ < max_size_) {
+                Reallocate(std::min(capacity_ * 2, max_size_));
+            }
+            else {
+                // Longer than any line we accept: drop it and skip the rest of it
+                begin_ = end_ = 0;
+                skip_line_ = true;
+                ++dropped_lines_;
+            }
+        }
+
+        last_prepared_ = capacity_ - end_;
+        return net::buffer(data_.get() + end_, last_prepared_);
+    }
+
+    void ReadBuffer::Commit(size_t bytes_readed) {
+        const size_t committed = std::min(bytes_readed, capacity_ - end_);
+        if (skip_line_) {
+            const std::string_view fresh(data_.get() + end_, committed);
+            const size_t line_end = fresh.find('\n');
+            if (line_end == std::string_view::npos) {
+                grow_required_ = false;
+                return;
+            }
+            skip_line_ = false;
+            begin_ = end_ + line_end + 1;
+        }
+        end_ += committed;
+        grow_required_ = bytes_readed == last_prepared_;
+    }
+
+    void ReadBuffer::Consume(size_t bytes) {
+        begin_ += std::min(bytes, end_ - begin_);
+    }
+
+    void ReadBuffer::Clear() {
+        begin_ = end_ = 0;
+        grow_required_ = false;
+        skip_line_ = false;
+    }
+
+    std::string_view ReadBuffer::Data() const {
+        return std::string_view(data_.get() + begin_, end_ - begin_);
+    }
+
+    size_t ReadBuffer::Capacity() const {
+        return capacity_;
+    }
+
+    size_t ReadBuffer::GetReallocationsCount() const {
+        return reallocations_;
+    }
+
+    size_t ReadBuffer::GetDroppedLinesCount() const {
+        return dropped_lines_;
+    }
+
+    void ReadBuffer::Compact() {
+        const size_t size = end_ - begin_;
+        std::memmove(data_.get(), data_.get() + begin_, size);
+        begin_ = 0;
+        end_ = size;
+    }
+
+    void ReadBuffer::Reallocate(size_t new_capacity) {
+        const size_t size = end_ - begin_;
+        auto data = std::make_unique<char[]>(new_capacity);
+        std::memcpy(data.get(), data_.get() + begin_, size);
+        data_ = std::move(data);
+        capacity_ = new_capacity;
+        begin_ = 0;
+        end_ = size;
+        ++reallocations_;
+    }
+
+} // namespace connection
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+
+namespace connection {
+
+    namespace net = boost::asio;
+
+    // Long-lived receive buffer of one connection. Socket reads land right after the unparsed bytes,
+    // complete lines are handed out as views and the unfinished tail stays in place until
+    // the next read completes it. The buffer grows while reads keep filling it up to max_size.
+    // A line that doesn't fit into max_size is dropped: bytes are skipped up to its LF, so a peer
+    // that never sends CRLF can't grow the buffer without bound.
+    class ReadBuffer {
+    public:
+        static constexpr size_t DEFAULT_INITIAL_SIZE = 4 * 1024;
+        static constexpr size_t DEFAULT_MAX_SIZE = 64 * 1024;
+
+        explicit ReadBuffer(size_t initial_size = DEFAULT_INITIAL_SIZE, size_t max_size = DEFAULT_MAX_SIZE);
+
+        ReadBuffer(const ReadBuffer&) = delete;
+        ReadBuffer& operator=(const ReadBuffer&) = delete;
+
+        net::mutable_buffer Prepare();
+        void Commit(size_t bytes_readed);
+        void Consume(size_t bytes);
+        void Clear();
+
+        std::string_view Data() const;
+        size_t Capacity() const;
+        size_t GetReallocationsCount() const;
+        size_t GetDroppedLinesCount() const;
+
+    private:
+        std::unique_ptr<char[]> data_;
+        size_t capacity_;
+        size_t max_size_;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+        size_t last_prepared_ = 0;
+        size_t reallocations_ = 0;
+        size_t dropped_lines_ = 0;
+        bool grow_required_ = false;
+        // Rest of an oversized line is being skipped
+        bool skip_line_ = false;
+
+        void Compact();
+        void Reallocate(size_t new_capacity);
+    };
+
+} // namespace connection
@@ -0,0 +1,89 @@
+#include "irc_client.h"
+#include "chat_bot.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <boost/asio/io_context.hpp>
+
+
+namespace net = boost::asio;
+using namespace std::literals;
+
+namespace {
+
+    class CountingCommandExecutor : public commands::ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        explicit CountingCommandExecutor(std::atomic<size_t>& calls)
+            : calls_(calls)
+        {
+        }
+
+        void operator()([[maybe_unused]] std::string_view content) override {
+            ++calls_;
+        }
+
+    private:
+        std::atomic<size_t>& calls_;
+    };
+
+    void PrintUsage() {
+        std::cout << "Usage: TwitchTrafficReplay <capture file> [--original-pace]\n";
+    }
+
+} // namespace
+
+// Replays a capture written by Client::SetCaptureFile through the client read path with no network
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+    const std::string path = argv[1];
+    const auto pace = argc > 2 && argv[2] == "--original-pace"sv ? irc::ReplayPace::ORIGINAL : irc::ReplayPace::MAX_SPEED;
+
+    net::io_context ioc(1);
+    auto wg = net::make_work_guard(ioc);
+
+    std::atomic<size_t> calls{ 0 };
+    auto chat_bot = std::make_shared<chat_bot::ChatBot>(ioc);
+    commands::Command command(std::make_unique<CountingCommandExecutor>(calls));
+    command.SetRoleLevel(static_cast<int>(irc::domain::Role::EMPTY));
+    chat_bot->AddCommand("test", std::move(command));
+
+    auto client = std::make_shared<irc::Client>(ioc, chat_bot, false);
+    irc::ReplayStats stats;
+    const auto started = std::chrono::steady_clock::now();
+    try {
+        client->Replay(path, pace, [&](const irc::ReplayStats& result) {
+            stats = result;
+            wg.reset();
+            });
+    }
+    catch (const std::exception& e) {
+        std::cout << "Can't replay " << path << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    ioc.run();
+    // Run returns when chat bot finished the work posted by the last chunk too
+    const auto total = std::chrono::duration<double>(std::chrono::steady_clock::now() - started);
+
+    const double seconds = std::chrono::duration<double>(stats.duration).count();
+    std::cout << "chunks:   " << stats.chunks << "\n"
+        << "bytes:    " << stats.bytes << "\n"
+        << "messages: " << stats.messages << "\n"
+        << "commands: " << calls.load() << "\n"
+        << "replay:   " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << ", " << stats.bytes / seconds / (1024 * 1024) << " MB/s, " << stats.messages / seconds << " messages/s";
+    }
+    std::cout << "\n" << "total:    " << total.count() << " s\n";
+    return 0;
+}
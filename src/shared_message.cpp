@@ -0,0 +1,146 @@
+#include "shared_message.h"
+
+#include <new>
+#include <utility>
+
+
+namespace irc {
+
+    namespace domain {
+
+        SharedMessage SharedMessage::Make(Message&& message) {
+            MessagePool& pool = MessagePool::Instance();
+            MessageNode* node = pool.Acquire();
+            try {
+                new (node->storage) Message(std::move(message));
+            }
+            catch (...) {
+                pool.Release(node);
+                throw;
+            }
+            return SharedMessage(node);
+        }
+
+        SharedMessage::SharedMessage(MessageNode* node)
+            : node_(node)
+        {
+            node_->refs.store(1, std::memory_order_relaxed);
+        }
+
+        SharedMessage::SharedMessage(const SharedMessage& other)
+            : node_(other.node_)
+        {
+            if (node_) {
+                node_->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        SharedMessage::SharedMessage(SharedMessage&& other) noexcept
+            : node_(other.node_)
+        {
+            other.node_ = nullptr;
+        }
+
+        SharedMessage& SharedMessage::operator=(const SharedMessage& other) {
+            if (node_ != other.node_) {
+                SharedMessage copy(other);
+                std::swap(node_, copy.node_);
+            }
+            return *this;
+        }
+
+        SharedMessage& SharedMessage::operator=(SharedMessage&& other) noexcept {
+            if (this != &other) {
+                Release();
+                node_ = other.node_;
+                other.node_ = nullptr;
+            }
+            return *this;
+        }
+
+        SharedMessage::~SharedMessage() {
+            Release();
+        }
+
+        const Message* SharedMessage::Get() const {
+            return node_ ? node_->Get() : nullptr;
+        }
+
+        const Message& SharedMessage::operator*() const {
+            return *node_->Get();
+        }
+
+        const Message* SharedMessage::operator->() const {
+            return node_->Get();
+        }
+
+        SharedMessage::operator bool() const {
+            return node_ != nullptr;
+        }
+
+        size_t SharedMessage::GetUseCount() const {
+            return node_ ? node_->refs.load(std::memory_order_relaxed) : 0;
+        }
+
+        void SharedMessage::Release() {
+            if (node_ && node_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                node_->Get()->~Message();
+                MessagePool::Instance().Release(node_);
+            }
+            node_ = nullptr;
+        }
+
+        MessagePool& MessagePool::Instance() {
+            static MessagePool instance;
+            return instance;
+        }
+
+        MessagePool::MessagePool() {
+            free_.reserve(MAX_FREE);
+        }
+
+        MessagePool::~MessagePool() {
+            for (MessageNode* node : free_) {
+                delete node;
+            }
+        }
+
+        MessagePoolStats MessagePool::GetStats() const {
+            MessagePoolStats stats;
+            stats.created = created_.load(std::memory_order_relaxed);
+            stats.reused = reused_.load(std::memory_order_relaxed);
+            stats.destroyed = destroyed_.load(std::memory_order_relaxed);
+            std::lock_guard lock(mutex_);
+            stats.free = free_.size();
+            return stats;
+        }
+
+        MessageNode* MessagePool::Acquire() {
+            {
+                std::lock_guard lock(mutex_);
+                if (!free_.empty()) {
+                    MessageNode* node = free_.back();
+                    free_.pop_back();
+                    reused_.fetch_add(1, std::memory_order_relaxed);
+                    return node;
+                }
+            }
+            created_.fetch_add(1, std::memory_order_relaxed);
+            return new MessageNode;
+        }
+
+        void MessagePool::Release(MessageNode* node) {
+            {
+                std::lock_guard lock(mutex_);
+                if (free_.size() < MAX_FREE) {
+                    free_.push_back(node);
+                    return;
+                }
+            }
+            destroyed_.fetch_add(1, std::memory_order_relaxed);
+            delete node;
+        }
+
+    } // namespace domain
+
+} // namespace irc
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "message.h"
+
+
+namespace irc {
+
+    namespace domain {
+
+        struct MessagePoolStats {
+            size_t created = 0;
+            size_t reused = 0;
+            size_t destroyed = 0;
+            size_t free = 0;
+        };
+
+        // Reference count and message in one pooled block
+        struct MessageNode {
+            std::atomic<size_t> refs{ 0 };
+            alignas(Message) unsigned char storage[sizeof(Message)];
+
+            Message* Get() {
+                return reinterpret_cast<Message*>(storage);
+            }
+        };
+
+        // Immutable message handed to any number of consumers. Copy is a reference count increment,
+        // the last handle destroys message (and releases its slab) and returns the node to the pool
+        class SharedMessage {
+        public:
+            SharedMessage() = default;
+            static SharedMessage Make(Message&& message);
+
+            SharedMessage(const SharedMessage& other);
+            SharedMessage(SharedMessage&& other) noexcept;
+            SharedMessage& operator=(const SharedMessage& other);
+            SharedMessage& operator=(SharedMessage&& other) noexcept;
+            ~SharedMessage();
+
+            const Message* Get() const;
+            const Message& operator*() const;
+            const Message* operator->() const;
+            explicit operator bool() const;
+            size_t GetUseCount() const;
+
+        private:
+            MessageNode* node_ = nullptr;
+
+            explicit SharedMessage(MessageNode* node);
+            void Release();
+        };
+
+        // Process wide free list of nodes, same idea as SlabPool: steady chat reuses the same nodes
+        class MessagePool {
+        public:
+            static constexpr size_t MAX_FREE = 1024;
+
+            static MessagePool& Instance();
+
+            MessagePool(const MessagePool&) = delete;
+            MessagePool& operator=(const MessagePool&) = delete;
+            ~MessagePool();
+
+            MessagePoolStats GetStats() const;
+
+        private:
+            friend class SharedMessage;
+
+            MessagePool();
+
+            MessageNode* Acquire();
+            void Release(MessageNode* node);
+
+            mutable std::mutex mutex_;
+            std::vector<MessageNode*> free_;
+            std::atomic<size_t> created_{ 0 };
+            std::atomic<size_t> reused_{ 0 };
+            std::atomic<size_t> destroyed_{ 0 };
+        };
+
+    } // namespace domain
+
+} // namespace irc
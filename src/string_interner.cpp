@@ -0,0 +1,255 @@
+#include "string_interner.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+
+namespace irc {
+
+    namespace domain {
+
+        namespace {
+
+            constexpr size_t MIN_SHARD_CAPACITY = 16;
+
+            char ToLower(char ch) {
+                return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+            }
+
+            // Lowercased copy lives on stack for names of twitch size, lowercase names are not copied
+            class LowerName {
+            public:
+                LowerName(std::string_view name, char* buffer, size_t buffer_size) {
+                    if (std::none_of(name.begin(), name.end(), [](char ch) { return ch >= 'A' && ch <= 'Z'; })) {
+                        view_ = name;
+                        return;
+                    }
+                    char* out = buffer;
+                    if (name.size() > buffer_size) {
+                        heap_.resize(name.size());
+                        out = heap_.data();
+                    }
+                    std::transform(name.begin(), name.end(), out, ToLower);
+                    view_ = std::string_view(out, name.size());
+                }
+
+                std::string_view Get() const {
+                    return view_;
+                }
+
+            private:
+                std::string heap_;
+                std::string_view view_;
+            };
+
+            size_t GetShardIndex(std::string_view key) {
+                // Low bits pick the bucket inside shard map, shard takes bits above them
+                return (std::hash<std::string_view>{}(key) >> 8) % StringInterner::SHARDS;
+            }
+
+        } // namespace
+
+        StringInterner::StringInterner(size_t capacity)
+            : shards_(std::make_unique<Shard[]>(SHARDS))
+        {
+            const size_t shard_capacity = std::max(capacity / SHARDS, MIN_SHARD_CAPACITY);
+            for (size_t i = 0; i < SHARDS; ++i) {
+                shards_[i].slots = std::make_unique<Slot[]>(shard_capacity);
+                shards_[i].capacity = shard_capacity;
+                shards_[i].by_name.reserve(shard_capacity);
+                shards_[i].by_id.reserve(shard_capacity);
+            }
+        }
+
+        StringInterner& StringInterner::Users() {
+            static StringInterner interner;
+            return interner;
+        }
+
+        StringInterner& StringInterner::Channels() {
+            static StringInterner interner;
+            return interner;
+        }
+
+        NameId StringInterner::Intern(std::string_view name, uint64_t twitch_id) {
+            char buffer[MAX_INLINE_NAME];
+            const LowerName lower(name, buffer, sizeof(buffer));
+            const std::string_view key = lower.Get();
+            if (key.empty()) {
+                return NO_NAME;
+            }
+            const size_t shard_index = GetShardIndex(key);
+            Shard& shard = shards_[shard_index];
+            {
+                std::shared_lock lock(shard.mutex);
+                if (auto it = shard.by_name.find(key); it != shard.by_name.end()) {
+                    Slot& slot = shard.slots[it->second];
+                    uint64_t known = 0;
+                    // First message with user-id binds the name to the account
+                    if (twitch_id == 0 || slot.twitch_id.load(std::memory_order_relaxed) == twitch_id
+                        || slot.twitch_id.compare_exchange_strong(known, twitch_id) || known == twitch_id) {
+                        MarkReferenced(slot);
+                        return slot.id;
+                    }
+                }
+            }
+
+            std::unique_lock lock(shard.mutex);
+            Slot& slot = shard.slots[Insert(shard, shard_index, key, twitch_id)];
+            return slot.id;
+        }
+
+        NameId StringInterner::Find(std::string_view name) const {
+            char buffer[MAX_INLINE_NAME];
+            const LowerName lower(name, buffer, sizeof(buffer));
+            const std::string_view key = lower.Get();
+            if (key.empty()) {
+                return NO_NAME;
+            }
+            const Shard& shard = shards_[GetShardIndex(key)];
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.by_name.find(key);
+            if (it == shard.by_name.end()) {
+                return NO_NAME;
+            }
+            Slot& slot = shard.slots[it->second];
+            MarkReferenced(slot);
+            return slot.id;
+        }
+
+        NameId StringInterner::Pin(std::string_view name) {
+            char buffer[MAX_INLINE_NAME];
+            const LowerName lower(name, buffer, sizeof(buffer));
+            const std::string_view key = lower.Get();
+            if (key.empty()) {
+                return NO_NAME;
+            }
+            const size_t shard_index = GetShardIndex(key);
+            Shard& shard = shards_[shard_index];
+            std::unique_lock lock(shard.mutex);
+            Slot& slot = shard.slots[Insert(shard, shard_index, key, 0)];
+            ++slot.pins;
+            return slot.id;
+        }
+
+        void StringInterner::Unpin(NameId id) {
+            if (id == NO_NAME) {
+                return;
+            }
+            Shard& shard = shards_[id % SHARDS];
+            std::unique_lock lock(shard.mutex);
+            if (auto it = shard.by_id.find(id); it != shard.by_id.end()) {
+                Slot& slot = shard.slots[it->second];
+                slot.pins -= slot.pins > 0 ? 1 : 0;
+            }
+        }
+
+        std::optional<std::string> StringInterner::GetName(NameId id) const {
+            if (id == NO_NAME) {
+                return std::nullopt;
+            }
+            const Shard& shard = shards_[id % SHARDS];
+            std::shared_lock lock(shard.mutex);
+            if (auto it = shard.by_id.find(id); it != shard.by_id.end()) {
+                return shard.slots[it->second].name;
+            }
+            return std::nullopt;
+        }
+
+        InternerStats StringInterner::GetStats() const {
+            InternerStats stats;
+            for (size_t i = 0; i < SHARDS; ++i) {
+                const Shard& shard = shards_[i];
+                {
+                    std::shared_lock lock(shard.mutex);
+                    stats.names += shard.by_name.size();
+                }
+                stats.misses += shard.misses.load(std::memory_order_relaxed);
+                stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        // Finds or adds the name. Another thread may have added it since shared lock was released
+        uint32_t StringInterner::Insert(Shard& shard, size_t shard_index, std::string_view key, uint64_t twitch_id) {
+            if (auto it = shard.by_name.find(key); it != shard.by_name.end()) {
+                Slot& slot = shard.slots[it->second];
+                const uint64_t known = slot.twitch_id.load();
+                if (twitch_id != 0 && known != twitch_id) {
+                    if (known == 0) {
+                        slot.twitch_id = twitch_id;
+                    }
+                    else {
+                        Retire(shard, shard_index, slot, twitch_id);
+                    }
+                }
+                MarkReferenced(slot);
+                return it->second;
+            }
+
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            const uint32_t index = shard.used < shard.capacity ? static_cast<uint32_t>(shard.used++) : Evict(shard);
+            Slot& slot = shard.slots[index];
+            slot.name.assign(key);
+            slot.id = NextId(shard, shard_index);
+            slot.twitch_id = twitch_id;
+            slot.pins = 0;
+            slot.referenced.store(true, std::memory_order_relaxed);
+            shard.by_name.emplace(slot.name, index);
+            shard.by_id.emplace(slot.id, index);
+            return index;
+        }
+
+        // Second chance: names looked up since last pass of the hand survive it
+        uint32_t StringInterner::Evict(Shard& shard) {
+            for (size_t step = 0; step < 2 * shard.capacity; ++step) {
+                const auto index = static_cast<uint32_t>(shard.hand);
+                shard.hand = (shard.hand + 1) % shard.capacity;
+                Slot& slot = shard.slots[index];
+                if (slot.pins > 0 || slot.referenced.exchange(false, std::memory_order_relaxed)) {
+                    continue;
+                }
+                shard.by_name.erase(slot.name);
+                shard.by_id.erase(slot.id);
+                shard.evictions.fetch_add(1, std::memory_order_relaxed);
+                return index;
+            }
+            throw std::length_error("String interner shard is full of pinned names");
+        }
+
+        // Name moved to another account: holders of the old id keep pointing to the old account.
+        // Pinned name keeps its id: holders pinned it by name, and JOIN echoes of the name must match it
+        void StringInterner::Retire(Shard& shard, size_t shard_index, Slot& slot, uint64_t twitch_id) {
+            if (slot.pins > 0) {
+                slot.twitch_id = twitch_id;
+                return;
+            }
+            const uint32_t index = shard.by_id.at(slot.id);
+            shard.by_id.erase(slot.id);
+            slot.id = NextId(shard, shard_index);
+            slot.twitch_id = twitch_id;
+            shard.by_id.emplace(slot.id, index);
+        }
+
+        // Lookups of hot names only read the slot, no cache line bouncing between readers
+        void StringInterner::MarkReferenced(Slot& slot) {
+            if (!slot.referenced.load(std::memory_order_relaxed)) {
+                slot.referenced.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        NameId StringInterner::NextId(Shard& shard, size_t shard_index) {
+            constexpr uint32_t MAX_SEQUENCE = UINT32_MAX >> SHARD_BITS;
+            NameId id = NO_NAME;
+            do {
+                shard.next_sequence = shard.next_sequence >= MAX_SEQUENCE ? 1 : shard.next_sequence + 1;
+                id = static_cast<NameId>(shard.next_sequence << SHARD_BITS) | static_cast<NameId>(shard_index);
+            } while (shard.by_id.contains(id));
+            return id;
+        }
+
+    } // namespace domain
+
+} // namespace irc
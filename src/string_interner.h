@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace irc {
+
+    namespace domain {
+
+        // Stable id of interned login or channel name. A name evicted and seen again gets a new id.
+        // Ids of interned names are never handed out again, an evicted one may come back after the
+        // sequence of its shard wraps (2^28 new names)
+        using NameId = uint32_t;
+        inline constexpr NameId NO_NAME = 0;
+
+        struct InternerStats {
+            size_t names = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+        };
+
+        // Maps lowercased names to NameId, so lists, registries and joins compare integers instead of
+        // strings. Sharded by name hash: lookups of known names take a shared lock of one shard and
+        // never allocate. Memory is bounded by capacity, least recently seen names are evicted
+        // (clock algorithm). Pinned names, e.g. white and black list entries, are never evicted.
+        // Twitch user-id/room-id decides identity where present: a name seen with another id belongs
+        // to another account after rename and gets a new NameId. Pinned names are held by name (joins,
+        // user lists, own nick), so they move to the new account and keep their id
+        class StringInterner {
+        public:
+            static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+            static constexpr size_t SHARD_BITS = 4;
+            static constexpr size_t SHARDS = size_t{ 1 } << SHARD_BITS;
+
+            explicit StringInterner(size_t capacity = DEFAULT_CAPACITY);
+
+            StringInterner(const StringInterner&) = delete;
+            StringInterner& operator=(const StringInterner&) = delete;
+
+            // Logins and channels have separate id spaces
+            static StringInterner& Users();
+            static StringInterner& Channels();
+
+            // twitch_id is 0 when message has no user-id/room-id
+            NameId Intern(std::string_view name, uint64_t twitch_id = 0);
+            // Never inserts. NO_NAME for names not seen or already evicted
+            NameId Find(std::string_view name) const;
+            // Counted: every Pin needs its Unpin
+            NameId Pin(std::string_view name);
+            void Unpin(NameId id);
+            std::optional<std::string> GetName(NameId id) const;
+
+            InternerStats GetStats() const;
+
+        private:
+            struct Slot {
+                std::string name;
+                NameId id = NO_NAME;
+                std::atomic<uint64_t> twitch_id{ 0 };
+                uint32_t pins = 0;
+                std::atomic<bool> referenced{ false };
+            };
+
+            struct alignas(64) Shard {
+                mutable std::shared_mutex mutex;
+                std::unique_ptr<Slot[]> slots;
+                size_t capacity = 0;
+                size_t used = 0;
+                size_t hand = 0;
+                // Keys are views into slot names
+                std::unordered_map<std::string_view, uint32_t> by_name;
+                std::unordered_map<NameId, uint32_t> by_id;
+                uint32_t next_sequence = 1;
+
+                std::atomic<size_t> misses{ 0 };
+                std::atomic<size_t> evictions{ 0 };
+            };
+
+            static constexpr size_t MAX_INLINE_NAME = 64;
+
+            std::unique_ptr<Shard[]> shards_;
+
+            // Unique lock of shard must be held
+            uint32_t Insert(Shard& shard, size_t shard_index, std::string_view key, uint64_t twitch_id);
+            uint32_t Evict(Shard& shard);
+            void Retire(Shard& shard, size_t shard_index, Slot& slot, uint64_t twitch_id);
+            NameId NextId(Shard& shard, size_t shard_index);
+            static void MarkReferenced(Slot& slot);
+        };
+
+    } // namespace domain
+
+} // namespace irc
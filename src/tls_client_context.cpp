@@ -0,0 +1,161 @@
+#include "tls_client_context.h"
+
+#include "ca_sertificates_loader.h"
+#include "logging.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <algorithm>
+
+
+namespace connection {
+
+    using namespace std::literals;
+
+    TlsClientContext& TlsClientContext::Instance() {
+        static TlsClientContext instance;
+        return instance;
+    }
+
+    // AI on
+    TlsClientContext::TlsClientContext()
+        : ctx_(std::make_shared<ssl::context>(ssl::context::tls_client))
+    {
+        SSL_CTX_set_info_callback(ctx_->native_handle(), [](const SSL*, int where, int) {
+            if (where & SSL_CB_HANDSHAKE_START) {
+                LOG_INFO("SSL Handshake starting...");
+            }
+            if (where & SSL_CB_HANDSHAKE_DONE) {
+                LOG_INFO("SSL Handshake completed!");
+            }
+            });
+
+        ctx_->set_options(
+            ssl::context::default_workarounds |
+            ssl::context::no_sslv2 |
+            ssl::context::no_sslv3 |
+            ssl::context::no_tlsv1 |
+            ssl::context::no_tlsv1_1
+        );
+
+        ctx_->set_verify_mode(ssl::verify_peer);
+
+        try {
+            ctx_->set_default_verify_paths();
+            LOG_INFO("Default verify paths set successfully");
+        }
+        catch (const std::exception& e) {
+            LOG_ERROR("set_default_verify_paths failed: "s.append(e.what()));
+        }
+
+        ssl_domain_utilities::load_windows_ca_certificates(*ctx_);
+
+        const char* ciphers =
+            "ECDHE+AESGCM:ECDHE+CHACHA20:DHE+AESGCM:DHE+CHACHA20:!aNULL:!MD5:!DSS:!RC4";
+
+        if (SSL_CTX_set_cipher_list(ctx_->native_handle(), ciphers) != 1) {
+            LOG_ERROR("Failed to set cipher list");
+        }
+
+        SSL_CTX_set_min_proto_version(ctx_->native_handle(), TLS1_2_VERSION);
+    // AI OFF
+
+        // Client side cache only: sessions are stored by us per server name, TLS 1.3 tickets
+        // arrive after handshake so they are collected from new session callback
+        SSL_CTX_set_session_cache_mode(ctx_->native_handle(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx_->native_handle(), &TlsClientContext::OnNewSession);
+    }
+
+    TlsClientContext::~TlsClientContext() {
+        ClearSessions();
+    }
+
+    std::shared_ptr<ssl::context> TlsClientContext::GetContext() const {
+        return ctx_;
+    }
+
+    void TlsClientContext::AddCertificateAuthority(std::string_view pem) {
+        ctx_->add_certificate_authority(boost::asio::buffer(pem.data(), pem.size()));
+    }
+
+    void TlsClientContext::ApplySession(SSL* ssl) const {
+        const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+        if (!server_name) {
+            return;
+        }
+        std::lock_guard lock(sessions_mutex_);
+        if (auto it = sessions_.find(server_name); it != sessions_.end()) {
+            SSL_set_session(ssl, it->second);
+        }
+    }
+
+    void TlsClientContext::OnHandshake(SSL* ssl, std::chrono::steady_clock::duration latency, bool success) {
+        if (!success) {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (SSL_session_reused(ssl)) {
+            resumed_.fetch_add(1, std::memory_order_relaxed);
+            LOG_INFO("SSL session resumed");
+        }
+        else {
+            full_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        total_latency_us_.fetch_add(latency_us, std::memory_order_relaxed);
+        int64_t max_latency = max_latency_us_.load(std::memory_order_relaxed);
+        while (latency_us > max_latency
+            && !max_latency_us_.compare_exchange_weak(max_latency, latency_us, std::memory_order_relaxed)) {
+        }
+    }
+
+    void TlsClientContext::ClearSessions() {
+        std::lock_guard lock(sessions_mutex_);
+        for (auto& [_, session] : sessions_) {
+            SSL_SESSION_free(session);
+        }
+        sessions_.clear();
+    }
+
+    HandshakeStats TlsClientContext::GetHandshakeStats() const {
+        HandshakeStats stats;
+        stats.full = full_.load(std::memory_order_relaxed);
+        stats.resumed = resumed_.load(std::memory_order_relaxed);
+        stats.failed = failed_.load(std::memory_order_relaxed);
+        stats.total_latency = std::chrono::microseconds(total_latency_us_.load(std::memory_order_relaxed));
+        stats.max_latency = std::chrono::microseconds(max_latency_us_.load(std::memory_order_relaxed));
+        return stats;
+    }
+
+    void TlsClientContext::StoreSession(std::string_view server_name, SSL_SESSION* session) {
+        std::lock_guard lock(sessions_mutex_);
+        auto [it, inserted] = sessions_.try_emplace(std::string(server_name), session);
+        if (!inserted) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+        }
+    }
+
+    int TlsClientContext::OnNewSession(SSL* ssl, SSL_SESSION* session) {
+        const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+        if (!server_name || !SSL_SESSION_is_resumable(session)) {
+            return 0;
+        }
+        // Keep a copy: session of the connection itself is marked not resumable when the connection
+        // is closed without TLS shutdown, which is how broken links usually end before reconnect
+        SSL_SESSION* copy = SSL_SESSION_dup(session);
+        if (!copy) {
+            return 0;
+        }
+        Instance().StoreSession(server_name, copy);
+        return 0;
+    }
+
+    std::shared_ptr<ssl::context> GetSSLContext() {
+        return TlsClientContext::Instance().GetContext();
+    }
+
+} // namespace connection
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <boost/asio/ssl/context.hpp>
+#include <openssl/ssl.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace connection {
+
+    namespace ssl = boost::asio::ssl;
+
+    struct HandshakeStats {
+        size_t full = 0;
+        size_t resumed = 0;
+        size_t failed = 0;
+        std::chrono::microseconds total_latency{ 0 };
+        std::chrono::microseconds max_latency{ 0 };
+    };
+
+    // Process wide client TLS state. ssl::context with CA store is built once and shared by every
+    // connection, the newest session ticket of each server name is kept so reconnect can resume it.
+    class TlsClientContext {
+    public:
+        static TlsClientContext& Instance();
+
+        TlsClientContext(const TlsClientContext&) = delete;
+        TlsClientContext& operator=(const TlsClientContext&) = delete;
+
+        ~TlsClientContext();
+
+        std::shared_ptr<ssl::context> GetContext() const;
+
+        // Trust extra PEM certificate, e.g. CA of local stand-in server
+        void AddCertificateAuthority(std::string_view pem);
+
+        // Before handshake: offers cached session of server name set by SNI
+        void ApplySession(SSL* ssl) const;
+        void OnHandshake(SSL* ssl, std::chrono::steady_clock::duration latency, bool success);
+        void ClearSessions();
+
+        HandshakeStats GetHandshakeStats() const;
+
+    private:
+        TlsClientContext();
+
+        std::shared_ptr<ssl::context> ctx_;
+
+        mutable std::mutex sessions_mutex_;
+        std::unordered_map<std::string, SSL_SESSION*> sessions_;
+
+        std::atomic<size_t> full_{ 0 };
+        std::atomic<size_t> resumed_{ 0 };
+        std::atomic<size_t> failed_{ 0 };
+        std::atomic<int64_t> total_latency_us_{ 0 };
+        std::atomic<int64_t> max_latency_us_{ 0 };
+
+        void StoreSession(std::string_view server_name, SSL_SESSION* session);
+
+        static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+    };
+
+    std::shared_ptr<ssl::context> GetSSLContext();
+
+} // namespace connection
@@ -0,0 +1,100 @@
+#include "traffic_capture.h"
+
+#include "logging.h"
+
+#include <cstring>
+#include <stdexcept>
+
+
+namespace connection {
+
+    using namespace std::literals;
+    namespace bip = boost::interprocess;
+
+    CaptureWriter::CaptureWriter(const std::string& path)
+        : file_(path, std::ios::binary | std::ios::trunc)
+        , start_(Clock::now())
+    {
+        if (!file_) {
+            throw std::runtime_error("Can't open capture file "s.append(path));
+        }
+        capture::FileHeader header{};
+        std::memcpy(header.magic, capture::MAGIC.data(), capture::MAGIC.size());
+        header.start_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void CaptureWriter::Write(uint32_t source, std::string_view bytes) {
+        if (bytes.empty()) {
+            return;
+        }
+        capture::RecordHeader record{};
+        record.offset_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start_).count());
+        record.source = source;
+        record.size = static_cast<uint32_t>(bytes.size());
+        {
+            std::lock_guard lock(mutex_);
+            file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            file_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        ++chunks_;
+        bytes_ += bytes.size();
+    }
+
+    void CaptureWriter::Flush() {
+        std::lock_guard lock(mutex_);
+        file_.flush();
+    }
+
+    CaptureStats CaptureWriter::GetStats() const {
+        return CaptureStats{ chunks_.load(), bytes_.load() };
+    }
+
+    CaptureReader::CaptureReader(const std::string& path)
+        : file_(path.c_str(), bip::read_only)
+        , region_(file_, bip::read_only)
+        , data_(static_cast<const char*>(region_.get_address()), region_.get_size())
+    {
+        capture::FileHeader header{};
+        if (data_.size() < sizeof(header)) {
+            throw std::runtime_error("Capture file is too short: "s.append(path));
+        }
+        std::memcpy(&header, data_.data(), sizeof(header));
+        if (std::string_view(header.magic, sizeof(header.magic)) != capture::MAGIC) {
+            throw std::runtime_error("Not a capture file: "s.append(path));
+        }
+        start_ns_ = header.start_ns;
+    }
+
+    std::optional<CaptureChunk> CaptureReader::Next() {
+        if (data_.size() - pos_ < sizeof(capture::RecordHeader)) {
+            return std::nullopt;
+        }
+        capture::RecordHeader record{};
+        std::memcpy(&record, data_.data() + pos_, sizeof(record));
+        const size_t begin = pos_ + sizeof(record);
+        if (data_.size() - begin < record.size) {
+            LOG_WARN("Capture ends with incomplete chunk, "s.append(std::to_string(data_.size() - pos_)).append(" bytes skipped"));
+            pos_ = data_.size();
+            return std::nullopt;
+        }
+        pos_ = begin + record.size;
+        return CaptureChunk{ std::chrono::nanoseconds(record.offset_ns), record.source, data_.substr(begin, record.size) };
+    }
+
+    void CaptureReader::Rewind() {
+        pos_ = sizeof(capture::FileHeader);
+    }
+
+    std::chrono::system_clock::time_point CaptureReader::GetStartTime() const {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(start_ns_)));
+    }
+
+    size_t CaptureReader::GetSize() const {
+        return data_.size();
+    }
+
+} // namespace connection
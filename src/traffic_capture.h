@@ -0,0 +1,99 @@
+#pragma once
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace connection {
+
+    // Capture file: header { "TWCAP1\0\0", u64 start time in ns since epoch }, then records
+    // { u64 ns since start, u32 source, u32 size, bytes }. Numbers are in host byte order.
+    // Source tells which connection received the chunk: during handover two streams are interleaved
+    namespace capture {
+
+        inline constexpr std::string_view MAGIC{ "TWCAP1\0\0", 8 };
+
+        struct FileHeader {
+            char magic[8];
+            uint64_t start_ns;
+        };
+
+        struct RecordHeader {
+            uint64_t offset_ns;
+            uint32_t source;
+            uint32_t size;
+        };
+
+        static_assert(sizeof(FileHeader) == 16);
+        static_assert(sizeof(RecordHeader) == 16);
+
+    } // namespace capture
+
+    struct CaptureStats {
+        size_t chunks = 0;
+        size_t bytes = 0;
+    };
+
+    // Appends received chunks as they are, with receive time. Shared by all connections of one client
+    class CaptureWriter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit CaptureWriter(const std::string& path);
+
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        void Write(uint32_t source, std::string_view bytes);
+        void Flush();
+
+        CaptureStats GetStats() const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::ofstream file_;
+        Clock::time_point start_;
+        std::atomic<size_t> chunks_{ 0 };
+        std::atomic<size_t> bytes_{ 0 };
+    };
+
+    struct CaptureChunk {
+        std::chrono::nanoseconds at;  // since capture start
+        uint32_t source;
+        std::string_view bytes;       // view into the mapped file
+    };
+
+    // Capture file mapped read-only, chunks are handed out without copying.
+    // A record cut by crash at the end of file is ignored
+    class CaptureReader {
+    public:
+        explicit CaptureReader(const std::string& path);
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        std::optional<CaptureChunk> Next();
+        void Rewind();
+
+        std::chrono::system_clock::time_point GetStartTime() const;
+        size_t GetSize() const;
+
+    private:
+        boost::interprocess::file_mapping file_;
+        boost::interprocess::mapped_region region_;
+        std::string_view data_;
+        size_t pos_ = sizeof(capture::FileHeader);
+        uint64_t start_ns_ = 0;
+    };
+
+} // namespace connection
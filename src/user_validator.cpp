@@ -1,17 +1,75 @@
 #include "user_validator.h"
 
+#include <algorithm>
+#include <utility>
 
 
 namespace commands {
 
     namespace user_validator {
 
-        bool UserVerificator::Verify(const std::string_view user_name, const irc::domain::Role& role) {
-            if (black_list_->count(std::string(user_name))) {
-                return false;
+        namespace {
+
+            std::string ToLowerLogin(std::string_view user_name) {
+                std::string result(user_name);
+                std::transform(result.begin(), result.end(), result.begin(), [](char ch) {
+                    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+                    });
+                return result;
+            }
+
+        } // namespace
+
+        UserVerificator::UserVerificator(std::vector<std::string>& white_list, std::vector<std::string>& black_list)
+            : UserVerificator()
+        {
+            for (const auto& user_name : white_list) {
+                Add(*white_list_, white_ids_, user_name);
+            }
+            for (const auto& user_name : black_list) {
+                Add(*black_list_, black_ids_, user_name);
+            }
+        }
+
+        UserVerificator::~UserVerificator() {
+            UnpinAll();
+        }
+
+        UserVerificator::UserVerificator(UserVerificator&& other) noexcept
+            : role_filter_(other.role_filter_)
+            , black_list_(std::move(other.black_list_))
+            , white_list_(std::move(other.white_list_))
+            , black_ids_(std::exchange(other.black_ids_, {}))
+            , white_ids_(std::exchange(other.white_ids_, {}))
+            , whitelist_only_(other.whitelist_only_)
+        {
+        }
+
+        UserVerificator& UserVerificator::operator=(UserVerificator&& other) noexcept {
+            if (this != &other) {
+                UnpinAll();
+                role_filter_ = other.role_filter_;
+                black_list_ = std::move(other.black_list_);
+                white_list_ = std::move(other.white_list_);
+                black_ids_ = std::exchange(other.black_ids_, {});
+                white_ids_ = std::exchange(other.white_ids_, {});
+                whitelist_only_ = other.whitelist_only_;
             }
-            if (white_list_->count(std::string(user_name))) {
-                return true;
+            return *this;
+        }
+
+        bool UserVerificator::Verify(const std::string_view user_name, const irc::domain::Role& role) const {
+            return Verify(irc::domain::StringInterner::Users().Find(user_name), role);
+        }
+
+        bool UserVerificator::Verify(irc::domain::NameId user, const irc::domain::Role& role) const {
+            if (user != irc::domain::NO_NAME) {
+                if (black_ids_.contains(user)) {
+                    return false;
+                }
+                if (white_ids_.contains(user)) {
+                    return true;
+                }
             }
             if (whitelist_only_) {
                 return false;
@@ -25,19 +83,47 @@ namespace commands {
 
         void UserVerificator::AddUserInWhiteList(std::string_view user_name) {
             std::cout << "Adding to white list " << user_name << std::endl;
-            white_list_->insert(std::string(user_name));
+            Add(*white_list_, white_ids_, user_name);
         }
 
         void UserVerificator::RemoveUserFromWhiteList(std::string_view user_name) {
-            white_list_->erase(std::string(user_name));
+            Remove(*white_list_, white_ids_, user_name);
         }
 
         void UserVerificator::AddUserInBlackList(std::string_view user_name) {
-            black_list_->insert(std::string(user_name));
+            Add(*black_list_, black_ids_, user_name);
         }
 
         void UserVerificator::RemoveUserFromBlackList(std::string_view user_name) {
-            black_list_->erase(std::string(user_name));
+            Remove(*black_list_, black_ids_, user_name);
+        }
+
+        // Logins are case insensitive, as twitch ones
+        void UserVerificator::Add(std::unordered_set<std::string>& names, std::unordered_set<irc::domain::NameId>& ids
+            , std::string_view user_name) {
+            if (names.insert(ToLowerLogin(user_name)).second) {
+                ids.insert(irc::domain::StringInterner::Users().Pin(user_name));
+            }
+        }
+
+        void UserVerificator::Remove(std::unordered_set<std::string>& names, std::unordered_set<irc::domain::NameId>& ids
+            , std::string_view user_name) {
+            if (names.erase(ToLowerLogin(user_name)) > 0) {
+                auto& users = irc::domain::StringInterner::Users();
+                const irc::domain::NameId id = users.Find(user_name);
+                ids.erase(id);
+                users.Unpin(id);
+            }
+        }
+
+        void UserVerificator::UnpinAll() {
+            auto& users = irc::domain::StringInterner::Users();
+            for (auto ids : { &black_ids_, &white_ids_ }) {
+                for (const auto id : *ids) {
+                    users.Unpin(id);
+                }
+                ids->clear();
+            }
         }
 
         void UserVerificator::SetRoleLevel(int level) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "message.h" // !! Role only required!!!
+#include "string_interner.h"
 
 #include <string>
 #include <string_view>
@@ -17,7 +18,7 @@ namespace commands {
 
         class RoleFilter {
         public:
-            bool CheckRole(irc::domain::Role role) {
+            bool CheckRole(irc::domain::Role role) const {
                 return role >= accept_from_;
             }
 
@@ -33,6 +34,8 @@ namespace commands {
             irc::domain::Role accept_from_ = irc::domain::Role::MODERATOR;
         };
 
+        // Lists keep lowercased logins for display and their interned ids, pinned while listed,
+        // so Verify compares integers and never allocates
         class UserVerificator {
         public:
             UserVerificator()
@@ -41,15 +44,15 @@ namespace commands {
             {
             }
 
-            UserVerificator(std::vector<std::string>& white_list, std::vector<std::string>& black_list)
-                : black_list_(std::make_unique<std::unordered_set<std::string>>
-                    (black_list.begin(), black_list.end()))
-                , white_list_(std::make_unique<std::unordered_set<std::string>>
-                    (white_list.begin(), white_list.end()))
-            {
-            }
+            UserVerificator(std::vector<std::string>& white_list, std::vector<std::string>& black_list);
+            ~UserVerificator();
 
-            bool Verify(const std::string_view user_name, const irc::domain::Role& role);
+            UserVerificator(UserVerificator&& other) noexcept;
+            UserVerificator& operator=(UserVerificator&& other) noexcept;
+
+            bool Verify(const std::string_view user_name, const irc::domain::Role& role) const;
+            // Login id of message, see Message::GetLoginId
+            bool Verify(irc::domain::NameId user, const irc::domain::Role& role) const;
 
             void SetWhiteListOnly(bool status);
             void AddUserInWhiteList(std::string_view user_name);
@@ -66,8 +69,16 @@ namespace commands {
             RoleFilter role_filter_;
             std::unique_ptr<std::unordered_set<std::string>> black_list_;
             std::unique_ptr<std::unordered_set<std::string>> white_list_;
+            std::unordered_set<irc::domain::NameId> black_ids_;
+            std::unordered_set<irc::domain::NameId> white_ids_;
             bool whitelist_only_ = false;
 
+            static void Add(std::unordered_set<std::string>& names, std::unordered_set<irc::domain::NameId>& ids
+                , std::string_view user_name);
+            static void Remove(std::unordered_set<std::string>& names, std::unordered_set<irc::domain::NameId>& ids
+                , std::string_view user_name);
+            void UnpinAll();
+
         };
 
     }
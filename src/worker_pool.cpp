@@ -0,0 +1,31 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+
+namespace commands {
+
+    WorkerPool::WorkerPool(size_t threads)
+        : pool_(std::max<size_t>(threads, 1))
+        , threads_(std::max<size_t>(threads, 1))
+    {
+    }
+
+    WorkerPool::~WorkerPool() {
+        Stop();
+    }
+
+    net::any_io_executor WorkerPool::GetExecutor() {
+        return pool_.get_executor();
+    }
+
+    size_t WorkerPool::GetThreadsCount() const {
+        return threads_;
+    }
+
+    void WorkerPool::Stop() {
+        pool_.stop();
+        pool_.join();
+    }
+
+}
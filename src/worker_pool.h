@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+
+namespace commands {
+
+    namespace net = boost::asio;
+
+    // Threads for async command executors, separate from network io_context: slow command never
+    // delays PING, parsing or other commands
+    class WorkerPool {
+    public:
+        static constexpr size_t DEFAULT_THREADS = 2;
+
+        explicit WorkerPool(size_t threads = DEFAULT_THREADS);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        net::any_io_executor GetExecutor();
+        size_t GetThreadsCount() const;
+        // Abandons queued work, returns when running handlers are done
+        void Stop();
+
+    private:
+        net::thread_pool pool_;
+        size_t threads_;
+    };
+
+}
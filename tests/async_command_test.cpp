@@ -0,0 +1,108 @@
+#include "async_command.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <memory>
+#include <string>
+
+
+namespace {
+
+    using namespace commands;
+
+    // Polls stop token and returns normally once stop is requested
+    class StoppableExecutor : public AsyncCommandExecutor {
+    public:
+        net::awaitable<void> operator()(AsyncCommandContext context) override {
+            net::steady_timer timer(co_await net::this_coro::executor);
+            while (!context.stop.stop_requested()) {
+                timer.expires_after(1ms);
+                co_await timer.async_wait(net::use_awaitable);
+            }
+        }
+    };
+
+    // Never looks at stop token: only cancellation of the awaited timer gets it out
+    class StuckExecutor : public AsyncCommandExecutor {
+    public:
+        net::awaitable<void> operator()([[maybe_unused]] AsyncCommandContext context) override {
+            net::steady_timer timer(co_await net::this_coro::executor, 1h);
+            co_await timer.async_wait(net::use_awaitable);
+        }
+    };
+
+    AsyncCommandContext MakeContext() {
+        AsyncCommandContext context;
+        context.message = irc::domain::SharedMessage::Make(irc::domain::Message(irc::domain::MessageType::PRIVMSG, std::string("!slow")));
+        return context;
+    }
+
+    TEST(AsyncCommand, DeadlineMissIsCountedOnce) {
+        net::io_context ioc;
+        auto runner = std::make_shared<AsyncCommandRunner>(std::make_unique<StoppableExecutor>()
+            , AsyncLimits{ .max_concurrent = 1, .max_queued = 1, .deadline = 10ms });
+        runner->Submit(ioc.get_executor(), MakeContext());
+        ioc.run();
+
+        const AsyncStats stats = runner->GetStats();
+        EXPECT_EQ(stats.timed_out, 1u);
+        EXPECT_EQ(stats.completed, 0u);
+        EXPECT_EQ(stats.cancelled, 0u);
+        EXPECT_EQ(stats.running, 0u);
+    }
+
+    TEST(AsyncCommand, CancelledCallIsCountedOnce) {
+        net::io_context ioc;
+        auto runner = std::make_shared<AsyncCommandRunner>(std::make_unique<StoppableExecutor>()
+            , AsyncLimits{ .max_concurrent = 1, .max_queued = 1, .deadline = 10s });
+        runner->Submit(ioc.get_executor(), MakeContext());
+        runner->Submit(ioc.get_executor(), MakeContext());
+        ioc.poll();
+        runner->Cancel();
+        ioc.run();
+
+        const AsyncStats stats = runner->GetStats();
+        EXPECT_EQ(stats.cancelled, 2u);
+        EXPECT_EQ(stats.completed, 0u);
+        EXPECT_EQ(stats.timed_out, 0u);
+    }
+
+    // One slot: a call that ignores the token must not keep it after deadline
+    TEST(AsyncCommand, DeadlineAbortsCallIgnoringStopToken) {
+        net::io_context ioc;
+        auto runner = std::make_shared<AsyncCommandRunner>(std::make_unique<StuckExecutor>()
+            , AsyncLimits{ .max_concurrent = 1, .max_queued = 4, .deadline = 10ms });
+        for (int i = 0; i < 3; ++i) {
+            runner->Submit(ioc.get_executor(), MakeContext());
+        }
+        ioc.run_for(5s);
+
+        const AsyncStats stats = runner->GetStats();
+        EXPECT_EQ(stats.timed_out, 3u);
+        EXPECT_EQ(stats.failed, 0u);
+        EXPECT_EQ(stats.running, 0u);
+        EXPECT_EQ(stats.queued, 0u);
+    }
+
+    TEST(AsyncCommand, CancelAbortsCallIgnoringStopToken) {
+        net::io_context ioc;
+        auto runner = std::make_shared<AsyncCommandRunner>(std::make_unique<StuckExecutor>()
+            , AsyncLimits{ .max_concurrent = 2, .max_queued = 1, .deadline = 10s });
+        runner->Submit(ioc.get_executor(), MakeContext());
+        runner->Submit(ioc.get_executor(), MakeContext());
+        ioc.poll();
+        runner->Cancel();
+        ioc.run_for(5s);
+
+        const AsyncStats stats = runner->GetStats();
+        EXPECT_EQ(stats.cancelled, 2u);
+        EXPECT_EQ(stats.failed, 0u);
+        EXPECT_EQ(stats.running, 0u);
+    }
+
+} // namespace
@@ -0,0 +1,168 @@
+#include "chat_bot.h"
+#include "message_processor.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    using namespace std::literals;
+
+    class CountingExecutor : public commands::ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        explicit CountingExecutor(std::atomic<size_t>& calls)
+            : calls_(calls)
+        {
+        }
+
+        void operator()([[maybe_unused]] std::string_view arguments) override {
+            calls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<size_t>& calls_;
+    };
+
+    constexpr size_t MESSAGES = 2000;
+    constexpr size_t THREADS = 4;
+
+    // Same chat line from broadcaster, passes any role check
+    std::vector<irc::domain::Message> MakeChat(size_t count, std::string_view text = "hello chat") {
+        std::string raw_bytes;
+        for (size_t i = 0; i < count; ++i) {
+            raw_bytes.append("@badges=broadcaster/1;user-id=1 :user!user@user.tmi.twitch.tv PRIVMSG #channel :")
+                .append(text).append("\r\n");
+        }
+        irc::message_processor::MessageProcessor processor;
+        size_t consumed = 0;
+        return processor.GetMessagesFromRawBytes(raw_bytes, consumed);
+    }
+
+    // ioc run by several threads until Join
+    class Dispatcher {
+    public:
+        Dispatcher()
+            : work_(boost::asio::make_work_guard(ioc_))
+        {
+            for (size_t i = 0; i < THREADS; ++i) {
+                threads_.emplace_back([this]() {
+                    ioc_.run();
+                    });
+            }
+        }
+
+        boost::asio::io_context& GetContext() {
+            return ioc_;
+        }
+
+        void Join() {
+            work_.reset();
+            for (auto& thread : threads_) {
+                thread.join();
+            }
+        }
+
+    private:
+        boost::asio::io_context ioc_;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+        std::vector<std::thread> threads_;
+    };
+
+    // Triggers change while worker threads dispatch modes: every message still sees a whole mode set
+    TEST(ChatBot, ModesChangeWhileMessagesAreDispatched) {
+        Dispatcher dispatcher;
+        auto bot = std::make_shared<chat_bot::ChatBot>(dispatcher.GetContext());
+        std::atomic<size_t> every_message{ 0 };
+        std::atomic<size_t> triggered{ 0 };
+        bot->AddMode("every", chat_bot::Mode(std::make_unique<CountingExecutor>(every_message)));
+        bot->AddMode("keyword", chat_bot::Mode(std::make_unique<CountingExecutor>(triggered)));
+        ASSERT_TRUE(bot->AddModeTrigger("keyword", "never said"));
+        EXPECT_FALSE(bot->AddModeTrigger("missing", "hello"));
+
+        auto messages = MakeChat(MESSAGES);
+        ASSERT_EQ(messages.size(), MESSAGES);
+        for (size_t i = 0; i < MESSAGES; ++i) {
+            bot->ParseAndExecute(std::move(messages[i]));
+            if (i % 100 == 0) {
+                bot->AddModeTrigger("keyword", "word"s.append(std::to_string(i)));
+            }
+        }
+        dispatcher.Join();
+
+        EXPECT_EQ(every_message.load(), MESSAGES);
+        EXPECT_EQ(triggered.load(), 0u);
+    }
+
+    // Mode of the same name is replaced while old one may be running: each message runs exactly one of them
+    TEST(ChatBot, ModeReplacedWhileMessagesAreDispatched) {
+        constexpr size_t VERSIONS = 20;
+
+        Dispatcher dispatcher;
+        auto bot = std::make_shared<chat_bot::ChatBot>(dispatcher.GetContext());
+        std::vector<std::atomic<size_t>> calls(VERSIONS);
+        bot->AddMode("every", chat_bot::Mode(std::make_unique<CountingExecutor>(calls[0])));
+
+        auto messages = MakeChat(MESSAGES);
+        ASSERT_EQ(messages.size(), MESSAGES);
+        for (size_t i = 0; i < MESSAGES; ++i) {
+            bot->ParseAndExecute(std::move(messages[i]));
+            if (i > 0 && i % (MESSAGES / VERSIONS) == 0) {
+                bot->AddMode("every", chat_bot::Mode(std::make_unique<CountingExecutor>(calls[i / (MESSAGES / VERSIONS)])));
+            }
+        }
+        dispatcher.Join();
+
+        size_t total = 0;
+        for (const auto& version_calls : calls) {
+            total += version_calls.load();
+        }
+        EXPECT_EQ(total, MESSAGES);
+        EXPECT_GT(calls.back().load(), 0u);
+    }
+
+    // Command is replaced and its alias moves while messages are matched: each message runs one version
+    TEST(ChatBot, CommandsChangeWhileMessagesAreDispatched) {
+        constexpr size_t VERSIONS = 20;
+
+        Dispatcher dispatcher;
+        auto bot = std::make_shared<chat_bot::ChatBot>(dispatcher.GetContext());
+        std::vector<std::atomic<size_t>> calls(VERSIONS);
+        std::atomic<size_t> other_calls{ 0 };
+        bot->AddCommand("test", commands::Command(std::make_unique<CountingExecutor>(calls[0])));
+        bot->AddCommand("other", commands::Command(std::make_unique<CountingExecutor>(other_calls)));
+
+        auto messages = MakeChat(MESSAGES, "!TEST arguments");
+        ASSERT_EQ(messages.size(), MESSAGES);
+        for (size_t i = 0; i < MESSAGES; ++i) {
+            bot->ParseAndExecute(std::move(messages[i]));
+            if (i > 0 && i % (MESSAGES / VERSIONS) == 0) {
+                bot->AddCommand("test", commands::Command(std::make_unique<CountingExecutor>(calls[i / (MESSAGES / VERSIONS)])));
+                EXPECT_TRUE(bot->AddCommandAlias("test alias", "other"));
+                EXPECT_TRUE(bot->RemoveCommand("test alias"));
+                bot->AddCommand("other", commands::Command(std::make_unique<CountingExecutor>(other_calls)));
+            }
+        }
+        dispatcher.Join();
+
+        size_t total = 0;
+        for (const auto& version_calls : calls) {
+            total += version_calls.load();
+        }
+        EXPECT_EQ(total, MESSAGES);
+        EXPECT_GT(calls.back().load(), 0u);
+        EXPECT_EQ(other_calls.load(), 0u);
+    }
+
+} // namespace
@@ -0,0 +1,102 @@
+#include "command.h"
+#include "command_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace {
+
+    using namespace commands;
+
+    // Executor overriding nothing must not compile into a silent no-op
+    static_assert(std::is_abstract_v<BaseCommandExecutor>);
+    static_assert(std::is_abstract_v<ArgumentsCommandExecutor>);
+
+    class RecordingExecutor : public ArgumentsCommandExecutor {
+    public:
+        using ArgumentsCommandExecutor::operator();
+
+        void operator()(std::string_view arguments) override {
+            last_ = arguments;
+        }
+
+        const std::string& GetLast() const {
+            return last_;
+        }
+
+    private:
+        std::string last_;
+    };
+
+    TEST(CommandExecutor, ArgumentsExecutorGetsContextArguments) {
+        const irc::domain::Message message(irc::domain::MessageType::PRIVMSG, std::string("!echo hello"));
+        RecordingExecutor executor;
+        BaseCommandExecutor& base = executor;
+
+        base(CommandContext{ .message = message, .arguments = "hello", .channel = "channel", .login = "user" });
+        EXPECT_EQ(executor.GetLast(), "hello");
+    }
+
+    // Arguments and login are made from user id, so a call that sees a context of another call is caught
+    class ContextCheckingExecutor : public BaseCommandExecutor {
+    public:
+        void operator()(const CommandContext& context) override {
+            const std::string expected = std::to_string(context.user);
+            if (context.arguments != expected || context.login != expected) {
+                mismatches_.fetch_add(1, std::memory_order_relaxed);
+            }
+            calls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        size_t GetCalls() const {
+            return calls_.load();
+        }
+
+        size_t GetMismatches() const {
+            return mismatches_.load();
+        }
+
+    private:
+        std::atomic<size_t> calls_{ 0 };
+        std::atomic<size_t> mismatches_{ 0 };
+    };
+
+    // One command from several threads at once, contexts are built on stack of each call.
+    // Build with -DTWITCH_BOT_SANITIZE_THREAD=ON to run it under ThreadSanitizer
+    TEST(CommandExecutor, OneCommandRunsOnManyThreads) {
+        constexpr size_t THREADS = 8;
+        constexpr size_t CALLS = 2000;
+
+        auto executor = std::make_unique<ContextCheckingExecutor>();
+        const ContextCheckingExecutor& checker = *executor;
+        const Command command(std::move(executor));
+        const irc::domain::Message message(irc::domain::MessageType::PRIVMSG, std::string("!test"));
+
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread < THREADS; ++thread) {
+            threads.emplace_back([&command, &message, thread]() {
+                for (size_t call = 0; call < CALLS; ++call) {
+                    const auto user = static_cast<irc::domain::NameId>(thread * CALLS + call + 1);
+                    const std::string text = std::to_string(user);
+                    command.Execute(CommandContext{ .message = message, .arguments = text, .channel = "channel"
+                        , .login = text, .user = user, .role = irc::domain::Role::BROADCASTER });
+                }
+                });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(checker.GetCalls(), THREADS * CALLS);
+        EXPECT_EQ(checker.GetMismatches(), 0u);
+    }
+
+} // namespace
@@ -0,0 +1,118 @@
+#include "command_registry.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string_view>
+
+
+namespace {
+
+    using commands::Command;
+    using commands::CommandRegistry;
+    using namespace std::literals;
+
+    TEST(CommandRegistryTest, NamesIgnoreAsciiCase) {
+        CommandRegistry registry;
+        const Command* song = &registry.Add("Song", Command());
+        EXPECT_EQ(registry.Find("song"), song);
+        EXPECT_EQ(registry.Find("SONG"), song);
+        EXPECT_TRUE(registry.AddAlias("MUSIC", "sOnG"));
+        EXPECT_EQ(registry.Find("music"), song);
+
+        const auto match = registry.Match("SoNg next please");
+        EXPECT_EQ(match.command, song);
+        // Name and arguments are views of the text as written
+        EXPECT_EQ(match.name, "SoNg"sv);
+        EXPECT_EQ(match.arguments, "next please"sv);
+    }
+
+    TEST(CommandRegistryTest, AliasTakeover) {
+        CommandRegistry registry;
+        const Command* song = &registry.Add("song", Command());
+        const Command* skip = &registry.Add("skip", Command());
+        ASSERT_TRUE(registry.AddAlias("next", "song"));
+        EXPECT_TRUE(registry.AddAlias("next", "song"));
+        // Alias of another command is not taken by AddAlias
+        EXPECT_FALSE(registry.AddAlias("next", "skip"));
+        EXPECT_FALSE(registry.AddAlias("skip", "song"));
+        EXPECT_FALSE(registry.AddAlias("later", "missing"));
+        EXPECT_EQ(registry.Find("next"), song);
+
+        // New command of alias name takes it over, the old command keeps its own name
+        const Command* next = &registry.Add("NEXT", Command());
+        EXPECT_NE(next, song);
+        EXPECT_EQ(registry.Find("next"), next);
+        EXPECT_EQ(registry.Find("song"), song);
+        EXPECT_EQ(registry.Find("skip"), skip);
+        EXPECT_EQ(registry.GetSize(), 3u);
+
+        // Removing song doesn't remove the name it lost
+        EXPECT_TRUE(registry.Remove("song"));
+        EXPECT_EQ(registry.Find("next"), next);
+        EXPECT_EQ(registry.Find("song"), nullptr);
+        EXPECT_TRUE(registry.AddAlias("song", "next"));
+        EXPECT_EQ(registry.Find("song"), next);
+    }
+
+    TEST(CommandRegistryTest, LongestMultiWordMatch) {
+        CommandRegistry registry;
+        const Command* song = &registry.Add("song", Command());
+        const Command* skip = &registry.Add("song skip", Command());
+        const Command* now = &registry.Add("song skip now", Command());
+        // "queue" is only the first word of a longer name
+        const Command* clear = &registry.Add("queue clear all", Command());
+
+        auto match = registry.Match("song skip now please");
+        EXPECT_EQ(match.command, now);
+        EXPECT_EQ(match.arguments, "please"sv);
+
+        match = registry.Match("song skip later");
+        EXPECT_EQ(match.command, skip);
+        EXPECT_EQ(match.name, "song skip"sv);
+        EXPECT_EQ(match.arguments, "later"sv);
+
+        match = registry.Match("song skipped");
+        EXPECT_EQ(match.command, song);
+        EXPECT_EQ(match.arguments, "skipped"sv);
+
+        match = registry.Match("Song Skip");
+        EXPECT_EQ(match.command, skip);
+        EXPECT_TRUE(match.arguments.empty());
+
+        EXPECT_EQ(registry.Match("queue clear").command, nullptr);
+        EXPECT_EQ(registry.Match("queue").command, nullptr);
+        EXPECT_EQ(registry.Match("queue clear all now").command, clear);
+        EXPECT_EQ(registry.Match("").command, nullptr);
+        EXPECT_EQ(registry.Match(" song").command, nullptr);
+
+        // Removed subcommand falls back to the shorter name
+        EXPECT_TRUE(registry.Remove("song skip"));
+        match = registry.Match("song skip later");
+        EXPECT_EQ(match.command, song);
+        EXPECT_EQ(match.arguments, "skip later"sv);
+        EXPECT_EQ(registry.Match("song skip now").command, now);
+    }
+
+    TEST(CommandRegistryTest, RejectsInvalidNames) {
+        CommandRegistry registry;
+        EXPECT_THROW(registry.Add("", Command()), std::invalid_argument);
+        EXPECT_THROW(registry.Add(" song", Command()), std::invalid_argument);
+        EXPECT_THROW(registry.Add("song  skip", Command()), std::invalid_argument);
+        EXPECT_THROW(registry.Add("a b c d e", Command()), std::invalid_argument);
+        registry.Add("song", Command());
+        EXPECT_FALSE(registry.AddAlias("song ", "song"));
+    }
+
+    TEST(CommandRegistryTest, CopyKeepsReplacedCommand) {
+        CommandRegistry registry;
+        registry.Add("song", Command());
+        const CommandRegistry copy = registry;
+        const Command* old = copy.Find("song");
+        registry.Add("song", Command());
+        EXPECT_NE(registry.Find("song"), old);
+        EXPECT_EQ(copy.Find("song"), old);
+        EXPECT_EQ(copy.Match("song").command, old);
+    }
+
+} // namespace
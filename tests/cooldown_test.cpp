@@ -0,0 +1,141 @@
+#include "cooldown.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace {
+
+    using commands::Cooldown;
+    using commands::CooldownLimits;
+    using commands::CooldownTable;
+    using commands::CooldownTracker;
+    using Clock = CooldownTracker::Clock;
+    using namespace std::chrono_literals;
+
+    constexpr irc::domain::NameId CHANNEL = 1;
+
+    TEST(CooldownTest, BurstThenOneCallPerPeriod) {
+        CooldownLimits limits;
+        limits.per_user = { 1000ms, 3 };
+        CooldownTracker tracker(limits);
+        const auto start = Clock::now();
+
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start));
+        }
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 10, start));
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 10, start + 999ms));
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start + 1000ms));
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 10, start + 1999ms));
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start + 2000ms));
+        // Another user has own bucket
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 11, start + 2000ms));
+
+        // Quiet for burst periods fills the bucket again
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start + 5000ms));
+        }
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 10, start + 5000ms));
+
+        const auto stats = tracker.GetStats();
+        EXPECT_EQ(stats.allowed, 9u);
+        EXPECT_EQ(stats.limited_user, 4u);
+    }
+
+    TEST(CooldownTest, LimitedCallSpendsNothing) {
+        CooldownLimits limits;
+        limits.per_channel = { 1000ms, 1 };
+        limits.per_user = { 1000ms, 1 };
+        CooldownTracker tracker(limits);
+        const auto start = Clock::now();
+
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start));
+        EXPECT_FALSE(tracker.TryAcquire(2, 10, start + 500ms));
+        // Refused by user level, channel 2 is still free
+        EXPECT_TRUE(tracker.TryAcquire(2, 11, start + 500ms));
+        EXPECT_EQ(tracker.GetStats().limited_user, 1u);
+    }
+
+    TEST(CooldownTest, TimesWrapIn32Bits) {
+        const Cooldown cooldown{ 1000ms, 1 };
+        CooldownTable table(16);
+        const uint32_t before_wrap = UINT32_MAX - 100;
+        table.Advance(before_wrap);
+        table.Take(10, before_wrap, cooldown);
+
+        EXPECT_EQ(table.Check(10, before_wrap + 500, cooldown), CooldownTable::Verdict::LIMITED);
+        EXPECT_EQ(table.Check(10, before_wrap + 999, cooldown), CooldownTable::Verdict::LIMITED);
+        EXPECT_EQ(table.Check(10, before_wrap + 1000, cooldown), CooldownTable::Verdict::ALLOWED);
+
+        table.Advance(before_wrap + 500);
+        EXPECT_EQ(table.GetSize(), 1u);
+        table.Advance(before_wrap + 2000);
+        EXPECT_EQ(table.GetSize(), 0u);
+    }
+
+    TEST(CooldownTest, TrackerWorksAcrossMillisecondWrap) {
+        CooldownLimits limits;
+        limits.per_user = { 1000ms, 1 };
+        CooldownTracker tracker(limits);
+        const auto before_wrap = Clock::now() + std::chrono::milliseconds(UINT32_MAX - 100);
+
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, before_wrap));
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 10, before_wrap + 500ms));
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, before_wrap + 1000ms));
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 11, before_wrap + 20s));
+        EXPECT_EQ(tracker.GetStats().tracked_users, 1u);
+    }
+
+    TEST(CooldownTest, ExpiredUsersLeaveTable) {
+        CooldownLimits limits;
+        limits.per_user = { 100ms, 1 };
+        CooldownTracker tracker(limits);
+        const auto start = Clock::now();
+
+        for (irc::domain::NameId user = 1; user <= 1000; ++user) {
+            EXPECT_TRUE(tracker.TryAcquire(CHANNEL, user, start));
+        }
+        EXPECT_EQ(tracker.GetStats().tracked_users, 1000u);
+
+        // Later than one wheel turn: every key is visited and expired
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 5000, start + 20s));
+        EXPECT_EQ(tracker.GetStats().tracked_users, 1u);
+        // Expired user is the same as a new one
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 1, start + 20s));
+    }
+
+    TEST(CooldownTest, FullTableFallsBackToOtherLevels) {
+        CooldownLimits limits;
+        limits.per_channel = { 1000ms, 3 };
+        limits.per_user = { 1000ms, 1 };
+        limits.max_tracked = 2;
+        CooldownTracker tracker(limits);
+        const auto start = Clock::now();
+
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 10, start));
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 11, start));
+        // No room for user 12: only channel level is checked and it still has burst left
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 12, start));
+        auto stats = tracker.GetStats();
+        EXPECT_EQ(stats.overflowed, 1u);
+        EXPECT_EQ(stats.tracked_users, 2u);
+
+        // Channel burst is spent, untracked user is still limited by it
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 13, start));
+        stats = tracker.GetStats();
+        EXPECT_EQ(stats.allowed, 3u);
+        EXPECT_EQ(stats.limited_channel, 1u);
+        EXPECT_EQ(stats.overflowed, 1u);
+
+        // Tracked users expire and make room again
+        EXPECT_TRUE(tracker.TryAcquire(CHANNEL, 12, start + 20s));
+        EXPECT_FALSE(tracker.TryAcquire(CHANNEL, 12, start + 20s + 500ms));
+        stats = tracker.GetStats();
+        EXPECT_EQ(stats.tracked_users, 1u);
+        EXPECT_EQ(stats.limited_user, 1u);
+    }
+
+} // namespace
@@ -0,0 +1,59 @@
+#include "join_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <memory>
+
+
+namespace {
+
+    using namespace irc;
+
+    // No connection behind outbound: lines stay queued, channels wait for echo in JOINING
+    TEST(JoinScheduler, StandbySettlesOnItsOwnEchoes) {
+        boost::asio::io_context ioc;
+        auto limiter = std::make_shared<outbound::RateLimiter>();
+        auto primary = std::make_shared<membership::JoinScheduler>(ioc
+            , std::make_shared<outbound::OutboundScheduler>(ioc, limiter));
+        primary->SetNick("Bot");
+        primary->Join("#first");
+        primary->Join("#second");
+        ioc.poll();
+
+        auto standby = primary->Fork(std::make_shared<outbound::OutboundScheduler>(ioc, limiter));
+        ioc.restart();
+        ioc.poll();
+        ASSERT_EQ(standby->GetStats().joining, 2u);
+        EXPECT_FALSE(standby->IsSettled());
+
+        const domain::NameId nick = domain::StringInterner::Users().Find("bot");
+        auto& channels = domain::StringInterner::Channels();
+        standby->OnMembership(domain::MessageType::JOIN, nick, channels.Find("first"));
+        standby->OnMembership(domain::MessageType::JOIN, nick, channels.Find("second"));
+        EXPECT_TRUE(standby->IsSettled());
+
+        primary->TakeOver(*standby);
+        EXPECT_TRUE(primary->IsSettled());
+        EXPECT_EQ(primary->GetStats().pending, 0u);
+    }
+
+    // Channel seen with other room-id while joining: JOIN echo of the name still confirms it
+    TEST(JoinScheduler, JoinConfirmedAfterRoomIdChange) {
+        boost::asio::io_context ioc;
+        auto joins = std::make_shared<membership::JoinScheduler>(ioc
+            , std::make_shared<outbound::OutboundScheduler>(ioc, std::make_shared<outbound::RateLimiter>()));
+        joins->SetNick("Bot");
+        joins->Join("#renamed");
+        ioc.poll();
+
+        auto& channels = domain::StringInterner::Channels();
+        channels.Intern("renamed", 1);
+        channels.Intern("renamed", 2);
+        joins->OnMembership(domain::MessageType::JOIN, domain::StringInterner::Users().Find("bot"), channels.Find("renamed"));
+        EXPECT_TRUE(joins->IsSettled());
+        EXPECT_TRUE(joins->IsJoined("#renamed"));
+    }
+
+} // namespace
@@ -0,0 +1,126 @@
+#include "keyword_matcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+    using commands::KeywordMatcher;
+    using namespace std::literals;
+
+    KeywordMatcher Make(const std::vector<std::pair<std::string_view, uint32_t>>& keywords) {
+        KeywordMatcher matcher;
+        for (const auto& [keyword, value] : keywords) {
+            matcher.Add(keyword, value);
+        }
+        matcher.Build();
+        return matcher;
+    }
+
+    // Values of every occurrence, sorted: order within one position is not part of the contract
+    std::vector<uint32_t> Scan(const KeywordMatcher& matcher, std::string_view text) {
+        std::vector<uint32_t> values;
+        matcher.Scan(text, [&values](uint32_t value) {
+            values.push_back(value);
+            });
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    std::vector<uint32_t> ScanNaive(const std::vector<std::pair<std::string, uint32_t>>& keywords, std::string_view text) {
+        auto lower = [](std::string_view s) {
+            std::string result(s);
+            for (char& ch : result) {
+                ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            }
+            return result;
+        };
+        const std::string lowered = lower(text);
+        std::vector<uint32_t> values;
+        for (const auto& [keyword, value] : keywords) {
+            const std::string needle = lower(keyword);
+            for (size_t pos = lowered.find(needle); pos != std::string::npos; pos = lowered.find(needle, pos + 1)) {
+                values.push_back(value);
+            }
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    TEST(KeywordMatcherTest, OverlappingAndNestedKeywords) {
+        const auto matcher = Make({ { "he", 1 }, { "she", 2 }, { "his", 3 }, { "hers", 4 } });
+        EXPECT_EQ(Scan(matcher, "ushers"), (std::vector<uint32_t>{ 1, 2, 4 }));
+        EXPECT_EQ(Scan(matcher, "shehishers"), (std::vector<uint32_t>{ 1, 1, 2, 2, 3, 4 }));
+        EXPECT_EQ(Scan(matcher, "hhhe"), (std::vector<uint32_t>{ 1 }));
+        EXPECT_TRUE(Scan(matcher, "h e s h").empty());
+    }
+
+    TEST(KeywordMatcherTest, OutputsOfFailureStatesAreMerged) {
+        // State of "abcd" prefix "abc" fails to "bc", which fails to "c"
+        const auto matcher = Make({ { "abcd", 1 }, { "bc", 2 }, { "c", 3 } });
+        EXPECT_EQ(Scan(matcher, "abcx"), (std::vector<uint32_t>{ 2, 3 }));
+        EXPECT_EQ(Scan(matcher, "abcd"), (std::vector<uint32_t>{ 1, 2, 3 }));
+        // Failure link continues a match that the failed branch started
+        EXPECT_EQ(Scan(matcher, "abbcd"), (std::vector<uint32_t>{ 2, 3 }));
+    }
+
+    TEST(KeywordMatcherTest, IgnoresAsciiCase) {
+        const auto matcher = Make({ { "HeLLo", 1 }, { "[x]", 2 } });
+        EXPECT_EQ(Scan(matcher, "hello HELLO hElLo"), (std::vector<uint32_t>{ 1, 1, 1 }));
+        EXPECT_EQ(Scan(matcher, "[X]"), (std::vector<uint32_t>{ 2 }));
+        // Only letters fold, '{' is not '['
+        EXPECT_TRUE(Scan(matcher, "{x}").empty());
+    }
+
+    TEST(KeywordMatcherTest, SharedPrefixKeepsOwnValue) {
+        const auto matcher = Make({ { "hell", 1 }, { "hello", 2 }, { "help", 3 }, { "hello", 4 } });
+        EXPECT_EQ(Scan(matcher, "hello"), (std::vector<uint32_t>{ 1, 2, 4 }));
+        EXPECT_EQ(Scan(matcher, "help"), (std::vector<uint32_t>{ 3 }));
+        EXPECT_EQ(Scan(matcher, "hel"), (std::vector<uint32_t>{}));
+    }
+
+    TEST(KeywordMatcherTest, SameAsNaiveSearch) {
+        std::mt19937 random(42);
+        auto make_string = [&random](size_t size) {
+            static constexpr std::string_view ALPHABET = "abcAB "sv;
+            std::string result;
+            for (size_t i = 0; i < size; ++i) {
+                result.push_back(ALPHABET[random() % ALPHABET.size()]);
+            }
+            return result;
+        };
+        for (size_t round = 0; round < 200; ++round) {
+            std::vector<std::pair<std::string, uint32_t>> keywords;
+            KeywordMatcher matcher;
+            for (uint32_t value = 0; value < 8; ++value) {
+                keywords.emplace_back(make_string(1 + random() % 4), value);
+                matcher.Add(keywords.back().first, value);
+            }
+            matcher.Build();
+            const std::string text = make_string(100);
+            EXPECT_EQ(Scan(matcher, text), ScanNaive(keywords, text)) << text;
+        }
+    }
+
+    TEST(KeywordMatcherTest, RebuildAfterClear) {
+        KeywordMatcher matcher;
+        EXPECT_THROW(matcher.Add("", 1), std::invalid_argument);
+        EXPECT_TRUE(Scan(matcher, "anything").empty());
+        matcher.Add("old", 1);
+        matcher.Build();
+        matcher.Clear();
+        matcher.Add("new", 2);
+        matcher.Build();
+        EXPECT_EQ(Scan(matcher, "old new"), (std::vector<uint32_t>{ 2 }));
+    }
+
+} // namespace
@@ -0,0 +1,123 @@
+#include "line_splitter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::message_processor::LineRange;
+    using irc::message_processor::LineSplitter;
+    using irc::message_processor::ScanKind;
+    using namespace std::literals;
+
+    constexpr ScanKind VECTOR_KINDS[] = { ScanKind::SSE2, ScanKind::AVX2 };
+
+    struct SplitResult {
+        std::vector<std::string_view> lines;
+        size_t consumed = 0;
+    };
+
+    SplitResult Split(std::string_view bytes, ScanKind kind) {
+        std::vector<LineRange> ranges;
+        SplitResult result;
+        result.consumed = LineSplitter::Split(bytes, ranges, kind);
+        for (const auto& range : ranges) {
+            result.lines.push_back(bytes.substr(range.begin, range.size));
+        }
+        return result;
+    }
+
+    // Every vector kernel the CPU runs must give the same ranges and consumed size as the scalar one
+    void ExpectSameAsScalar(std::string_view bytes) {
+        const SplitResult expected = Split(bytes, ScanKind::SCALAR);
+        for (ScanKind kind : VECTOR_KINDS) {
+            if (!LineSplitter::IsSupported(kind)) {
+                continue;
+            }
+            const SplitResult result = Split(bytes, kind);
+            EXPECT_EQ(result.lines, expected.lines) << LineSplitter::GetKindName(kind) << " on size " << bytes.size();
+            EXPECT_EQ(result.consumed, expected.consumed) << LineSplitter::GetKindName(kind) << " on size " << bytes.size();
+        }
+    }
+
+    TEST(LineSplitterTest, ScalarSplitsCrlfLinesOnly) {
+        const SplitResult result = Split("a\nb\r\n\r\nc\rd\r\ntail"sv, ScanKind::SCALAR);
+        EXPECT_EQ(result.lines, (std::vector{ "a\nb"sv, ""sv, "c\rd"sv }));
+        EXPECT_EQ(result.consumed, "a\nb\r\n\r\nc\rd\r\n"sv.size());
+    }
+
+    TEST(LineSplitterTest, CrlfAcrossStepBoundary) {
+        std::string bytes(63, 'x');
+        bytes.append("\r\n");
+        bytes.append(70, 'y');
+        bytes.append("\r\n");
+        const SplitResult scalar = Split(bytes, ScanKind::SCALAR);
+        ASSERT_EQ(scalar.lines.size(), 2u);
+        EXPECT_EQ(scalar.lines[0].size(), 63u);
+        ExpectSameAsScalar(bytes);
+    }
+
+    TEST(LineSplitterTest, CrlfAtEveryPosition) {
+        for (size_t position = 0; position < 200; ++position) {
+            std::string bytes(position, 'x');
+            bytes.append("\r\n");
+            bytes.append(position % 7, 'z');
+            ExpectSameAsScalar(bytes);
+        }
+    }
+
+    TEST(LineSplitterTest, BareLineFeedAndCarriageReturn) {
+        std::string bytes;
+        for (size_t i = 0; i < 40; ++i) {
+            bytes.append("bare\nline\rend\r\n");
+        }
+        ExpectSameAsScalar(bytes);
+        ExpectSameAsScalar(std::string(130, '\n'));
+        ExpectSameAsScalar(std::string(130, '\r'));
+    }
+
+    TEST(LineSplitterTest, EmptyLines) {
+        std::string bytes;
+        for (size_t i = 0; i < 100; ++i) {
+            bytes.append("\r\n");
+        }
+        EXPECT_EQ(Split(bytes, ScanKind::SCALAR).lines.size(), 100u);
+        ExpectSameAsScalar(bytes);
+        ExpectSameAsScalar("x"s.append(bytes));
+    }
+
+    TEST(LineSplitterTest, UnterminatedTail) {
+        std::string bytes;
+        for (size_t i = 0; i < 10; ++i) {
+            bytes.append("PRIVMSG #channel :hello chat\r\n");
+        }
+        for (size_t tail = 0; tail < 100; ++tail) {
+            std::string with_tail = bytes;
+            with_tail.append(tail, 't');
+            with_tail.append("\r");
+            EXPECT_EQ(Split(with_tail, ScanKind::SCALAR).consumed, bytes.size());
+            ExpectSameAsScalar(with_tail);
+        }
+    }
+
+    TEST(LineSplitterTest, ShorterThanStep) {
+        const std::string_view inputs[] = { ""sv, "\r"sv, "\n"sv, "\r\n"sv, "a\r\nb"sv, "\n\r\n\r"sv
+            , "PING :tmi.twitch.tv\r\n"sv, "PING :tmi.twitch.tv\r\nPONG"sv };
+        for (auto bytes : inputs) {
+            ExpectSameAsScalar(bytes);
+        }
+        for (size_t size = 0; size < 64; ++size) {
+            std::string bytes(size, 'x');
+            if (size >= 2) {
+                bytes[size - 2] = '\r';
+                bytes[size - 1] = '\n';
+            }
+            ExpectSameAsScalar(bytes);
+        }
+    }
+
+} // namespace
@@ -0,0 +1,56 @@
+#include "alloc_counter.h"
+#include "chat_corpus.h"
+
+#include "message_processor.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::domain::Message;
+    using irc::domain::MessageType;
+    using irc::message_processor::MessageProcessor;
+
+    constexpr size_t TRAFFIC_SIZE = 256 * 1024;
+    constexpr size_t CHUNK_SIZE = 4096;
+
+    // Parses traffic in read sized chunks, tail goes to the next chunk the way ReadBuffer keeps it
+    size_t ParseInChunks(MessageProcessor& processor, std::string_view traffic, std::vector<Message>& messages) {
+        size_t parsed = 0;
+        size_t begin = 0;
+        for (size_t end = std::min(CHUNK_SIZE, traffic.size()); ; end = std::min(end + CHUNK_SIZE, traffic.size())) {
+            size_t consumed = 0;
+            processor.GetMessagesFromRawBytes(traffic.substr(begin, end - begin), consumed, messages);
+            for (const auto& message : messages) {
+                parsed += message.GetMessageType() == MessageType::PRIVMSG && !message.GetContent().empty();
+            }
+            begin += consumed;
+            if (end == traffic.size()) {
+                break;
+            }
+        }
+        return parsed;
+    }
+
+    TEST(MessageProcessorTest, WarmedUpPrivmsgParsingDoesNotAllocate) {
+        const std::string traffic = benchmarks::ChatCorpus::MakeTraffic(TRAFFIC_SIZE);
+        MessageProcessor processor;
+        std::vector<Message> messages;
+        const size_t expected = ParseInChunks(processor, traffic, messages);
+        ASSERT_GT(expected, 0u);
+
+        benchmarks::AllocationScope scope;
+        const size_t parsed = ParseInChunks(processor, traffic, messages);
+        const size_t allocations = scope.Count();
+
+        EXPECT_EQ(parsed, expected);
+        EXPECT_EQ(allocations, 0u);
+    }
+
+} // namespace
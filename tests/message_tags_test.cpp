@@ -0,0 +1,31 @@
+#include "message_processor.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+
+    using irc::message_processor::MessageProcessor;
+    using namespace std::literals;
+
+    // Content of these types is the whole line, tags included
+    TEST(MessageTags, DecodingKeepsRawLineIntact) {
+        const std::string line = "@display-name=Some\\sUser;color=#FF0000;mod=1 :tmi.twitch.tv USERSTATE #channel";
+        const std::string raw_bytes = line + "\r\n";
+
+        MessageProcessor processor;
+        size_t consumed = 0;
+        std::vector<irc::domain::Message> messages = processor.GetMessagesFromRawBytes(raw_bytes, consumed);
+        ASSERT_EQ(messages.size(), 1u);
+        const auto& message = messages.front();
+
+        EXPECT_EQ(message.GetTag("display-name"), "Some User"sv);
+        EXPECT_EQ(message.GetTag("color"), "#FF0000"sv);
+        EXPECT_EQ(message.GetContent(), line);
+    }
+
+} // namespace
@@ -0,0 +1,53 @@
+#include "read_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+
+namespace {
+
+    using connection::ReadBuffer;
+    using namespace std::literals;
+
+    // Copies bytes the way socket reads would: into the prepared space, as much as fits each time
+    void Feed(ReadBuffer& buffer, std::string_view bytes) {
+        while (!bytes.empty()) {
+            auto free = buffer.Prepare();
+            const size_t size = std::min(free.size(), bytes.size());
+            std::memcpy(free.data(), bytes.data(), size);
+            buffer.Commit(size);
+            bytes.remove_prefix(size);
+        }
+    }
+
+    TEST(ReadBufferTest, KeepsIncompleteTailUntilNextRead) {
+        ReadBuffer buffer(16, 64);
+        Feed(buffer, "PING :a\r\nPI"sv);
+        buffer.Consume("PING :a\r\n"sv.size());
+        Feed(buffer, "NG :b\r\n"sv);
+        EXPECT_EQ(buffer.Data(), "PING :b\r\n"sv);
+    }
+
+    TEST(ReadBufferTest, UnterminatedStreamStaysWithinMaxSize) {
+        ReadBuffer buffer(16, 64);
+        const std::string garbage(1024, 'x');
+        for (size_t i = 0; i < 100; ++i) {
+            Feed(buffer, garbage);
+        }
+        EXPECT_LE(buffer.Capacity(), 64u);
+        EXPECT_LE(buffer.Data().size(), 64u);
+        EXPECT_GT(buffer.GetDroppedLinesCount(), 0u);
+    }
+
+    TEST(ReadBufferTest, ResumesAfterDroppedLine) {
+        ReadBuffer buffer(16, 32);
+        Feed(buffer, "@long=xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx PRIVMSG #c :hi\r\nPING :ok\r\n"sv);
+        EXPECT_EQ(buffer.GetDroppedLinesCount(), 1u);
+        EXPECT_EQ(buffer.Data(), "PING :ok\r\n"sv);
+    }
+
+} // namespace
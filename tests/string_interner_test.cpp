@@ -0,0 +1,35 @@
+#include "string_interner.h"
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    using irc::domain::NameId;
+    using irc::domain::StringInterner;
+
+    TEST(StringInterner, RenamedAccountGetsNewId) {
+        StringInterner interner;
+        const NameId first = interner.Intern("User", 1);
+        EXPECT_EQ(interner.Intern("user", 1), first);
+
+        const NameId second = interner.Intern("user", 2);
+        EXPECT_NE(second, first);
+        EXPECT_EQ(interner.Find("user"), second);
+        EXPECT_FALSE(interner.GetName(first));
+    }
+
+    // Joins and user lists hold names by pin: account change must not move them to another id
+    TEST(StringInterner, PinnedNameKeepsIdOnAccountChange) {
+        StringInterner interner;
+        const NameId pinned = interner.Pin("channel");
+        EXPECT_EQ(interner.Intern("channel", 1), pinned);
+        EXPECT_EQ(interner.Intern("channel", 2), pinned);
+        EXPECT_EQ(interner.Find("channel"), pinned);
+
+        // Pin is still counted on the same id: after Unpin the name retires on the next account
+        interner.Unpin(pinned);
+        EXPECT_NE(interner.Intern("channel", 3), pinned);
+    }
+
+} // namespace
@@ -0,0 +1,91 @@
+#include "connection.h"
+#include "mock_twitch_server.h"
+#include "tls_client_context.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+
+namespace {
+
+    namespace net = boost::asio;
+    using namespace std::literals;
+
+    // Connects over TLS, logs in and waits for the welcome. TLS 1.3 tickets come after the
+    // handshake, reading the welcome makes sure the client has processed them
+    bool ConnectAndGreet(uint16_t port) {
+        net::io_context ioc;
+        auto read_strand = net::make_strand(ioc);
+        auto write_strand = net::make_strand(ioc);
+        auto connection = std::make_shared<connection::Connection>(ioc
+            , *connection::TlsClientContext::Instance().GetContext(), read_strand, write_strand);
+
+        bool greeted = false;
+        std::function<void(connection::ReadBuffer&)> on_read = [&](connection::ReadBuffer& buffer) {
+            if (buffer.Data().find(" 001 "sv) != std::string_view::npos) {
+                greeted = true;
+                return;
+            }
+            if (!connection->IsReconnectRequired()) {
+                connection->AsyncRead(on_read);
+            }
+        };
+        connection->AsyncConnect("localhost"sv, std::to_string(port), [&](const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+            connection->AsyncWrite("PASS oauth:test\r\nNICK justinfan1\r\n"sv);
+            connection->AsyncRead(on_read);
+            });
+
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (!greeted && std::chrono::steady_clock::now() < deadline) {
+            ioc.run_one_for(50ms);
+        }
+        connection->Abort();
+        ioc.poll();
+        return greeted;
+    }
+
+    TEST(TlsResumptionTest, ReconnectResumesSession) {
+        net::io_context server_ioc;
+        mock_twitch::ServerConfig config;
+        config.tls = true;
+        config.messages_per_second = 0;
+        auto server = std::make_shared<mock_twitch::MockServer>(server_ioc, config);
+        server->Start();
+        std::thread server_thread([&server_ioc]() {
+            server_ioc.run();
+            });
+
+        auto& tls = connection::TlsClientContext::Instance();
+        tls.AddCertificateAuthority(server->GetCaCertificate());
+        tls.ClearSessions();
+        const auto before = tls.GetHandshakeStats();
+
+        ASSERT_TRUE(ConnectAndGreet(server->GetPort()));
+        const auto first = tls.GetHandshakeStats();
+        EXPECT_EQ(first.full, before.full + 1);
+        EXPECT_EQ(first.resumed, before.resumed);
+
+        ASSERT_TRUE(ConnectAndGreet(server->GetPort()));
+        const auto second = tls.GetHandshakeStats();
+        EXPECT_EQ(second.full, first.full);
+        EXPECT_EQ(second.resumed, first.resumed + 1);
+        EXPECT_EQ(second.failed, before.failed);
+
+        server->Stop();
+        server_ioc.stop();
+        server_thread.join();
+    }
+
+} // namespace